@@ -0,0 +1,67 @@
+// Serves a few routes from handlers registered with the interpreter.
+//
+// WebServer.route takes a handler's name and calls it through
+// Interpreter::callFunction, which only knows registered native functions:
+// the interpreter can't call script-defined `func` values yet, so a .d
+// script can't define its own handlers. This program does what such a
+// script will do, with the handlers registered from C++.
+//
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -Isrc examples/hello_web.cpp src/runtime/webserver.cpp \
+//       src/runtime/webserver_binding.cpp src/runtime/http_parser.cpp src/runtime/router.cpp \
+//       src/interpreter/interpreter.cpp -lpthread -o hello_web
+// then try
+//   curl http://127.0.0.1:8080/hello?name=Dex
+//   curl http://127.0.0.1:8080/users/42
+//   curl -X POST -d '{"msg": "hi"}' http://127.0.0.1:8080/echo
+// or load-test it, e.g. wrk -t4 -c256 -d10s http://127.0.0.1:8080/hello
+// (workers "0" runs one event loop per core).
+
+#include "../src/interpreter/interpreter.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dex {
+void registerWebServerBindings(Interpreter&);
+}
+
+using dex::Value;
+using Object = std::unordered_map<std::string, Value>;
+
+static const Value& field(const Value& obj, const std::string& key) {
+    static const Value null;
+    if (!obj.isObject()) return null;
+    auto it = obj.asObject().find(key);
+    return it == obj.asObject().end() ? null : it->second;
+}
+
+int main(int argc, char** argv) {
+    dex::Interpreter interp;
+    dex::registerWebServerBindings(interp);
+
+    interp.registerFunction("hello", [](dex::Interpreter&, const std::vector<Value>& args) -> Value {
+        const Value& name = field(field(args[0], "query"), "name");
+        if (name.isNull()) return Value("Hello from Dex!");
+        return Value("Hello, " + name.asString() + "!");
+    });
+    interp.registerFunction("user", [](dex::Interpreter&, const std::vector<Value>& args) -> Value {
+        const std::string& id = field(field(args[0], "params"), "id").asString();
+        return Value(Object{{"id", Value(id)}, {"name", Value("user " + id)}});
+    });
+    interp.registerFunction("echo", [](dex::Interpreter&, const std::vector<Value>& args) -> Value {
+        return Value(Object{{"status", Value("201")},
+                            {"headers", Value(Object{{"Content-Type", Value("application/json")}})},
+                            {"body", field(args[0], "body")}});
+    });
+
+    std::string port = argc > 1 ? argv[1] : "8080";
+    Value server = interp.callFunction(
+        Value("WebServer.create"),
+        {Value(port), Value(Object{{"host", Value("127.0.0.1")}, {"workers", Value("0")}})});
+    interp.callFunction(Value("WebServer.route"), {server, Value("/hello"), Value("GET"), Value("hello")});
+    interp.callFunction(Value("WebServer.route"), {server, Value("/users/:id"), Value("GET"), Value("user")});
+    interp.callFunction(Value("WebServer.route"), {server, Value("/echo"), Value("POST"), Value("echo")});
+    interp.callFunction(Value("WebServer.start"), {server});
+    return 0;
+}
@@ -1,13 +1,21 @@
-#include "json_utils.h"
-
-namespace dex {
-
-json parseJSON(const std::string& jsonStr) {
-    return json::parse(jsonStr);
-}
-
-std::string toJSON(const json& j) {
-    return j.dump(4); // pretty print with 4 spaces indent
-}
-
-}
+#include "json_utils.h"
+
+namespace dex {
+
+json parseJSON(const std::string& jsonStr) {
+    return json::parse(jsonStr);
+}
+
+json parseJSON(const char* data, size_t size) {
+    return json::parse(data, data + size);
+}
+
+json parseJSON(std::istream& in) {
+    return json::parse(in);
+}
+
+std::string toJSON(const json& j) {
+    return j.dump(4); // pretty print with 4 spaces indent
+}
+
+}
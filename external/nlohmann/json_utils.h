@@ -1,15 +1,22 @@
-#pragma once
-#include <string>
-#include "json.hpp"  // nlohmann json header
-
-namespace dex {
-
-using json = nlohmann::json;
-
-// Convert JSON string to nlohmann::json object
-json parseJSON(const std::string& jsonStr);
-
-// Convert JSON object to string
-std::string toJSON(const json& j);
-
-}
+#pragma once
+#include <string>
+#include <istream>
+#include "json.hpp"  // nlohmann json header
+
+namespace dex {
+
+using json = nlohmann::json;
+
+// Convert JSON string to nlohmann::json object
+json parseJSON(const std::string& jsonStr);
+
+// Parse JSON from a byte range (e.g. a mapped file) without copying it
+json parseJSON(const char* data, size_t size);
+
+// Parse JSON incrementally from a stream (e.g. a decompressing reader)
+json parseJSON(std::istream& in);
+
+// Convert JSON object to string
+std::string toJSON(const json& j);
+
+}
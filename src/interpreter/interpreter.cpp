@@ -3,6 +3,8 @@
 
 namespace dex {
 
+thread_local int Interpreter::executingLine = 0;
+
 void Interpreter::interpret(const std::vector<StmtPtr>& statements) {
     for (auto& stmt : statements) {
         execute(stmt);
@@ -10,6 +12,16 @@ void Interpreter::interpret(const std::vector<StmtPtr>& statements) {
 }
 
 void Interpreter::execute(StmtPtr stmt) {
+    // Restored on the way out so a nested statement (a block, a function
+    // body) doesn't leave its line behind for the rest of the outer one.
+    struct LineScope {
+        int saved;
+        explicit LineScope(int line) : saved(executingLine) {
+            if (line) executingLine = line;
+        }
+        ~LineScope() { executingLine = saved; }
+    } scope(stmt->line);
+
     if (auto assign = std::dynamic_pointer_cast<AssignStmt>(stmt)) {
         executeAssign(assign);
     } else if (auto exprStmt = std::dynamic_pointer_cast<ExprStmt>(stmt)) {
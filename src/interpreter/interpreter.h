@@ -7,7 +7,10 @@
 #include <vector>
 #include <functional> // For std::function
 #include <variant>    // For a more robust Value type
+#include <memory>     // For std::shared_ptr (native objects)
+#include <type_traits>
 #include <iostream>   // For basic output in Value for debugging/demonstration
+#include <stdexcept>
 
 // Include nlohmann/json for JSON-related types used in Interpreter methods
 #include "../../external/nlohmann/json.hpp"
@@ -16,6 +19,28 @@ namespace dex {
 
 // Forward declaration of Interpreter to be used in Value and function types
 class Interpreter;
+class Value;
+
+// Base class for runtime objects that have no Dex representation of their own
+// (open files, row cursors, ...). A Value holds them by shared_ptr, so copies
+// of the Value refer to the same native object.
+class NativeObject {
+public:
+    virtual ~NativeObject() = default;
+    virtual std::string typeName() const = 0;
+    // True while the object must stay on the thread using it (e.g. a
+    // transaction pinning one connection); Interpreter::isolate() refuses
+    // to share such an object with another interpreter.
+    virtual bool threadConfined() const { return false; }
+};
+
+// Native objects that produce a sequence of values one at a time.
+// This is the protocol `for x in ...` loops consume.
+class NativeIterator : public NativeObject {
+public:
+    // Stores the next element in `out`; returns false once exhausted.
+    virtual bool next(Value& out) = 0;
+};
 
 // A simple Value class to represent values in the Dex language.
 // This is now extended to support strings, null, arrays, and objects.
@@ -23,7 +48,9 @@ class Value {
 public:
     // Using std::variant for a more robust type system.
     // Added std::vector<Value> for arrays and std::unordered_map<std::string, Value> for objects.
-    using ValueType = std::variant<std::string, std::nullptr_t, std::vector<Value>, std::unordered_map<std::string, Value>>;
+    // std::shared_ptr<NativeObject> carries runtime resources (see NativeObject).
+    using ValueType = std::variant<std::string, std::nullptr_t, std::vector<Value>, std::unordered_map<std::string, Value>,
+                                   std::shared_ptr<NativeObject>>;
 
     Value() : data(nullptr) {} // Default constructor for null value
     Value(const std::string& s) : data(s) {}
@@ -31,6 +58,10 @@ public:
     Value(std::nullptr_t) : data(nullptr) {}
     Value(const std::vector<Value>& arr) : data(arr) {}
     Value(const std::unordered_map<std::string, Value>& obj) : data(obj) {}
+    Value(std::vector<Value>&& arr) : data(std::move(arr)) {}
+    Value(std::unordered_map<std::string, Value>&& obj) : data(std::move(obj)) {}
+    template <typename T, typename = std::enable_if_t<std::is_base_of<NativeObject, T>::value>>
+    Value(std::shared_ptr<T> obj) : data(std::shared_ptr<NativeObject>(std::move(obj))) {}
 
     // Static method to create a null Value
     static Value nil() {
@@ -50,6 +81,9 @@ public:
     bool isObject() const {
         return std::holds_alternative<std::unordered_map<std::string, Value>>(data);
     }
+    bool isNative() const {
+        return std::holds_alternative<std::shared_ptr<NativeObject>>(data);
+    }
 
     // Get value methods. Throws if not the correct type.
     const std::string& asString() const {
@@ -61,6 +95,16 @@ public:
     const std::unordered_map<std::string, Value>& asObject() const {
         return std::get<std::unordered_map<std::string, Value>>(data);
     }
+    const std::shared_ptr<NativeObject>& asNative() const {
+        return std::get<std::shared_ptr<NativeObject>>(data);
+    }
+
+    // Returns the native object as T, or nullptr if this Value holds something else.
+    template <typename T>
+    std::shared_ptr<T> asNative() const {
+        if (!isNative()) return nullptr;
+        return std::dynamic_pointer_cast<T>(asNative());
+    }
 
     // For debugging/printing (simple version)
     std::string toString() const {
@@ -88,6 +132,9 @@ public:
             }
             s += "}";
             return s;
+        } else if (isNative()) {
+            const auto& obj = asNative();
+            return "<" + (obj ? obj->typeName() : std::string("native")) + ">";
         }
         return "[Unknown Value Type]";
     }
@@ -107,11 +154,45 @@ public:
 
     void interpret(const std::vector<StmtPtr>& statements);
 
+    // Source line of the statement executing on the calling thread, or 0
+    // outside a script statement. Lets runtime code that has no Interpreter
+    // at hand (e.g. the database layer's slow-query log) point at the script.
+    static int currentLine() { return executingLine; }
+
     // Method to register native C++ functions
     void registerFunction(const std::string& name, NativeFunction func) {
         nativeFunctions[name] = func;
     }
 
+    // A new interpreter with this one's native functions and a snapshot of
+    // its globals that shares no mutable state with it, so another thread
+    // can run the same program's functions on it (the parsed program is
+    // immutable and shared as is). Don't call while this one is running.
+    // Throws std::runtime_error if module state holds a thread-confined
+    // native object.
+    std::unique_ptr<Interpreter> isolate() const {
+        for (const auto& [key, state] : moduleStates) {
+            if (state.isNative() && state.asNative() && state.asNative()->threadConfined()) {
+                throw std::runtime_error("Can't share " + key + " with another thread while it is an open " +
+                                         state.asNative()->typeName() + "; finish it first");
+            }
+        }
+        auto copy = std::make_unique<Interpreter>();
+        copy->variables = variables;
+        copy->nativeFunctions = nativeFunctions;
+        copy->moduleStates = moduleStates;
+        return copy;
+    }
+
+    // State a native module keeps per interpreter rather than per process
+    // (e.g. the database bindings' current connection), by key; null until
+    // set. isolate() copies it, so an isolate starts from the same values
+    // (native objects are shared, not cloned) but later assignments on one
+    // interpreter are not seen by the other.
+    Value& moduleState(const std::string& key) {
+        return moduleStates[key];
+    }
+
     // Method to call a registered native function (used internally by interpreter)
     // Returns dex::Value
     Value callNativeFunction(const std::string& name, const std::vector<Value>& args) {
@@ -122,6 +203,21 @@ public:
         return Value::nil(); // Return a null value or throw an exception
     }
 
+    // Calls a Dex callable. Scripts can only refer to registered native
+    // functions for now, so a callable is the function's name as a string.
+    // Runtime code that invokes callbacks goes through here so that
+    // user-defined functions can be added without touching the bindings.
+    Value callFunction(const Value& fn, const std::vector<Value>& args) {
+        if (!fn.isString()) {
+            throw std::runtime_error("Value " + fn.toString() + " is not callable");
+        }
+        auto it = nativeFunctions.find(fn.asString());
+        if (it == nativeFunctions.end()) {
+            throw std::runtime_error("Function '" + fn.asString() + "' not found");
+        }
+        return it->second(*this, args);
+    }
+
     // Placeholder conversion methods for JSON/CSV (to be implemented fully)
     // These methods convert between nlohmann::json/std::vector<std::vector<std::string>>
     // and the Dex Value type. Their full implementation depends on how you map
@@ -177,17 +273,33 @@ public:
     }
 
     Value csvToDexValue(const std::vector<std::vector<std::string>>& rows) {
-        // Placeholder: Implement conversion from CSV rows to dex::Value (e.g., an array of arrays of strings)
-        std::cerr << "Warning: csvToDexValue is a placeholder. Implement full conversion." << std::endl;
+        // CSV rows become an array of arrays of strings.
         std::vector<Value> dex_rows;
+        dex_rows.reserve(rows.size());
         for (const auto& row : rows) {
-            std::vector<Value> dex_cells;
-            for (const auto& cell : row) {
-                dex_cells.push_back(Value(cell));
-            }
-            dex_rows.push_back(Value(dex_cells));
+            dex_rows.push_back(csvRowToDexValue(row));
+        }
+        return Value(std::move(dex_rows));
+    }
+
+    static Value csvRowToDexValue(const std::vector<std::string>& row) {
+        std::vector<Value> dex_cells;
+        dex_cells.reserve(row.size());
+        for (const auto& cell : row) {
+            dex_cells.push_back(Value(cell));
+        }
+        return Value(std::move(dex_cells));
+    }
+
+    // Maps a CSV row onto the header names, producing an object per row.
+    // Missing trailing cells become null; extra cells are dropped.
+    static Value csvRowToDexObject(const std::vector<std::string>& header, const std::vector<std::string>& row) {
+        std::unordered_map<std::string, Value> obj;
+        obj.reserve(header.size());
+        for (size_t i = 0; i < header.size(); ++i) {
+            obj.emplace(header[i], i < row.size() ? Value(row[i]) : Value::nil());
         }
-        return Value(dex_rows);
+        return Value(std::move(obj));
     }
 
     std::vector<std::vector<std::string>> dexValueToCSV(const Value& val) {
@@ -216,6 +328,8 @@ public:
 private:
     std::unordered_map<std::string, std::string> variables; // Simple string vars for now
     std::unordered_map<std::string, NativeFunction> nativeFunctions; // Registered native functions
+    std::unordered_map<std::string, Value> moduleStates; // see moduleState()
+    static thread_local int executingLine;
 
     void execute(StmtPtr stmt);
     void executeBlock(const std::vector<StmtPtr>& statements);
@@ -19,6 +19,7 @@ struct Expr {
 
 // Base statement
 struct Stmt {
+    int line = 0; // source line the statement starts on
     virtual ~Stmt() = default;
 };
 
@@ -0,0 +1,519 @@
+// src/runtime/async_io.cpp
+#include "async_io.h"
+#include "file_cache.h"
+#include "fileio.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define DEX_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace dex {
+
+namespace {
+
+FileReadResult readOne(const std::string& path) {
+    FileReadResult r;
+    r.path = path;
+    try {
+        r.data = readFile(path);
+    } catch (const std::exception& e) {
+        r.error = e.what();
+    }
+    return r;
+}
+
+FileWriteResult writeOne(const FileWriteRequest& req) {
+    FileWriteResult r;
+    r.path = req.path;
+    int fd = ::open(req.path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (req.append ? O_APPEND : O_TRUNC), 0644);
+    if (fd < 0) {
+        r.error = "Cannot open file for writing: " + req.path + " (" + std::strerror(errno) + ")";
+        return r;
+    }
+    const char* p = req.data.data();
+    size_t left = req.data.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            r.error = "Error writing file: " + req.path + " (" + std::strerror(errno) + ")";
+            break;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+        r.written += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    FileCache::instance().invalidate(req.path);
+    return r;
+}
+
+std::string errnoMessage(const char* what, const std::string& path, int err) {
+    return std::string(what) + ": " + path + " (" + std::strerror(err) + ")";
+}
+
+} // namespace
+
+#ifdef DEX_HAVE_IO_URING
+
+// Minimal io_uring wrapper over the raw syscalls (no liburing dependency).
+// Single-threaded: AsyncFileIO serializes access with ringMutex.
+class IoUring {
+public:
+    static std::unique_ptr<IoUring> create(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd < 0) return nullptr; // ENOSYS, EPERM (seccomp/sysctl), ...
+
+        std::unique_ptr<IoUring> r(new IoUring());
+        r->fd = fd;
+        r->entries = p.sq_entries;
+        r->sqLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        r->cqLen = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) r->sqLen = r->cqLen = std::max(r->sqLen, r->cqLen);
+
+        r->sqPtr = ::mmap(nullptr, r->sqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (r->sqPtr == MAP_FAILED) { r->sqPtr = nullptr; return nullptr; }
+        if (single) {
+            r->cqPtr = r->sqPtr;
+        } else {
+            r->cqPtr = ::mmap(nullptr, r->cqLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (r->cqPtr == MAP_FAILED) { r->cqPtr = nullptr; return nullptr; }
+        }
+        r->sqesLen = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, r->sqesLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return nullptr;
+        r->sqes = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(r->sqPtr);
+        char* cq = static_cast<char*>(r->cqPtr);
+        r->sqTail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        r->sqMask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        r->sqArray = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        r->cqHead = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        r->cqTail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        r->cqMask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        r->cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return r;
+    }
+
+    ~IoUring() {
+        if (sqes) ::munmap(sqes, sqesLen);
+        if (cqPtr && cqPtr != sqPtr) ::munmap(cqPtr, cqLen);
+        if (sqPtr) ::munmap(sqPtr, sqLen);
+        if (fd >= 0) ::close(fd);
+    }
+
+    unsigned capacity() const { return entries; }
+
+    void prep(uint8_t opcode, int file, const iovec* iov, uint64_t offset, uint64_t userData) {
+        unsigned tail = *sqTail;
+        unsigned idx = tail & sqMask;
+        io_uring_sqe* sqe = &sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = file;
+        sqe->addr = reinterpret_cast<uint64_t>(iov);
+        sqe->len = 1;
+        sqe->off = offset;
+        sqe->user_data = userData;
+        sqArray[idx] = idx;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted;
+    }
+
+    // Submits queued SQEs and blocks until at least `waitFor` completions are available.
+    void submitAndWait(unsigned waitFor) {
+        if (!enter(waitFor)) throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+    }
+
+    // submitAndWait without the exception: false, with errno set, if the
+    // kernel refuses.
+    bool enter(unsigned waitFor) noexcept {
+        for (;;) {
+            long rc = ::syscall(__NR_io_uring_enter, fd, unsubmitted, waitFor, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (rc >= 0) {
+                unsubmitted -= static_cast<unsigned>(rc) < unsubmitted ? static_cast<unsigned>(rc) : unsubmitted;
+                if (unsubmitted == 0) return true;
+                continue;
+            }
+            if (errno == EINTR) continue;
+            return false;
+        }
+    }
+
+    template <typename F>
+    void reap(F onCompletion) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe* cqe = &cqes[head & cqMask];
+            uint64_t user = cqe->user_data;
+            int res = cqe->res;
+            ++head;
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            onCompletion(user, res);
+            tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        }
+    }
+
+private:
+    IoUring() = default;
+
+    int fd = -1;
+    unsigned entries = 0;
+    unsigned unsubmitted = 0;
+    void* sqPtr = nullptr;
+    void* cqPtr = nullptr;
+    size_t sqLen = 0, cqLen = 0, sqesLen = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned sqMask = 0;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+};
+
+namespace {
+
+struct Transfer {
+    size_t index = 0;
+    int fd = -1;
+    char* buf = nullptr;
+    size_t size = 0;
+    size_t done = 0;
+    iovec iov{};
+};
+
+// Runs when driveTransfers returns or unwinds. If start, finish or the ring
+// threw, requests may still be in flight, and the kernel would write into
+// buffers that unwinding frees. So it waits for each of them (results are
+// dropped) before closing the files they left open.
+struct InFlightGuard {
+    IoUring& ring;
+    std::vector<Transfer>& slots;
+    size_t& inflight;
+
+    ~InFlightGuard() {
+        while (inflight > 0) {
+            if (!ring.enter(1)) {
+                // Returning would hand the buffers back while the kernel may still use them
+                std::cerr << "io_uring: can't wait for " << inflight << " in-flight transfers ("
+                          << std::strerror(errno) << "); aborting\n";
+                std::abort();
+            }
+            ring.reap([&](uint64_t, int) { --inflight; });
+        }
+        for (Transfer& t : slots) {
+            if (t.fd >= 0) ::close(t.fd);
+        }
+    }
+};
+
+// Keeps up to ring.capacity() transfers in flight. start(t) opens the file
+// and points t at its buffer; returning false means it completed without I/O
+// and left no file open. finish(t, err) runs once per started transfer (err
+// is 0 or an errno) and closes its file. Exceptions from either, or from the
+// ring, propagate once nothing is in flight (see InFlightGuard).
+template <typename Start, typename Finish>
+void driveTransfers(IoUring& ring, size_t count, uint8_t opcode, Start start, Finish finish) {
+    std::vector<Transfer> slots(ring.capacity());
+    std::vector<unsigned> freeSlots;
+    for (unsigned i = 0; i < ring.capacity(); ++i) freeSlots.push_back(ring.capacity() - 1 - i);
+    size_t inflight = 0;
+    InFlightGuard guard{ring, slots, inflight};
+
+    auto queue = [&](unsigned s) {
+        Transfer& t = slots[s];
+        t.iov.iov_base = t.buf + t.done;
+        t.iov.iov_len = t.size - t.done;
+        ring.prep(opcode, t.fd, &t.iov, t.done, s);
+    };
+    auto retire = [&](unsigned s, int err) {
+        finish(slots[s], err);
+        slots[s].fd = -1; // closed by finish
+        freeSlots.push_back(s);
+    };
+
+    size_t next = 0;
+    while (next < count || inflight > 0) {
+        while (next < count && !freeSlots.empty()) {
+            unsigned s = freeSlots.back();
+            slots[s] = Transfer();
+            slots[s].index = next++;
+            if (!start(slots[s])) {
+                slots[s].fd = -1;
+                continue;
+            }
+            freeSlots.pop_back();
+            queue(s);
+            ++inflight;
+        }
+        if (inflight == 0) continue;
+
+        ring.submitAndWait(1);
+        ring.reap([&](uint64_t user, int res) {
+            unsigned s = static_cast<unsigned>(user);
+            Transfer& t = slots[s];
+            if (res == -EINTR || res == -EAGAIN) {
+                queue(s);
+                return;
+            }
+            if (res > 0) {
+                t.done += static_cast<size_t>(res);
+                if (t.done < t.size) {
+                    queue(s); // short transfer: continue where it stopped
+                    return;
+                }
+            }
+            --inflight;
+            retire(s, res < 0 ? -res : 0);
+        });
+    }
+}
+
+} // namespace
+
+std::vector<FileReadResult> AsyncFileIO::readManyUring(const std::vector<std::string>& paths) {
+    std::vector<FileReadResult> results(paths.size());
+    driveTransfers(*ring, paths.size(), IORING_OP_READV,
+        [&](Transfer& t) {
+            FileReadResult& r = results[t.index];
+            r.path = paths[t.index];
+            t.fd = ::open(r.path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (t.fd < 0) {
+                r.error = errnoMessage("Cannot open file", r.path, errno);
+                return false;
+            }
+            struct stat st;
+            if (::fstat(t.fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+                // Pipes, procfs and empty files have no reliable size; read them directly.
+                ::close(t.fd);
+                t.fd = -1;
+                r = readOne(r.path);
+                return false;
+            }
+            r.data.resize(static_cast<size_t>(st.st_size));
+            t.buf = &r.data[0];
+            t.size = r.data.size();
+            return true;
+        },
+        [&](Transfer& t, int err) {
+            FileReadResult& r = results[t.index];
+            if (err) {
+                r.error = errnoMessage("Error reading file", r.path, err);
+                r.data.clear();
+            } else {
+                r.data.resize(t.done); // the file may have shrunk since fstat
+            }
+            ::close(t.fd);
+        });
+    return results;
+}
+
+std::vector<FileWriteResult> AsyncFileIO::writeManyUring(const std::vector<FileWriteRequest>& requests) {
+    std::vector<FileWriteResult> results(requests.size());
+    driveTransfers(*ring, requests.size(), IORING_OP_WRITEV,
+        [&](Transfer& t) {
+            const FileWriteRequest& req = requests[t.index];
+            FileWriteResult& r = results[t.index];
+            r.path = req.path;
+            int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (req.append ? O_APPEND : O_TRUNC);
+            t.fd = ::open(req.path.c_str(), flags, 0644);
+            if (t.fd < 0) {
+                r.error = errnoMessage("Cannot open file for writing", req.path, errno);
+                return false;
+            }
+            if (req.data.empty()) {
+                ::close(t.fd); // truncated or created, nothing to write
+                t.fd = -1;
+                FileCache::instance().invalidate(req.path);
+                return false;
+            }
+            t.buf = const_cast<char*>(req.data.data()); // WRITEV only reads from it
+            t.size = req.data.size();
+            return true;
+        },
+        [&](Transfer& t, int err) {
+            FileWriteResult& r = results[t.index];
+            r.written = t.done;
+            if (err) r.error = errnoMessage("Error writing file", r.path, err);
+            ::close(t.fd);
+            FileCache::instance().invalidate(r.path);
+        });
+    return results;
+}
+
+#else // !DEX_HAVE_IO_URING
+
+class IoUring {};
+
+std::vector<FileReadResult> AsyncFileIO::readManyUring(const std::vector<std::string>&) {
+    return {};
+}
+
+std::vector<FileWriteResult> AsyncFileIO::writeManyUring(const std::vector<FileWriteRequest>&) {
+    return {};
+}
+
+#endif // DEX_HAVE_IO_URING
+
+AsyncFileIO::AsyncFileIO() {
+#ifdef DEX_HAVE_IO_URING
+    ring = IoUring::create(256);
+#endif
+}
+
+AsyncFileIO::~AsyncFileIO() = default;
+
+AsyncFileIO& AsyncFileIO::instance() {
+    static AsyncFileIO io;
+    return io;
+}
+
+bool AsyncFileIO::usingIoUring() const {
+    std::lock_guard<std::mutex> lock(ringMutex);
+    return ring != nullptr;
+}
+
+const char* AsyncFileIO::backend() const {
+    return usingIoUring() ? "io_uring" : "thread-pool";
+}
+
+void AsyncFileIO::disableIoUring() {
+    flush();
+    std::lock_guard<std::mutex> lock(ringMutex);
+    ring.reset();
+}
+
+std::vector<FileReadResult> AsyncFileIO::readMany(const std::vector<std::string>& paths) {
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (ring) return readManyUring(paths);
+    }
+    std::vector<std::future<FileReadResult>> futures;
+    futures.reserve(paths.size());
+    for (const auto& path : paths) {
+        futures.push_back(ThreadPool::shared().submit([path]() { return readOne(path); }));
+    }
+    std::vector<FileReadResult> results;
+    results.reserve(paths.size());
+    for (auto& f : futures) results.push_back(f.get());
+    return results;
+}
+
+std::vector<FileWriteResult> AsyncFileIO::writeMany(const std::vector<FileWriteRequest>& requests) {
+    {
+        std::lock_guard<std::mutex> lock(ringMutex);
+        if (ring) return writeManyUring(requests);
+    }
+    std::vector<std::future<FileWriteResult>> futures;
+    futures.reserve(requests.size());
+    for (const auto& req : requests) {
+        futures.push_back(ThreadPool::shared().submit([&req]() { return writeOne(req); }));
+    }
+    std::vector<FileWriteResult> results;
+    results.reserve(requests.size());
+    for (auto& f : futures) results.push_back(f.get());
+    return results;
+}
+
+std::shared_future<FileReadResult> AsyncFileIO::readAsync(const std::string& path) {
+    // A request queued just before disableIoUring still completes: flush()
+    // goes through readMany, which falls back to the thread pool.
+    if (!usingIoUring()) {
+        return ThreadPool::shared().submit([path]() { return readOne(path); }).share();
+    }
+    std::shared_future<FileReadResult> result;
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingReads.emplace_back(path, std::promise<FileReadResult>());
+        result = pendingReads.back().second.get_future().share();
+        full = pendingReads.size() >= 256;
+    }
+    if (full) flush();
+    return result;
+}
+
+std::shared_future<FileWriteResult> AsyncFileIO::writeAsync(FileWriteRequest request) {
+    if (!usingIoUring()) {
+        return ThreadPool::shared().submit([req = std::move(request)]() { return writeOne(req); }).share();
+    }
+    std::shared_future<FileWriteResult> result;
+    bool full;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        pendingWrites.emplace_back(std::move(request), std::promise<FileWriteResult>());
+        result = pendingWrites.back().second.get_future().share();
+        full = pendingWrites.size() >= 256;
+    }
+    if (full) flush();
+    return result;
+}
+
+void AsyncFileIO::flush() {
+    std::vector<std::pair<std::string, std::promise<FileReadResult>>> reads;
+    std::vector<std::pair<FileWriteRequest, std::promise<FileWriteResult>>> writes;
+    {
+        std::lock_guard<std::mutex> lock(pendingMutex);
+        reads.swap(pendingReads);
+        writes.swap(pendingWrites);
+    }
+
+    // Writes first so a read queued after a write of the same path sees the new data.
+    if (!writes.empty()) {
+        std::vector<FileWriteRequest> requests;
+        requests.reserve(writes.size());
+        for (auto& w : writes) requests.push_back(std::move(w.first));
+        auto results = writeMany(requests);
+        for (size_t i = 0; i < writes.size(); ++i) writes[i].second.set_value(std::move(results[i]));
+    }
+    if (!reads.empty()) {
+        std::vector<std::string> paths;
+        paths.reserve(reads.size());
+        for (auto& r : reads) paths.push_back(r.first);
+        auto results = readMany(paths);
+        for (size_t i = 0; i < reads.size(); ++i) reads[i].second.set_value(std::move(results[i]));
+    }
+}
+
+bool FileFuture::ready() const {
+    auto isReady = [](const auto& f) { return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; };
+    return read.valid() ? isReady(read) : isReady(write);
+}
+
+Value FileFuture::get() {
+    if (!ready()) AsyncFileIO::instance().flush();
+    if (read.valid()) {
+        const FileReadResult& r = read.get();
+        if (!r.ok()) throw std::runtime_error(r.error);
+        return Value(r.data);
+    }
+    const FileWriteResult& w = write.get();
+    if (!w.ok()) throw std::runtime_error(w.error);
+    return Value(std::to_string(w.written));
+}
+
+} // namespace dex
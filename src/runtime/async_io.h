@@ -0,0 +1,98 @@
+// src/runtime/async_io.h
+#ifndef DEX_ASYNC_IO_H
+#define DEX_ASYNC_IO_H
+
+#include "../interpreter/interpreter.h"
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dex {
+
+struct FileReadResult {
+    std::string path;
+    std::string data;
+    std::string error; // empty on success
+    bool ok() const { return error.empty(); }
+};
+
+struct FileWriteRequest {
+    std::string path;
+    std::string data;
+    bool append = false;
+};
+
+struct FileWriteResult {
+    std::string path;
+    size_t written = 0;
+    std::string error; // empty on success
+    bool ok() const { return error.empty(); }
+};
+
+class IoUring;
+
+// Batched file I/O. On Linux with io_uring available, reads and writes of
+// many files are submitted to the kernel together and completed as they
+// finish; otherwise the same calls fan out over ThreadPool::shared().
+//
+// readAsync/writeAsync queue their request and return a future. With
+// io_uring, queued requests are submitted as one batch when any of their
+// futures is waited on (or when the queue reaches the ring size).
+class AsyncFileIO {
+public:
+    static AsyncFileIO& instance();
+
+    ~AsyncFileIO();
+
+    std::vector<FileReadResult> readMany(const std::vector<std::string>& paths);
+    std::vector<FileWriteResult> writeMany(const std::vector<FileWriteRequest>& requests);
+
+    std::shared_future<FileReadResult> readAsync(const std::string& path);
+    std::shared_future<FileWriteResult> writeAsync(FileWriteRequest request);
+
+    // Submits every queued readAsync/writeAsync request.
+    void flush();
+
+    const char* backend() const;
+
+    // Forces the thread-pool path (used by benchmarks and when io_uring misbehaves).
+    void disableIoUring();
+
+private:
+    AsyncFileIO();
+
+    std::unique_ptr<IoUring> ring; // guarded by ringMutex; reset by disableIoUring
+    mutable std::mutex ringMutex;
+
+    std::mutex pendingMutex;
+    std::vector<std::pair<std::string, std::promise<FileReadResult>>> pendingReads;
+    std::vector<std::pair<FileWriteRequest, std::promise<FileWriteResult>>> pendingWrites;
+
+    bool usingIoUring() const;
+    std::vector<FileReadResult> readManyUring(const std::vector<std::string>& paths);
+    std::vector<FileWriteResult> writeManyUring(const std::vector<FileWriteRequest>& requests);
+};
+
+// Future returned to Dex by FileIO.readFileAsync / FileIO.writeFileAsync.
+class FileFuture : public NativeObject {
+public:
+    explicit FileFuture(std::shared_future<FileReadResult> f) : read(std::move(f)) {}
+    explicit FileFuture(std::shared_future<FileWriteResult> f) : write(std::move(f)) {}
+
+    std::string typeName() const override { return "FileFuture"; }
+
+    bool ready() const;
+    // Waits for completion (flushing the batch if needed). Reads yield the
+    // file contents, writes the byte count. Throws std::runtime_error on failure.
+    Value get();
+
+private:
+    std::shared_future<FileReadResult> read;
+    std::shared_future<FileWriteResult> write;
+};
+
+} // namespace dex
+
+#endif // DEX_ASYNC_IO_H
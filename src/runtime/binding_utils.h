@@ -0,0 +1,55 @@
+// src/runtime/binding_utils.h
+#ifndef DEX_BINDING_UTILS_H
+#define DEX_BINDING_UTILS_H
+
+#include "../interpreter/interpreter.h"
+#include <charconv>
+#include <string>
+#include <cstdlib>
+
+namespace dex {
+
+// Helpers for reading the optional trailing `options` object that bindings
+// accept, e.g. `FileIO.openCSV("data.csv", {header: "true"})`.
+// Dex values are strings, so numbers and booleans arrive as text.
+
+inline const Value* findOption(const Value& options, const std::string& key) {
+    if (!options.isObject()) return nullptr;
+    const auto& obj = options.asObject();
+    auto it = obj.find(key);
+    if (it == obj.end() || it->second.isNull()) return nullptr;
+    return &it->second;
+}
+
+inline std::string optionString(const Value& options, const std::string& key, const std::string& fallback) {
+    const Value* v = findOption(options, key);
+    return v && v->isString() ? v->asString() : fallback;
+}
+
+inline bool optionBool(const Value& options, const std::string& key, bool fallback) {
+    const Value* v = findOption(options, key);
+    if (!v || !v->isString()) return fallback;
+    const std::string& s = v->asString();
+    return s == "true" || s == "1" || s == "yes";
+}
+
+// Parses all of `s` as a base-10 integer: no whitespace or '+', and for the
+// unsigned form no '-'. False for empty, partly numeric or out-of-range text.
+template <typename Int>
+inline bool parseInteger(const std::string& s, Int& out) {
+    const char* end = s.data() + s.size();
+    auto res = std::from_chars(s.data(), end, out);
+    return !s.empty() && res.ec == std::errc() && res.ptr == end;
+}
+
+inline long long optionInt(const Value& options, const std::string& key, long long fallback) {
+    const Value* v = findOption(options, key);
+    if (!v || !v->isString() || v->asString().empty()) return fallback;
+    char* end = nullptr;
+    long long n = std::strtoll(v->asString().c_str(), &end, 10);
+    return (end && *end == '\0') ? n : fallback;
+}
+
+} // namespace dex
+
+#endif // DEX_BINDING_UTILS_H
@@ -0,0 +1,69 @@
+// src/runtime/byte_buffer.cpp
+#include "byte_buffer.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dex {
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path + " (" + std::strerror(errno) + ")");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + path + " (" + std::strerror(err) + ")");
+    }
+    length = static_cast<size_t>(st.st_size);
+    if (length > 0) {
+        void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("Cannot map file: " + path + " (" + std::strerror(err) + ")");
+        }
+        ::madvise(p, length, MADV_SEQUENTIAL);
+        ::madvise(p, length, MADV_WILLNEED);
+        ptr = static_cast<const char*>(p);
+    }
+    ::close(fd); // the mapping keeps the file referenced
+}
+
+MappedFile::~MappedFile() {
+    if (ptr) ::munmap(const_cast<char*>(ptr), length);
+}
+
+std::shared_ptr<ByteBuffer> ByteBuffer::mapFile(const std::string& path) {
+    auto file = std::make_shared<MappedFile>(path);
+    const char* data = file->data();
+    size_t size = file->size();
+    return std::shared_ptr<ByteBuffer>(new ByteBuffer(std::move(file), data, size));
+}
+
+std::shared_ptr<ByteBuffer> ByteBuffer::fromString(std::string bytes) {
+    auto owned = std::make_shared<const std::string>(std::move(bytes));
+    const char* data = owned->data();
+    size_t size = owned->size();
+    return std::shared_ptr<ByteBuffer>(new ByteBuffer(std::move(owned), data, size));
+}
+
+std::shared_ptr<ByteBuffer> ByteBuffer::slice(size_t start, size_t count) const {
+    if (start > length) start = length;
+    if (count > length - start) count = length - start;
+    return std::shared_ptr<ByteBuffer>(new ByteBuffer(owner, ptr + start, count));
+}
+
+std::string_view bytesOf(const Value& v, const char* bindingName) {
+    if (v.isString()) return v.asString();
+    if (auto buf = v.asNative<ByteBuffer>()) return buf->view();
+    throw std::runtime_error(std::string(bindingName) + " expects a string or ByteBuffer argument");
+}
+
+} // namespace dex
@@ -0,0 +1,60 @@
+// src/runtime/byte_buffer.h
+#ifndef DEX_BYTE_BUFFER_H
+#define DEX_BYTE_BUFFER_H
+
+#include "../interpreter/interpreter.h"
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace dex {
+
+// Read-only bytes of a file mapped with mmap. The mapping is advised as
+// sequential and prefetched (MADV_SEQUENTIAL, MADV_WILLNEED).
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path); // throws std::runtime_error
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+
+private:
+    const char* ptr = nullptr;
+    size_t length = 0;
+};
+
+// Immutable byte buffer Value. Slices share the underlying storage
+// (a mapped file or an owned string), so slicing never copies.
+class ByteBuffer : public NativeObject {
+public:
+    static std::shared_ptr<ByteBuffer> mapFile(const std::string& path);
+    static std::shared_ptr<ByteBuffer> fromString(std::string bytes);
+
+    std::string typeName() const override { return "ByteBuffer"; }
+
+    std::string_view view() const { return std::string_view(ptr, length); }
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+
+    // Clamps start/count to the buffer, like std::string::substr.
+    std::shared_ptr<ByteBuffer> slice(size_t start, size_t count) const;
+
+private:
+    ByteBuffer(std::shared_ptr<const void> owner, const char* data, size_t size)
+        : owner(std::move(owner)), ptr(data), length(size) {}
+
+    std::shared_ptr<const void> owner;
+    const char* ptr;
+    size_t length;
+};
+
+// Bytes of a string or ByteBuffer Value without copying; throws otherwise.
+std::string_view bytesOf(const Value& v, const char* bindingName);
+
+} // namespace dex
+
+#endif // DEX_BYTE_BUFFER_H
@@ -0,0 +1,343 @@
+// src/runtime/compression.cpp
+#include "compression.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#ifdef DEX_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace dex {
+
+namespace {
+
+constexpr size_t kChunk = 256 * 1024;
+
+bool endsWith(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+class GzipSource : public ByteSource {
+public:
+    explicit GzipSource(std::unique_ptr<ByteSource> src) : inner(std::move(src)), in(kChunk) {
+        std::memset(&zs, 0, sizeof(zs));
+        // 15 + 32: maximum window, detect gzip or zlib header
+        if (inflateInit2(&zs, 15 + 32) != Z_OK) throw std::runtime_error("gzip: inflateInit failed");
+    }
+    ~GzipSource() override { inflateEnd(&zs); }
+
+    size_t read(char* buf, size_t n) override {
+        if (done || n == 0) return 0;
+        n = std::min(n, size_t(1) << 30); // avail_out is 32-bit
+        zs.next_out = reinterpret_cast<Bytef*>(buf);
+        zs.avail_out = static_cast<uInt>(n);
+        while (zs.avail_out == n) {
+            if (zs.avail_in == 0) {
+                size_t got = inner->read(in.data(), in.size());
+                if (got == 0) {
+                    if (!atBoundary) throw std::runtime_error("gzip: unexpected end of compressed data");
+                    done = true;
+                    break;
+                }
+                zs.next_in = reinterpret_cast<Bytef*>(in.data());
+                zs.avail_in = static_cast<uInt>(got);
+            }
+            if (atBoundary) {
+                inflateReset(&zs); // next concatenated member
+                atBoundary = false;
+            }
+            int rc = inflate(&zs, Z_NO_FLUSH);
+            if (rc == Z_STREAM_END) {
+                atBoundary = true;
+            } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                throw std::runtime_error(std::string("gzip: ") + (zs.msg ? zs.msg : "corrupt data"));
+            }
+        }
+        return n - zs.avail_out;
+    }
+
+private:
+    std::unique_ptr<ByteSource> inner;
+    std::vector<char> in;
+    z_stream zs;
+    bool atBoundary = true; // before the first member or after one ended (empty input is fine)
+    bool done = false;
+};
+
+class GzipSink : public ByteSink {
+public:
+    GzipSink(std::unique_ptr<ByteSink> dst, int level) : inner(std::move(dst)), out(kChunk) {
+        std::memset(&zs, 0, sizeof(zs));
+        // 15 + 16: maximum window, gzip wrapper
+        if (deflateInit2(&zs, level < 0 ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED, 15 + 16, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("gzip: deflateInit failed");
+        }
+    }
+    ~GzipSink() override { deflateEnd(&zs); }
+
+    void write(const char* data, size_t n) override {
+        // avail_in is 32-bit; feed very large writes in slices
+        while (n > 0) {
+            size_t take = n < (1u << 30) ? n : (1u << 30);
+            zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            zs.avail_in = static_cast<uInt>(take);
+            while (zs.avail_in > 0) pump(Z_NO_FLUSH);
+            data += take;
+            n -= take;
+        }
+    }
+
+    void finish() override {
+        if (finished) return;
+        while (pump(Z_FINISH) != Z_STREAM_END) {}
+        finished = true;
+        inner->finish();
+    }
+
+private:
+    std::unique_ptr<ByteSink> inner;
+    std::vector<char> out;
+    z_stream zs;
+    bool finished = false;
+
+    int pump(int flush) {
+        zs.next_out = reinterpret_cast<Bytef*>(out.data());
+        zs.avail_out = static_cast<uInt>(out.size());
+        int rc = deflate(&zs, flush);
+        if (rc == Z_STREAM_ERROR) throw std::runtime_error("gzip: deflate failed");
+        size_t produced = out.size() - zs.avail_out;
+        if (produced) inner->write(out.data(), produced);
+        return rc;
+    }
+};
+
+#ifdef DEX_HAVE_ZSTD
+class ZstdSource : public ByteSource {
+public:
+    explicit ZstdSource(std::unique_ptr<ByteSource> src)
+        : inner(std::move(src)), in(ZSTD_DStreamInSize()), ds(ZSTD_createDStream()) {
+        if (!ds) throw std::runtime_error("zstd: cannot create decoder");
+        ZSTD_initDStream(ds);
+    }
+    ~ZstdSource() override { ZSTD_freeDStream(ds); }
+
+    size_t read(char* buf, size_t n) override {
+        if (done || n == 0) return 0;
+        ZSTD_outBuffer out{buf, n, 0};
+        while (out.pos == 0) {
+            if (inBuf.pos == inBuf.size) {
+                size_t got = inner->read(in.data(), in.size());
+                if (got == 0) {
+                    if (!frameEnded) throw std::runtime_error("zstd: unexpected end of compressed data");
+                    done = true;
+                    break;
+                }
+                inBuf = ZSTD_inBuffer{in.data(), got, 0};
+            }
+            size_t rc = ZSTD_decompressStream(ds, &out, &inBuf);
+            if (ZSTD_isError(rc)) throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(rc));
+            frameEnded = rc == 0; // concatenated frames continue transparently
+        }
+        return out.pos;
+    }
+
+private:
+    std::unique_ptr<ByteSource> inner;
+    std::vector<char> in;
+    ZSTD_inBuffer inBuf{nullptr, 0, 0};
+    ZSTD_DStream* ds;
+    bool frameEnded = true;
+    bool done = false;
+};
+
+class ZstdSink : public ByteSink {
+public:
+    ZstdSink(std::unique_ptr<ByteSink> dst, int level)
+        : inner(std::move(dst)), out(ZSTD_CStreamOutSize()), cs(ZSTD_createCStream()) {
+        if (!cs) throw std::runtime_error("zstd: cannot create encoder");
+        ZSTD_initCStream(cs, level < 0 ? 3 : level);
+    }
+    ~ZstdSink() override { ZSTD_freeCStream(cs); }
+
+    void write(const char* data, size_t n) override {
+        ZSTD_inBuffer in{data, n, 0};
+        while (in.pos < in.size) {
+            ZSTD_outBuffer o{out.data(), out.size(), 0};
+            size_t rc = ZSTD_compressStream(cs, &o, &in);
+            if (ZSTD_isError(rc)) throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(rc));
+            if (o.pos) inner->write(out.data(), o.pos);
+        }
+    }
+
+    void finish() override {
+        if (finished) return;
+        size_t remaining;
+        do {
+            ZSTD_outBuffer o{out.data(), out.size(), 0};
+            remaining = ZSTD_endStream(cs, &o);
+            if (ZSTD_isError(remaining)) throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(remaining));
+            if (o.pos) inner->write(out.data(), o.pos);
+        } while (remaining > 0);
+        finished = true;
+        inner->finish();
+    }
+
+private:
+    std::unique_ptr<ByteSink> inner;
+    std::vector<char> out;
+    ZSTD_CStream* cs;
+    bool finished = false;
+};
+#endif // DEX_HAVE_ZSTD
+
+#ifndef DEX_HAVE_ZSTD
+[[noreturn]] void noZstd() {
+    throw std::runtime_error("zstd support is not compiled in (rebuild with libzstd available)");
+}
+#endif
+
+} // namespace
+
+Compression parseCompression(const std::string& name) {
+    if (name.empty() || name == "auto") return Compression::Auto;
+    if (name == "none") return Compression::None;
+    if (name == "gzip" || name == "gz") return Compression::Gzip;
+    if (name == "zstd" || name == "zst") return Compression::Zstd;
+    throw std::runtime_error("Unknown compression '" + name + "' (expected auto, none, gzip or zstd)");
+}
+
+Compression resolveCompression(Compression c, const std::string& path) {
+    if (c != Compression::Auto) return c;
+    if (endsWith(path, ".gz") || endsWith(path, ".gzip")) return Compression::Gzip;
+    if (endsWith(path, ".zst") || endsWith(path, ".zstd")) return Compression::Zstd;
+    return Compression::None;
+}
+
+FileSource::FileSource(const std::string& p) : path(p) {
+    fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path + " (" + std::strerror(errno) + ")");
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+FileSource::~FileSource() {
+    if (fd >= 0) ::close(fd);
+}
+
+size_t FileSource::read(char* buf, size_t n) {
+    for (;;) {
+        ssize_t got = ::read(fd, buf, n);
+        if (got >= 0) return static_cast<size_t>(got);
+        if (errno != EINTR) {
+            throw std::runtime_error("Error reading file: " + path + " (" + std::strerror(errno) + ")");
+        }
+    }
+}
+
+size_t MemorySource::read(char* buf, size_t n) {
+    size_t take = std::min(n, size - pos);
+    std::memcpy(buf, data + pos, take);
+    pos += take;
+    return take;
+}
+
+FileSink::FileSink(const std::string& p, bool append) : path(p) {
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (append ? O_APPEND : O_TRUNC), 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file for writing: " + path + " (" + std::strerror(errno) + ")");
+    }
+}
+
+FileSink::~FileSink() {
+    if (fd >= 0) ::close(fd);
+}
+
+void FileSink::write(const char* data, size_t n) {
+    while (n > 0) {
+        ssize_t w = ::write(fd, data, n);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Error writing file: " + path + " (" + std::strerror(errno) + ")");
+        }
+        data += w;
+        n -= static_cast<size_t>(w);
+    }
+}
+
+void FileSink::finish() {
+    if (fd < 0) return;
+    int rc = ::close(fd);
+    fd = -1;
+    if (rc != 0) throw std::runtime_error("Error closing file: " + path);
+}
+
+std::unique_ptr<ByteSource> decompress(std::unique_ptr<ByteSource> inner, Compression c) {
+    switch (c) {
+    case Compression::Gzip:
+        return std::make_unique<GzipSource>(std::move(inner));
+    case Compression::Zstd:
+#ifdef DEX_HAVE_ZSTD
+        return std::make_unique<ZstdSource>(std::move(inner));
+#else
+        noZstd();
+#endif
+    default:
+        return inner;
+    }
+}
+
+std::unique_ptr<ByteSink> compress(std::unique_ptr<ByteSink> inner, Compression c, int level) {
+    switch (c) {
+    case Compression::Gzip:
+        return std::make_unique<GzipSink>(std::move(inner), level);
+    case Compression::Zstd:
+#ifdef DEX_HAVE_ZSTD
+        return std::make_unique<ZstdSink>(std::move(inner), level);
+#else
+        noZstd();
+#endif
+    default:
+        return inner;
+    }
+}
+
+std::unique_ptr<ByteSource> openSource(const std::string& path, Compression c) {
+    return decompress(std::make_unique<FileSource>(path), resolveCompression(c, path));
+}
+
+std::unique_ptr<ByteSink> openSink(const std::string& path, Compression c, bool append, int level) {
+    return compress(std::make_unique<FileSink>(path, append), resolveCompression(c, path), level);
+}
+
+std::string readAll(ByteSource& source) {
+    std::string out;
+    size_t used = 0;
+    for (;;) {
+        if (used == out.size()) out.resize(out.empty() ? kChunk : out.size() * 2);
+        size_t n = source.read(&out[used], out.size() - used);
+        if (n == 0) break;
+        used += n;
+    }
+    out.resize(used);
+    return out;
+}
+
+SourceStreamBuf::int_type SourceStreamBuf::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    size_t n = source.read(buffer.data(), buffer.size());
+    if (n == 0) return traits_type::eof();
+    setg(buffer.data(), buffer.data(), buffer.data() + n);
+    return traits_type::to_int_type(*gptr());
+}
+
+} // namespace dex
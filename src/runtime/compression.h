@@ -0,0 +1,107 @@
+// src/runtime/compression.h
+#ifndef DEX_COMPRESSION_H
+#define DEX_COMPRESSION_H
+
+#include <cstddef>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace dex {
+
+// Auto picks by file extension: .gz/.gzip -> Gzip, .zst/.zstd -> Zstd, else None.
+// Zstd is only available when built with DEX_HAVE_ZSTD.
+enum class Compression { Auto, None, Gzip, Zstd };
+
+// "auto", "none", "gzip"/"gz", "zstd"/"zst". Throws std::runtime_error otherwise.
+Compression parseCompression(const std::string& name);
+// Resolves Auto against `path`; other values are returned unchanged.
+Compression resolveCompression(Compression c, const std::string& path);
+
+// Pull-based byte stream. read() fills up to n bytes and returns how many;
+// 0 means end of stream. Errors throw std::runtime_error.
+class ByteSource {
+public:
+    virtual ~ByteSource() = default;
+    virtual size_t read(char* buf, size_t n) = 0;
+};
+
+class FileSource : public ByteSource {
+public:
+    explicit FileSource(const std::string& path);
+    ~FileSource() override;
+    size_t read(char* buf, size_t n) override;
+
+private:
+    std::string path;
+    int fd = -1;
+};
+
+// Reads from memory the caller keeps alive.
+class MemorySource : public ByteSource {
+public:
+    MemorySource(const char* bytes, size_t length) : data(bytes), size(length) {}
+    size_t read(char* buf, size_t n) override;
+
+private:
+    const char* data;
+    size_t size;
+    size_t pos = 0;
+};
+
+// Push-based counterpart. finish() must be called once after the last
+// write (it emits compression trailers and closes files); a sink destroyed
+// without finish() discards its trailer, leaving a truncated stream.
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+    virtual void write(const char* data, size_t n) = 0;
+    virtual void finish() = 0;
+};
+
+class FileSink : public ByteSink {
+public:
+    FileSink(const std::string& path, bool append);
+    ~FileSink() override;
+    void write(const char* data, size_t n) override;
+    void finish() override;
+
+private:
+    std::string path;
+    int fd = -1;
+};
+
+// Wraps `inner` so reads return decompressed bytes. Gzip input may hold
+// several concatenated members (as produced by appending); zlib-wrapped
+// streams are accepted too. Compression must already be resolved.
+std::unique_ptr<ByteSource> decompress(std::unique_ptr<ByteSource> inner, Compression c);
+// Wraps `inner` so written bytes are compressed. level < 0 = codec default.
+std::unique_ptr<ByteSink> compress(std::unique_ptr<ByteSink> inner, Compression c, int level = -1);
+
+// File opened through the codec chosen by `c` (Auto = by extension).
+std::unique_ptr<ByteSource> openSource(const std::string& path, Compression c = Compression::Auto);
+// With append, compressed output is added as a new gzip member / zstd frame,
+// which readers decode as one continuous stream.
+std::unique_ptr<ByteSink> openSink(const std::string& path, Compression c = Compression::Auto,
+                                   bool append = false, int level = -1);
+
+std::string readAll(ByteSource& source);
+
+// std::streambuf over a ByteSource, for parsers that take a std::istream.
+class SourceStreamBuf : public std::streambuf {
+public:
+    explicit SourceStreamBuf(ByteSource& source, size_t bufferSize = 64 * 1024)
+        : source(source), buffer(bufferSize ? bufferSize : 1) {}
+
+protected:
+    int_type underflow() override;
+
+private:
+    ByteSource& source;
+    std::vector<char> buffer;
+};
+
+} // namespace dex
+
+#endif // DEX_COMPRESSION_H
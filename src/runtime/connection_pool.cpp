@@ -0,0 +1,234 @@
+// src/runtime/connection_pool.cpp
+#include "connection_pool.h"
+#include "instrumented_database.h"
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+namespace dex {
+
+using Clock = std::chrono::steady_clock;
+
+std::shared_ptr<ConnectionPool> ConnectionPool::forConnection(const std::string& connStr,
+                                                              const PoolOptions& options) {
+    static std::mutex registryMutex;
+    static std::unordered_map<std::string, std::shared_ptr<ConnectionPool>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = registry.find(connStr);
+    if (it != registry.end()) return it->second;
+
+    auto pool = std::make_shared<ConnectionPool>(connStr, options);
+    if (!pool->fill()) return nullptr;
+    registry.emplace(connStr, pool);
+    return pool;
+}
+
+ConnectionPool::ConnectionPool(std::string connectionString, const PoolOptions& options)
+    : connStr(std::move(connectionString)), opts(options) {
+    opts.maxSize = std::max<size_t>(opts.maxSize, 1);
+    // Every connection to an in-memory SQLite database sees its own empty
+    // database, so such pools must hand out the same connection every time.
+    if (connStr.rfind("sqlite://", 0) == 0 &&
+        (connStr.find(":memory:") != std::string::npos || connStr.find("mode=memory") != std::string::npos)) {
+        opts.maxSize = 1;
+        singleConnection = true;
+    }
+    opts.minSize = std::min(opts.minSize, opts.maxSize);
+    if (opts.resultCacheBytes > 0) {
+        queryCache = std::make_shared<QueryCache>(opts.resultCacheBytes, opts.resultCacheTtl);
+    }
+    maintainer = std::thread([this]() { maintain(); });
+}
+
+ConnectionPool::~ConnectionPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    maintainerWake.notify_all();
+    maintainer.join();
+}
+
+std::unique_ptr<Database> ConnectionPool::openConnection() {
+    std::unique_ptr<Database> db = createDatabase(connStr);
+    if (!db) {
+        std::cerr << "Connection pool: unsupported connection string\n";
+        return nullptr;
+    }
+    if (!db->connect(connStr)) return nullptr;
+    if (queryCache) db = std::make_unique<CachingDatabase>(std::move(db), queryCache);
+    // Outermost, so the stats time what scripts see, cache hits included
+    db = std::make_unique<InstrumentedDatabase>(std::move(db));
+    db->setStatementCacheSize(opts.statementCacheSize);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++counters.created;
+    return db;
+}
+
+std::shared_ptr<Database> ConnectionPool::lease(std::unique_ptr<Database> db) {
+    registerSharedTables(*db);
+    std::weak_ptr<ConnectionPool> owner = shared_from_this();
+    std::shared_ptr<Database> leased(db.release(), [owner](Database* raw) {
+        std::unique_ptr<Database> conn(raw);
+        if (auto pool = owner.lock()) pool->release(std::move(conn));
+    });
+    if (singleConnection) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = threadLeases.begin(); it != threadLeases.end();) {
+            it = it->second.expired() ? threadLeases.erase(it) : std::next(it);
+        }
+        threadLeases[std::this_thread::get_id()] = leased;
+    }
+    return leased;
+}
+
+void ConnectionPool::release(std::unique_ptr<Database> db) {
+    if (db->inTransaction()) {
+        // Never hand the next caller someone else's half-finished transaction
+        std::cerr << "Connection pool: rolling back a transaction left open\n";
+        db->rollback();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (stopping) {
+        --open;
+        lock.unlock();
+        return; // db closes on scope exit
+    }
+    idle.push_back(IdleConnection{std::move(db), Clock::now()});
+    lock.unlock();
+    available.notify_one();
+}
+
+std::shared_ptr<Database> ConnectionPool::acquire() {
+    const auto deadline = Clock::now() + opts.checkoutTimeout;
+    std::unique_lock<std::mutex> lock(mutex);
+    ++counters.checkouts;
+    bool waited = false;
+
+    if (singleConnection) {
+        // Waiting for our own lease would only time out
+        auto held = threadLeases.find(std::this_thread::get_id());
+        if (held != threadLeases.end()) {
+            if (auto db = held->second.lock()) return db;
+        }
+    }
+
+    for (;;) {
+        if (!idle.empty()) {
+            // Most recently returned first: it is the least likely to have
+            // been dropped by the server and has the warmest statement cache.
+            IdleConnection conn = std::move(idle.back());
+            idle.pop_back();
+            lock.unlock();
+            if (Clock::now() - conn.since < opts.healthCheckAfter) return lease(std::move(conn.db));
+
+            if (conn.db->ping()) return lease(std::move(conn.db));
+            conn.db.reset();
+            lock.lock();
+            --open;
+            ++counters.evicted;
+            continue;
+        }
+
+        if (open < opts.maxSize) {
+            ++open;
+            lock.unlock();
+            if (auto db = openConnection()) return lease(std::move(db));
+            lock.lock();
+            --open;
+            lock.unlock();
+            available.notify_one();
+            return nullptr;
+        }
+
+        if (!waited) {
+            waited = true;
+            ++counters.waits;
+        }
+        if (available.wait_until(lock, deadline) == std::cv_status::timeout && idle.empty() &&
+            open >= opts.maxSize) {
+            ++counters.timeouts;
+            std::cerr << "Connection pool: no connection available after "
+                      << opts.checkoutTimeout.count() << "ms (max " << opts.maxSize << ")\n";
+            return nullptr;
+        }
+    }
+}
+
+bool ConnectionPool::fill() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (open < opts.minSize && !stopping) {
+        ++open;
+        lock.unlock();
+        std::unique_ptr<Database> db = openConnection();
+        lock.lock();
+        if (!db) {
+            --open;
+            return false;
+        }
+        idle.push_back(IdleConnection{std::move(db), Clock::now()});
+        available.notify_one();
+    }
+    return true;
+}
+
+void ConnectionPool::shareTable(const std::string& name, std::shared_ptr<const Table> table) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sharedTables[name] = std::move(table);
+    }
+    if (queryCache) queryCache->invalidateTables({name});
+}
+
+// Called on every checkout, outside the lock. Tables the connection already
+// has are skipped by the backend, so this is cheap once it is up to date.
+void ConnectionPool::registerSharedTables(Database& db) {
+    std::vector<std::pair<std::string, std::shared_ptr<const Table>>> tables;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (sharedTables.empty()) return;
+        tables.assign(sharedTables.begin(), sharedTables.end());
+    }
+    for (const auto& [name, table] : tables) db.registerTable(name, table);
+}
+
+PoolStats ConnectionPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    PoolStats s = counters;
+    s.open = open;
+    s.idle = idle.size();
+    s.inUse = open - idle.size();
+    return s;
+}
+
+// Background upkeep: closes connections that idled past idleTimeout (oldest
+// first, never below minSize) and reopens up to minSize after evictions.
+void ConnectionPool::maintain() {
+    const auto interval = std::max(std::chrono::milliseconds(100), opts.idleTimeout / 2);
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        maintainerWake.wait_for(lock, interval);
+        if (stopping) break;
+
+        std::vector<std::unique_ptr<Database>> expired;
+        const auto now = Clock::now();
+        auto it = idle.begin();
+        while (it != idle.end() && open > opts.minSize && now - it->since >= opts.idleTimeout) {
+            expired.push_back(std::move(it->db));
+            ++it;
+            --open;
+            ++counters.evicted;
+        }
+        idle.erase(idle.begin(), it);
+
+        lock.unlock();
+        expired.clear(); // close outside the lock; it may block on the network
+        fill();
+        lock.lock();
+    }
+}
+
+} // namespace dex
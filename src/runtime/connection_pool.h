@@ -0,0 +1,119 @@
+// src/runtime/connection_pool.h
+#ifndef DEX_CONNECTION_POOL_H
+#define DEX_CONNECTION_POOL_H
+
+#include "database.h"
+#include "query_cache.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dex {
+
+struct PoolOptions {
+    size_t minSize = 1;                             // connections kept open even when idle
+    size_t maxSize = 8;                             // hard cap on open connections
+    std::chrono::milliseconds idleTimeout{60000};   // idle connections above minSize close after this
+    std::chrono::milliseconds checkoutTimeout{5000};
+    std::chrono::milliseconds healthCheckAfter{30000}; // ping connections idle longer than this before reuse
+    size_t statementCacheSize = Database::defaultStatementCacheSize;
+    size_t resultCacheBytes = 0;                    // query result cache budget; 0 disables it
+    std::chrono::milliseconds resultCacheTtl{30000};
+};
+
+struct PoolStats {
+    size_t open = 0;
+    size_t idle = 0;
+    size_t inUse = 0;
+    uint64_t checkouts = 0;
+    uint64_t waits = 0;       // checkouts that had to block for a free connection
+    uint64_t timeouts = 0;
+    uint64_t created = 0;
+    uint64_t evicted = 0;     // closed for idling or failing a health check
+};
+
+// Thread-safe pool of connections to one connection string, built with
+// createDatabase. acquire() hands out a lease: a shared_ptr whose deleter
+// returns the connection to the pool, so connections (and their prepared
+// statement caches) are reused across calls and threads. A lease must only
+// be used by one thread at a time. With resultCacheBytes set, every
+// connection is wrapped in a CachingDatabase sharing one QueryCache.
+// An in-memory SQLite pool has exactly one connection, so a thread that
+// already holds its lease gets the same lease back from acquire() rather
+// than waiting on itself (a cursor left open while running a query, say);
+// the connection returns to the pool once the last copy is released.
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool> {
+public:
+    // Process-wide pool for `connStr`, created on first use. Options only
+    // apply when the pool is created; later callers share the existing pool.
+    // Returns nullptr if the connection string is unsupported or the initial
+    // connections can't be opened.
+    static std::shared_ptr<ConnectionPool> forConnection(const std::string& connStr,
+                                                         const PoolOptions& options = PoolOptions{});
+
+    ConnectionPool(std::string connStr, const PoolOptions& options);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // Checks out a connection, opening one if below maxSize, otherwise waiting
+    // up to checkoutTimeout. Returns nullptr on timeout or connect failure.
+    // On an in-memory pool, returns the calling thread's lease if it has one,
+    // including one pinned by an open transaction.
+    std::shared_ptr<Database> acquire();
+
+    // Opens connections until minSize are available. False if one fails.
+    bool fill();
+
+    // Registers `table` as `name` (see Database::registerTable) on every
+    // connection: new ones when they open, the others at their next checkout.
+    // Drops cached results that read an earlier table of that name.
+    void shareTable(const std::string& name, std::shared_ptr<const Table> table);
+
+    PoolStats stats() const;
+    // Shared result cache, or nullptr if the pool was created without one.
+    const std::shared_ptr<QueryCache>& resultCache() const { return queryCache; }
+    const std::string& connectionString() const { return connStr; }
+    const PoolOptions& options() const { return opts; }
+
+private:
+    struct IdleConnection {
+        std::unique_ptr<Database> db;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    std::string connStr;
+    PoolOptions opts;
+    std::shared_ptr<QueryCache> queryCache;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::vector<IdleConnection> idle; // back = most recently returned
+    size_t open = 0;                  // idle + leased + being opened
+    PoolStats counters;
+    std::map<std::string, std::shared_ptr<const Table>> sharedTables;
+    bool singleConnection = false; // in-memory SQLite: one connection shared by every caller
+    std::unordered_map<std::thread::id, std::weak_ptr<Database>> threadLeases; // singleConnection only
+
+    std::thread maintainer;
+    std::condition_variable maintainerWake;
+    bool stopping = false;
+
+    std::unique_ptr<Database> openConnection();
+    std::shared_ptr<Database> lease(std::unique_ptr<Database> db);
+    void registerSharedTables(Database& db);
+    void release(std::unique_ptr<Database> db);
+    void maintain();
+};
+
+} // namespace dex
+
+#endif // DEX_CONNECTION_POOL_H
@@ -0,0 +1,140 @@
+// src/runtime/csv_reader.cpp
+#include "csv_reader.h"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace dex {
+
+CSVReader::CSVReader(const std::string& path, const CSVOptions& opts)
+    : CSVReader(openSource(path, opts.compression), opts) {}
+
+CSVReader::CSVReader(std::unique_ptr<ByteSource> src, const CSVOptions& opts)
+    : options(opts), source(std::move(src)), buffer(opts.bufferSize ? opts.bufferSize : 1) {
+    data = buffer.data();
+    readHeader();
+}
+
+CSVReader::CSVReader(const char* bytes, size_t size, const CSVOptions& opts)
+    : options(opts), data(bytes), end(size), eof(true) {
+    readHeader();
+}
+
+CSVReader::~CSVReader() {
+    close();
+}
+
+void CSVReader::close() {
+    source.reset();
+    eof = true;
+    pos = end = 0;
+}
+
+bool CSVReader::fill() {
+    if (!source || eof) return false;
+    size_t n = source->read(buffer.data(), buffer.size());
+    if (n == 0) {
+        eof = true;
+        return false;
+    }
+    pos = 0;
+    end = n;
+    return true;
+}
+
+void CSVReader::readHeader() {
+    // Skip a UTF-8 byte order mark so it doesn't end up in the first column name.
+    if ((pos < end || fill()) && end - pos >= 3 && std::memcmp(data + pos, "\xEF\xBB\xBF", 3) == 0) {
+        pos += 3;
+    }
+    if (options.header && readRow(headerNames)) {
+        rowCount = 0;
+    }
+}
+
+bool CSVReader::readRow(std::vector<std::string>& row) {
+    const char delim = options.delimiter;
+    const char quote = options.quote;
+
+    // Skip blank lines between records, unless rows have one column: then a
+    // blank line is a row holding one empty field.
+    for (;;) {
+        if (pos == end && !fill()) return false;
+        if (width == 1 || (data[pos] != '\n' && data[pos] != '\r')) break;
+        ++pos;
+    }
+
+    size_t col = 0;
+    auto field = [&row](size_t i) -> std::string& {
+        if (i == row.size()) row.emplace_back();
+        std::string& f = row[i];
+        f.clear();
+        return f;
+    };
+    std::string* cur = &field(0);
+    bool quoted = false;
+
+    for (;;) {
+        if (pos == end && !fill()) break; // EOF terminates the last record
+
+        if (quoted) {
+            const char* start = data + pos;
+            const char* q = static_cast<const char*>(std::memchr(start, quote, end - pos));
+            if (!q) {
+                cur->append(start, end - pos);
+                pos = end;
+                continue;
+            }
+            cur->append(start, q - start);
+            pos = static_cast<size_t>(q - data) + 1;
+            // A doubled quote is an escaped quote; anything else closes the field.
+            if (pos == end && !fill()) break;
+            if (data[pos] == quote) {
+                cur->push_back(quote);
+                ++pos;
+            } else {
+                quoted = false;
+            }
+            continue;
+        }
+
+        // Copy the unquoted run up to the next special character in one append.
+        size_t i = pos;
+        while (i < end) {
+            char ch = data[i];
+            if (ch == delim || ch == '\n' || ch == '\r' || ch == quote) break;
+            ++i;
+        }
+        cur->append(data + pos, i - pos);
+        pos = i;
+        if (pos == end) continue;
+
+        char ch = data[pos++];
+        if (ch == delim) {
+            cur = &field(++col);
+        } else if (ch == quote) {
+            if (cur->empty()) {
+                quoted = true;
+            } else {
+                cur->push_back(ch); // stray quote inside an unquoted field
+            }
+        } else {
+            if (ch == '\r' && (pos < end || fill()) && data[pos] == '\n') ++pos;
+            break;
+        }
+    }
+
+    row.resize(col + 1);
+    if (width == 0) width = row.size();
+    ++rowCount;
+    return true;
+}
+
+bool CSVReader::next(Value& out) {
+    if (!readRow(scratch)) return false;
+    out = options.header ? Interpreter::csvRowToDexObject(headerNames, scratch)
+                         : Interpreter::csvRowToDexValue(scratch);
+    return true;
+}
+
+} // namespace dex
@@ -0,0 +1,73 @@
+// src/runtime/csv_reader.h
+#ifndef DEX_CSV_READER_H
+#define DEX_CSV_READER_H
+
+#include "../interpreter/interpreter.h"
+#include "compression.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace dex {
+
+struct CSVOptions {
+    char delimiter = ',';
+    char quote = '"';
+    bool header = false;            // first row names the columns
+    size_t bufferSize = 1 << 20;    // read size for file-backed readers
+    Compression compression = Compression::Auto; // .gz/.zst paths decode on the fly
+};
+
+// Incremental RFC 4180 reader. Rows are parsed out of a fixed-size read
+// buffer, so memory stays constant no matter how large the file is.
+// Quoted fields may contain delimiters, doubled quotes and line breaks.
+class CSVReader : public NativeIterator {
+public:
+    // Streams rows from a file on disk, decompressing per options.compression.
+    // Throws std::runtime_error if it can't be opened.
+    CSVReader(const std::string& path, const CSVOptions& options);
+    // Streams rows from any byte source (e.g. a decompressor over memory).
+    CSVReader(std::unique_ptr<ByteSource> source, const CSVOptions& options);
+    // Parses rows out of memory the caller keeps alive for the reader's lifetime.
+    CSVReader(const char* bytes, size_t size, const CSVOptions& options);
+    ~CSVReader() override;
+
+    CSVReader(const CSVReader&) = delete;
+    CSVReader& operator=(const CSVReader&) = delete;
+
+    // Reads the next row into `row`, reusing its strings' capacity.
+    // Returns false at end of input. Blank lines are skipped, except once
+    // the header or first row has a single column: then each blank line is
+    // a row with one empty field.
+    bool readRow(std::vector<std::string>& row);
+
+    // NativeIterator: yields arrays of strings, or objects keyed by the
+    // header names when CSVOptions::header is set.
+    bool next(Value& out) override;
+    std::string typeName() const override { return "CSVReader"; }
+
+    const std::vector<std::string>& header() const { return headerNames; }
+    size_t rowsRead() const { return rowCount; }
+    void close();
+
+private:
+    CSVOptions options;
+    std::unique_ptr<ByteSource> source;
+    std::vector<char> buffer;
+    const char* data = nullptr;
+    size_t pos = 0;
+    size_t end = 0;
+    bool eof = false;
+    size_t rowCount = 0;
+    size_t width = 0; // fields in the header or first row
+    std::vector<std::string> headerNames;
+    std::vector<std::string> scratch;
+
+    bool fill();
+    void readHeader();
+};
+
+} // namespace dex
+
+#endif // DEX_CSV_READER_H
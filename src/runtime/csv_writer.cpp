@@ -0,0 +1,234 @@
+// src/runtime/csv_writer.cpp
+#include "csv_writer.h"
+#include "table.h"
+#include "compression.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace dex {
+
+CSVWriter::CSVWriter(std::string& out, char delim)
+    : buf(out), delimiter(delim) {}
+
+CSVWriter::CSVWriter(int fileDescriptor, size_t bufferSize, char delim)
+    : buf(ownBuffer), fd(fileDescriptor), threshold(bufferSize ? bufferSize : 1), delimiter(delim) {
+    ownBuffer.reserve(threshold + 4096);
+}
+
+CSVWriter::CSVWriter(ByteSink& out, size_t bufferSize, char delim)
+    : buf(ownBuffer), sink(&out), threshold(bufferSize ? bufferSize : 1), delimiter(delim) {
+    ownBuffer.reserve(threshold + 4096);
+}
+
+CSVWriter::~CSVWriter() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Destructors must not throw; callers that care call flush() themselves.
+    }
+}
+
+void CSVWriter::flush() {
+    if (buf.empty()) return;
+    if (sink) {
+        sink->write(buf.data(), buf.size());
+        buf.clear();
+        return;
+    }
+    if (fd < 0) return;
+    const char* p = buf.data();
+    size_t left = buf.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("CSV write failed: ") + std::strerror(errno));
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    buf.clear();
+}
+
+bool CSVWriter::needsQuotes(std::string_view field) const {
+    for (char c : field) {
+        if (c == delimiter || c == '"' || c == '\n' || c == '\r') return true;
+    }
+    return false;
+}
+
+std::string CSVWriter::escape(std::string_view field, char delim) {
+    bool quote = false;
+    for (char c : field) {
+        if (c == delim || c == '"' || c == '\n' || c == '\r') {
+            quote = true;
+            break;
+        }
+    }
+    if (!quote) return std::string(field);
+
+    std::string out;
+    out.reserve(field.size() + 2);
+    out.push_back('"');
+    for (char c : field) {
+        if (c == '"') out.push_back('"');
+        out.push_back(c);
+    }
+    out.push_back('"');
+    return out;
+}
+
+void CSVWriter::separator() {
+    if (rowStarted) {
+        buf.push_back(delimiter);
+        lineBlank = false;
+    }
+    rowStarted = true;
+}
+
+void CSVWriter::writeRawField(std::string_view field) {
+    separator();
+    if (!field.empty()) lineBlank = false;
+    buf.append(field.data(), field.size());
+}
+
+void CSVWriter::writeField(std::string_view field) {
+    separator();
+    if (field.empty()) {
+        emptyField = true;
+    } else {
+        lineBlank = false;
+    }
+    if (!needsQuotes(field)) {
+        buf.append(field.data(), field.size());
+        return;
+    }
+    buf.push_back('"');
+    size_t start = 0;
+    for (size_t i = 0; i < field.size(); ++i) {
+        if (field[i] == '"') {
+            buf.append(field.data() + start, i - start + 1);
+            buf.push_back('"');
+            start = i + 1;
+        }
+    }
+    buf.append(field.data() + start, field.size() - start);
+    buf.push_back('"');
+}
+
+void CSVWriter::endRow() {
+    endLine();
+    ++rows;
+}
+
+void CSVWriter::endLine() {
+    // A lone empty field is written as "" so readers don't take it for a blank line.
+    if (lineBlank && emptyField) buf.append("\"\"");
+    buf.push_back('\n');
+    rowStarted = false;
+    lineBlank = true;
+    emptyField = false;
+    if ((fd >= 0 || sink) && buf.size() >= threshold) flush();
+}
+
+void CSVWriter::writeHeader(const std::vector<std::string>& names) {
+    for (const auto& name : names) writeField(name);
+    endLine();
+}
+
+void CSVWriter::writeRow(const std::vector<std::string>& row) {
+    for (const auto& cell : row) writeField(cell);
+    endRow();
+}
+
+void CSVWriter::writeCell(const Value& cell) {
+    if (cell.isString()) {
+        writeField(cell.asString());
+    } else if (cell.isNull()) {
+        writeRawField("");
+    } else {
+        writeField(cell.toString());
+    }
+}
+
+void CSVWriter::writeRows(const Value& rows, bool header) {
+    if (!rows.isArray()) {
+        throw std::runtime_error("CSV output expects an array of rows");
+    }
+    const auto& arr = rows.asArray();
+
+    std::vector<std::string> keys;
+    if (!arr.empty() && arr.front().isObject()) {
+        for (const auto& kv : arr.front().asObject()) keys.push_back(kv.first);
+        std::sort(keys.begin(), keys.end());
+        if (header) writeHeader(keys);
+    }
+
+    for (const auto& row : arr) {
+        if (row.isArray()) {
+            for (const auto& cell : row.asArray()) writeCell(cell);
+        } else if (row.isObject()) {
+            const auto& obj = row.asObject();
+            for (const auto& k : keys) {
+                auto it = obj.find(k);
+                if (it == obj.end()) {
+                    writeRawField("");
+                } else {
+                    writeCell(it->second);
+                }
+            }
+        } else {
+            writeCell(row);
+        }
+        endRow();
+    }
+}
+
+void CSVWriter::writeTable(const Table& table, bool header) {
+    if (header) {
+        std::vector<std::string> names;
+        names.reserve(table.columns.size());
+        for (const auto& c : table.columns) names.push_back(c.name);
+        writeHeader(names);
+    }
+
+    // Escape each dictionary entry once instead of once per cell.
+    std::vector<std::vector<std::string>> escaped(table.columns.size());
+    for (size_t i = 0; i < table.columns.size(); ++i) {
+        const Column& c = table.columns[i];
+        if (c.type != ColumnType::String) continue;
+        escaped[i].reserve(c.dictionary->size());
+        for (const auto& s : *c.dictionary) escaped[i].push_back(escape(s, delimiter));
+    }
+
+    char num[32];
+    for (size_t r = 0; r < table.rowCount; ++r) {
+        for (size_t i = 0; i < table.columns.size(); ++i) {
+            const Column& c = table.columns[i];
+            if (!c.isValid(r)) {
+                writeRawField("");
+                continue;
+            }
+            switch (c.type) {
+            case ColumnType::Int64: {
+                auto res = std::to_chars(num, num + sizeof(num), c.ints[r]);
+                writeRawField(std::string_view(num, res.ptr - num));
+                break;
+            }
+            case ColumnType::Double:
+                writeRawField(formatDouble(c.doubles[r]));
+                break;
+            case ColumnType::String:
+                writeRawField(escaped[i][c.codes[r]]);
+                break;
+            }
+        }
+        endRow();
+    }
+}
+
+} // namespace dex
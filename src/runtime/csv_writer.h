@@ -0,0 +1,79 @@
+// src/runtime/csv_writer.h
+#ifndef DEX_CSV_WRITER_H
+#define DEX_CSV_WRITER_H
+
+#include "../interpreter/interpreter.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+namespace dex {
+
+class Table;
+class ByteSink;
+
+// Buffered RFC 4180 writer. Fields containing the delimiter, a quote or a
+// line break are quoted, with embedded quotes doubled, as is a row made of
+// one empty writeField() field (so it isn't read back as a blank line; an
+// empty writeRawField(), e.g. a null cell, stays blank). Output goes to a
+// caller-owned string, or to a file descriptor or ByteSink (e.g. a gzip
+// compressor) in bufferSize chunks.
+class CSVWriter {
+public:
+    explicit CSVWriter(std::string& out, char delimiter = ',');
+    explicit CSVWriter(int fd, size_t bufferSize = 1 << 20, char delimiter = ',');
+    // The sink must outlive the writer; call sink.finish() after flush().
+    explicit CSVWriter(ByteSink& sink, size_t bufferSize = 1 << 20, char delimiter = ',');
+    ~CSVWriter();
+
+    CSVWriter(const CSVWriter&) = delete;
+    CSVWriter& operator=(const CSVWriter&) = delete;
+
+    void writeField(std::string_view field);
+    // Appends a field that is known not to need quoting (numbers, pre-escaped text).
+    void writeRawField(std::string_view field);
+    void endRow();
+
+    void writeRow(const std::vector<std::string>& row);
+
+    // Writes an array of rows. Array rows are written cell by cell; object
+    // rows are written in the sorted key order of the first object, preceded
+    // by those keys as a header row if `header` is set. Null cells are
+    // empty; nested values use toString().
+    void writeRows(const Value& rows, bool header = true);
+    void writeTable(const Table& table, bool header = true);
+
+    // Pushes buffered bytes to the file descriptor or sink (no-op for string output).
+    // Throws std::runtime_error on write failure.
+    void flush();
+
+    // Rows ended so far, not counting header rows written by writeRows and
+    // writeTable.
+    size_t rowsWritten() const { return rows; }
+
+    // The quoted form of `field`, or the field itself if no quoting is needed.
+    static std::string escape(std::string_view field, char delimiter = ',');
+
+private:
+    std::string ownBuffer;
+    std::string& buf;
+    int fd = -1;
+    ByteSink* sink = nullptr;
+    size_t threshold = 0;
+    char delimiter;
+    bool rowStarted = false;
+    bool lineBlank = true;   // nothing written on the current line yet
+    bool emptyField = false; // writeField("") called on the current line
+    size_t rows = 0;
+
+    bool needsQuotes(std::string_view field) const;
+    void separator();
+    void endLine();
+    void writeHeader(const std::vector<std::string>& names);
+    void writeCell(const Value& cell);
+};
+
+} // namespace dex
+
+#endif // DEX_CSV_WRITER_H
@@ -1,23 +1,164 @@
-// src/runtime/database.cpp
-#include "database.h"
-#include "sqlite_database.h"
-#include "mysql_database.h"
-#include "postgres_database.h"
-#include <string>
-
-namespace dex {
-
-std::unique_ptr<Database> createDatabase(const std::string& connStr) {
-    if (connStr.rfind("sqlite://", 0) == 0) {
-        return std::make_unique<SQLiteDatabase>();
-    }
-    if (connStr.rfind("mysql://", 0) == 0) {
-        return std::make_unique<MySQLDatabase>();
-    }
-    if (connStr.rfind("postgresql://", 0) == 0) {
-        return std::make_unique<PostgresDatabase>();
-    }
-    return nullptr;
-}
-
-} // namespace dex
+// src/runtime/database.cpp
+#include "database.h"
+#include "sqlite_database.h"
+#include "mysql_database.h"
+#include "postgres_database.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+
+namespace dex {
+
+std::unique_ptr<Database> createDatabase(const std::string& connStr) {
+    if (connStr.rfind("sqlite://", 0) == 0) {
+        return std::make_unique<SQLiteDatabase>();
+    }
+    if (connStr.rfind("mysql://", 0) == 0) {
+        return std::make_unique<MySQLDatabase>();
+    }
+    if (connStr.rfind("postgresql://", 0) == 0) {
+        return std::make_unique<PostgresDatabase>();
+    }
+    return nullptr;
+}
+
+std::string quoteIdentifier(const std::string& name, char quote) {
+    std::string out;
+    out.reserve(name.size() + 2);
+    out += quote;
+    for (char c : name) {
+        if (c == '.') {
+            out += quote;
+            out += '.';
+            out += quote;
+            continue;
+        }
+        if (c == quote) out += quote;
+        out += c;
+    }
+    out += quote;
+    return out;
+}
+
+BulkInsertResult Database::bulkInsert(const std::string& table, const std::vector<std::string>& columns,
+                                      const std::vector<SqlParams>& rows) {
+    BulkInsertResult result;
+    if (table.empty() || columns.empty()) {
+        std::cerr << "bulkInsert error: a table and at least one column are required\n";
+        return result;
+    }
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (rows[i].size() != columns.size()) {
+            std::cerr << "bulkInsert error: row " << i << " has " << rows[i].size() << " values for "
+                      << columns.size() << " columns\n";
+            return result;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    result.ok = rows.empty() || insertRows(table, columns, rows);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (result.ok) result.rows = rows.size();
+    return result;
+}
+
+bool Database::begin() {
+    if (transactionOpen) {
+        std::cerr << "Transaction error: a transaction is already open on this connection\n";
+        return false;
+    }
+    transactionOpen = beginTransaction();
+    return transactionOpen;
+}
+
+bool Database::commit() {
+    if (!transactionOpen) {
+        std::cerr << "Transaction error: commit without an open transaction\n";
+        return false;
+    }
+    // A failed COMMIT still ends the transaction (the server rolls it back)
+    transactionOpen = false;
+    return commitTransaction();
+}
+
+bool Database::rollback() {
+    if (!transactionOpen) {
+        std::cerr << "Transaction error: rollback without an open transaction\n";
+        return false;
+    }
+    transactionOpen = false;
+    return rollbackTransaction();
+}
+
+bool Database::beginTransaction() {
+    return execute("BEGIN");
+}
+
+bool Database::commitTransaction() {
+    return execute("COMMIT");
+}
+
+bool Database::rollbackTransaction() {
+    return execute("ROLLBACK");
+}
+
+bool Database::executeBatch(const std::vector<BatchStatement>& statements) {
+    const bool own = !transactionOpen;
+    if (own && !begin()) return false;
+    for (size_t i = 0; i < statements.size(); ++i) {
+        const BatchStatement& s = statements[i];
+        bool ok = s.params.empty() ? execute(s.sql) : execute(s.sql, s.params);
+        if (!ok) {
+            std::cerr << "Batch error: statement " << i << " failed\n";
+            if (own) rollback();
+            return false;
+        }
+    }
+    return own ? commit() : true;
+}
+
+bool Database::registerTable(const std::string& name, std::shared_ptr<const Table> table) {
+    (void)table;
+    std::cerr << "Database error: can't expose " << name << " as a table; only SQLite supports in-memory tables\n";
+    return false;
+}
+
+bool Database::ping() {
+    return !query("SELECT 1").empty();
+}
+
+std::shared_ptr<PreparedStatement> Database::cachedStatement(const std::string& sql) {
+    // Keyed by the SQL alone on the default handle, so the common case
+    // builds no key
+    std::string scoped;
+    if (char handle = statementHandle()) {
+        scoped.reserve(sql.size() + 1);
+        scoped += handle;
+        scoped += sql;
+    }
+    const std::string& key = scoped.empty() ? sql : scoped;
+    if (auto* hit = statements.get(key)) {
+        ++cacheHits;
+        return *hit;
+    }
+    ++cacheMisses;
+    auto stmt = prepare(sql);
+    if (stmt) statements.put(key, stmt);
+    return stmt;
+}
+
+bool Database::execute(const std::string& sql, const SqlParams& params) {
+    auto stmt = cachedStatement(sql);
+    return stmt ? stmt->execute(params) : false;
+}
+
+QueryResult Database::query(const std::string& sql, const SqlParams& params) {
+    auto stmt = cachedStatement(sql);
+    return stmt ? stmt->query(params) : QueryResult{};
+}
+
+std::unique_ptr<QueryFuture> Database::queryAsync(const std::string& sql, const SqlParams& params) {
+    return std::make_unique<ReadyQueryFuture>(params.empty() ? query(sql) : query(sql, params));
+}
+
+} // namespace dex
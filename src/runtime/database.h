@@ -1,35 +1,199 @@
-// src/runtime/database.h
-#ifndef DEX_DATABASE_H
-#define DEX_DATABASE_H
-
-#include <string>
-#include <vector>
-#include <memory>
-
-namespace dex {
-
-using QueryResult = std::vector<std::vector<std::string>>;
-
-class Database {
-public:
-    virtual ~Database() = default;
-
-    // Connect to the database using connection string (format depends on DB type)
-    virtual bool connect(const std::string& connStr) = 0;
-
-    // Execute a query (no results expected)
-    virtual bool execute(const std::string& query) = 0;
-
-    // Execute a query and get results
-    virtual QueryResult query(const std::string& query) = 0;
-
-    // Close connection
-    virtual void close() = 0;
-};
-
-// Factory method to create appropriate Database subclass
-std::unique_ptr<Database> createDatabase(const std::string& connStr);
-
-} // namespace dex
-
-#endif
+// src/runtime/database.h
+#ifndef DEX_DATABASE_H
+#define DEX_DATABASE_H
+
+#include "lru_cache.h"
+#include "query_result.h"
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+#include <memory>
+
+namespace dex {
+
+class Table;
+
+// Positional statement parameter.
+using SqlValue = std::variant<std::nullptr_t, int64_t, double, std::string>;
+using SqlParams = std::vector<SqlValue>;
+
+// A statement parsed once by the server/engine and run many times with
+// different parameters. Placeholders are `?` on every backend.
+// Statements must not outlive the Database that prepared them.
+class PreparedStatement {
+public:
+    virtual ~PreparedStatement() = default;
+
+    virtual bool execute(const SqlParams& params) = 0;
+    virtual QueryResult query(const SqlParams& params) = 0;
+    virtual const std::string& sql() const = 0;
+};
+
+// Forward-only stream over a query's rows, for results too large to
+// materialize. The cursor owns server/engine-side state until it is
+// destroyed; the connection that opened it must not run other statements
+// meanwhile, and must outlive it.
+class Cursor {
+public:
+    virtual ~Cursor() = default;
+
+    // Up to `maxRows` further rows; an empty result once the rows run out
+    // (or on error, which is printed).
+    virtual QueryResult fetch(size_t maxRows) = 0;
+    bool exhausted() const { return done; }
+    // True when the rows stopped because of an error rather than running out.
+    bool failed() const { return error; }
+
+protected:
+    bool done = false;
+    bool error = false;
+};
+
+// Pending result of Database::queryAsync. get() waits for the result (an
+// empty result on error, which is printed) and may be called once.
+// Futures must not outlive the Database that issued them.
+class QueryFuture {
+public:
+    virtual ~QueryFuture() = default;
+
+    // True once get() would not block.
+    virtual bool ready() = 0;
+    virtual QueryResult get() = 0;
+};
+
+// Future whose result is already there: backends without pipelining, cache hits.
+class ReadyQueryFuture : public QueryFuture {
+public:
+    explicit ReadyQueryFuture(QueryResult r) : result(std::move(r)) {}
+
+    bool ready() override { return true; }
+    QueryResult get() override { return std::move(result); }
+
+private:
+    QueryResult result;
+};
+
+// One statement of a Database::executeBatch call.
+struct BatchStatement {
+    std::string sql;
+    SqlParams params;
+};
+
+// Outcome of Database::bulkInsert.
+struct BulkInsertResult {
+    bool ok = false;
+    size_t rows = 0;
+    double seconds = 0.0;
+
+    double rowsPerSecond() const { return seconds > 0.0 ? static_cast<double>(rows) / seconds : 0.0; }
+};
+
+class Database {
+public:
+    static constexpr size_t defaultStatementCacheSize = 64;
+
+    virtual ~Database() = default;
+
+    // Connect to the database using connection string (format depends on DB type)
+    virtual bool connect(const std::string& connStr) = 0;
+
+    // Execute a query (no results expected)
+    virtual bool execute(const std::string& query) = 0;
+
+    // Execute a query and get results
+    virtual QueryResult query(const std::string& query) = 0;
+
+    // Close connection
+    virtual void close() = 0;
+
+    // Cheap liveness check used by the connection pool before reusing an
+    // idle connection. The default runs `SELECT 1`.
+    virtual bool ping();
+
+    // Prepares `sql` for repeated execution. Returns nullptr on error.
+    virtual std::shared_ptr<PreparedStatement> prepare(const std::string& sql) = 0;
+
+    // Opens a streaming cursor over `sql`. Returns nullptr on error.
+    virtual std::unique_ptr<Cursor> cursor(const std::string& sql, const SqlParams& params) = 0;
+
+    // Parameterized execution through the per-connection statement cache:
+    // the first call with a given SQL text prepares it, later calls reuse it.
+    bool execute(const std::string& sql, const SqlParams& params);
+    QueryResult query(const std::string& sql, const SqlParams& params);
+
+    // Sends `sql` without waiting for its result, so many independent
+    // queries can be in flight on one connection; they run in the order
+    // issued. The default (backends without pipelining) runs it right away.
+    virtual std::unique_ptr<QueryFuture> queryAsync(const std::string& sql, const SqlParams& params);
+
+    // Explicit transactions. Between begin() and commit()/rollback() every
+    // statement on this connection joins the transaction instead of
+    // committing on its own. begin() fails if one is already open.
+    bool begin();
+    bool commit();
+    bool rollback();
+    bool inTransaction() const { return transactionOpen; }
+
+    // Runs `statements` as one unit: inside the open transaction, or in a
+    // transaction of its own that is rolled back if any statement fails.
+    // Backends that can pipeline statements send them without waiting for
+    // each result.
+    virtual bool executeBatch(const std::vector<BatchStatement>& statements);
+
+    // Loads `rows` into `table` through the backend's fastest path, all or
+    // nothing. Every row must have one value per column. Table and column
+    // names are quoted, so they are taken literally (a '.' separates schema).
+    BulkInsertResult bulkInsert(const std::string& table, const std::vector<std::string>& columns,
+                                const std::vector<SqlParams>& rows);
+
+    // Makes `table` queryable as `name` on this connection without loading
+    // it into the database; re-registering a name replaces the table. Only
+    // SQLite supports this (see VirtualTables): the default prints an error
+    // and returns false.
+    virtual bool registerTable(const std::string& name, std::shared_ptr<const Table> table);
+
+    // Cached statement for `sql`, preparing it on a miss (nullptr on error).
+    std::shared_ptr<PreparedStatement> cachedStatement(const std::string& sql);
+    // Which of the connection's handles statements prepared now run on, so
+    // the cache keeps one statement per handle rather than reusing one across
+    // them. Only SQLite in WAL mode has more than one (handle 1 is the
+    // writer, which a transaction runs everything on); wrappers report their
+    // inner connection's.
+    virtual char statementHandle() const { return 0; }
+
+    void setStatementCacheSize(size_t n) { statements.setCapacity(n); }
+    uint64_t statementCacheHits() const { return cacheHits; }
+    uint64_t statementCacheMisses() const { return cacheMisses; }
+
+protected:
+    // Backend parts of begin/commit/rollback. The defaults issue the SQL
+    // statements of the same name through execute().
+    virtual bool beginTransaction();
+    virtual bool commitTransaction();
+    virtual bool rollbackTransaction();
+
+    // Backend part of bulkInsert, called with validated arguments.
+    virtual bool insertRows(const std::string& table, const std::vector<std::string>& columns,
+                            const std::vector<SqlParams>& rows) = 0;
+
+    // Backends call this before tearing down the connection.
+    void clearStatementCache() { statements.clear(); }
+
+private:
+    LruCache<std::string, std::shared_ptr<PreparedStatement>> statements{defaultStatementCacheSize};
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+    bool transactionOpen = false;
+};
+
+// Quotes a possibly schema-qualified identifier ("a.b" -> "a"."b") with
+// `quote`, doubling embedded quote characters.
+std::string quoteIdentifier(const std::string& name, char quote = '"');
+
+// Factory method to create appropriate Database subclass
+std::unique_ptr<Database> createDatabase(const std::string& connStr);
+
+} // namespace dex
+
+#endif
@@ -1,145 +1,1475 @@
 #include "../interpreter/interpreter.h" // Include the updated interpreter.h
-#include <sqlite3.h>     // SQLite library header
+#include "database.h"    // Backend-independent Database interface + createDatabase
+#include "connection_pool.h" // Shared connections per connection string
+#include "query_result.h" // Typed ResultSet handles
+#include "binding_utils.h"
+#include "table.h"       // Columnar Table for Database.queryTable
+#include "csv_reader.h"  // CSV sources for Database.registerTable
+#include "pipeline.h"    // Threaded file-to-table loads for Pipeline.load, exportTo
+#include "instrumented_database.h" // Statement stats and slow-query log
 #include <iostream>      // For std::cerr, std::cout
 #include <vector>        // For std::vector
 #include <string>        // For std::string
-
-// Global SQLite database connection handle
-// In a real application, this should be managed more robustly,
-// e.g., passed around or stored in the Interpreter state.
-static sqlite3* db_connection = nullptr;
+#include <cerrno>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
 
 namespace dex {
 
-// Helper function to convert SQLite error codes to a string
-std::string sqliteErrorToString(int rc, sqlite3* db) {
-    if (rc != SQLITE_OK) {
-        std::string error_msg = "SQLite Error: " + std::string(sqlite3_errmsg(db));
+// Dex value returned by Database.connect. It refers to the pool for its
+// connection string rather than to one connection: every call checks a
+// connection out for its duration, so handles can be shared by concurrent
+// workers without reconnecting.
+// Database.begin returns a transaction handle instead: it pins one leased
+// connection (`pinned`) until commit or rollback, so every statement run
+// through it lands in the same transaction.
+class DatabaseHandle : public NativeObject {
+public:
+    DatabaseHandle(std::shared_ptr<ConnectionPool> connectionPool, std::string connStr)
+        : pool(std::move(connectionPool)), connStr(std::move(connStr)) {}
+
+    std::string typeName() const override { return pinned || parent ? "Transaction" : "Database"; }
+    // An open transaction's connection must only be used by one thread.
+    bool threadConfined() const override { return pinned != nullptr; }
+
+    std::shared_ptr<ConnectionPool> pool;
+    std::string connStr;
+    std::shared_ptr<Database> pinned;       // transaction handles only; reset once finished
+    std::shared_ptr<DatabaseHandle> parent; // handle the transaction was started from
+
+    // Connection the calling thread pipelines Database.queryAsync on while
+    // its futures are pending, checking one out if there is none. One per
+    // thread: handles are shared by WebServer workers, and a connection must
+    // only be used by one thread at a time. Returns nullptr if the pool is
+    // exhausted.
+    std::shared_ptr<Database> asyncConnection() {
+        const std::thread::id self = std::this_thread::get_id();
+        {
+            std::lock_guard<std::mutex> lock(asyncMutex);
+            auto it = asyncConnections.find(self);
+            if (it != asyncConnections.end()) {
+                if (auto db = it->second.lock()) return db;
+            }
+        }
+        // Checked out without the lock: acquire() may wait for the pool
+        std::shared_ptr<Database> db = pool->acquire();
+        if (!db) return nullptr;
+        std::lock_guard<std::mutex> lock(asyncMutex);
+        for (auto it = asyncConnections.begin(); it != asyncConnections.end();) {
+            it = it->second.expired() ? asyncConnections.erase(it) : std::next(it);
+        }
+        asyncConnections[self] = db;
+        return db;
+    }
+
+private:
+    std::mutex asyncMutex;
+    std::unordered_map<std::thread::id, std::weak_ptr<Database>> asyncConnections;
+};
+
+// Dex value returned by Database.cursor. The backend cursor lives on one
+// pooled connection, so the handle keeps that connection checked out until
+// the rows run out or Cursor.close is called. Iterating it yields row arrays.
+class CursorHandle : public NativeIterator {
+public:
+    static constexpr size_t rowBatch = 256; // rows fetched per round trip by next()
+
+    CursorHandle(std::shared_ptr<Database> lease, std::unique_ptr<Cursor> backendCursor)
+        : db(std::move(lease)), cursor(std::move(backendCursor)) {}
+
+    std::string typeName() const override { return "Cursor"; }
+
+    bool next(Value& out) override {
+        if (pos == buffered.rowCount) {
+            if (!cursor) return false;
+            buffered = cursor->fetch(rowBatch);
+            pos = 0;
+            if (cursor->exhausted()) close();
+            if (buffered.rowCount == 0) return false;
+        }
+        out = buffered.rowToDexValue(pos++);
+        return true;
+    }
+
+    // Up to `n` rows; rows already buffered by next() come first.
+    QueryResult fetchMany(size_t n) {
+        if (pos < buffered.rowCount) {
+            QueryResult out = buffered.slice(pos, pos + n);
+            pos += out.rowCount;
+            return out;
+        }
+        if (!cursor) return QueryResult();
+        QueryResult out = cursor->fetch(n);
+        if (out.rowCount < n || cursor->exhausted()) close();
+        return out;
+    }
+
+    void close() {
+        cursor.reset(); // before the connection it runs on goes back to the pool
+        db.reset();
+    }
+
+private:
+    std::shared_ptr<Database> db;
+    std::unique_ptr<Cursor> cursor;
+    QueryResult buffered;
+    size_t pos = 0;
+};
+
+// Dex value returned by Database.queryAsync. Keeps the connection its query
+// is pipelined on checked out until the result is collected; Future.await
+// returns the same ResultSet on every call.
+class FutureHandle : public NativeObject {
+public:
+    FutureHandle(std::shared_ptr<Database> lease, std::unique_ptr<QueryFuture> pending)
+        : db(std::move(lease)), future(std::move(pending)) {}
+
+    std::string typeName() const override { return "Future"; }
+
+    bool ready() { return !future || future->ready(); }
+
+    std::shared_ptr<QueryResult> await() {
+        if (future) {
+            result = std::make_shared<QueryResult>(future->get());
+            future.reset(); // before the connection it was issued on goes back to the pool
+            db.reset();
+        }
+        return result;
+    }
+
+private:
+    std::shared_ptr<Database> db;
+    std::unique_ptr<QueryFuture> future;
+    std::shared_ptr<QueryResult> result;
+};
+
+// Connection used by bindings called without a handle: the most recent
+// Database.connect, or the transaction begun on it. Kept per interpreter, so
+// WebServer worker isolates start out on the connection the script made
+// before serving, while a transaction one of them begins stays its own.
+static const char* const currentConnectionKey = "Database.current";
+
+static std::shared_ptr<DatabaseHandle> currentConnection(Interpreter& interp) {
+    return interp.moduleState(currentConnectionKey).asNative<DatabaseHandle>();
+}
+
+static void setCurrentConnection(Interpreter& interp, const std::shared_ptr<DatabaseHandle>& handle) {
+    interp.moduleState(currentConnectionKey) = handle ? Value(handle) : Value();
+}
+
+// Bindings accept an optional leading Database handle (`db.query(sql)` is
+// `Database.query(db, sql)`); without one they use the current connection.
+// Advances `first` past the handle and checks out a pooled connection, which
+// goes back to the pool when the returned pointer is released. Returns
+// nullptr with `error` set if nothing is connected or the pool is exhausted.
+static std::shared_ptr<Database> leaseDatabase(Interpreter& interp, const std::vector<Value>& args, size_t& first, std::string& error) {
+    first = 0;
+    std::shared_ptr<DatabaseHandle> handle = currentConnection(interp);
+    if (!args.empty()) {
+        if (auto explicitHandle = args[0].asNative<DatabaseHandle>()) {
+            first = 1;
+            handle = explicitHandle;
+        }
+    }
+    if (!handle) {
+        error = "Error: Not connected to a database. Call Database.connect first.";
+        return nullptr;
+    }
+    if (handle->parent) {
+        if (!handle->pinned) error = "Error: Transaction already committed or rolled back";
+        return handle->pinned;
+    }
+    auto db = handle->pool->acquire();
+    if (!db) error = "Error: No database connection available (pool exhausted or connect failed)";
+    return db;
+}
+
+// Dex values are strings, so parameters are typed here: canonical integers
+// ("42", "-7", no leading zeros) bind as int64 so comparisons and LIMIT stay
+// numeric, null binds as NULL and everything else binds as text.
+static bool sqlParamsFromValue(const Value& v, SqlParams& out, std::string& error) {
+    if (v.isNull()) return true;
+    if (!v.isArray()) {
+        error = "parameters must be an array";
+        return false;
+    }
+    out.reserve(v.asArray().size());
+    for (const auto& p : v.asArray()) {
+        if (p.isNull()) {
+            out.emplace_back(nullptr);
+        } else if (p.isString()) {
+            const std::string& s = p.asString();
+            char* end = nullptr;
+            errno = 0;
+            long long n = s.empty() ? 0 : std::strtoll(s.c_str(), &end, 10);
+            if (!s.empty() && errno == 0 && *end == '\0' && std::to_string(n) == s) {
+                out.emplace_back(static_cast<int64_t>(n));
+            } else {
+                out.emplace_back(s);
+            }
+        } else if (p.isArray() || p.isObject()) {
+            error = "parameters must be strings or null";
+            return false;
+        } else {
+            out.emplace_back(p.toString());
+        }
+    }
+    return true;
+}
+
+// Runs a query binding's common part: [handle,] sql [, params].
+// Returns false with `error` set on bad arguments or no connection.
+static bool runQuery(Interpreter& interp, const std::vector<Value>& args, const char* name, QueryResult& out, std::string& error) {
+    size_t first;
+    auto db = leaseDatabase(interp, args, first, error);
+    if (!db) return false;
+    if (args.size() < first + 1 || args.size() > first + 2 || !args[first].isString()) {
+        std::cerr << name << ": Expected an SQL string and optional parameter array." << std::endl;
+        error = std::string("Error: Invalid arguments for ") + name;
+        return false;
+    }
+
+    const std::string& sql = args[first].asString();
+    if (args.size() == first + 2) {
+        SqlParams params;
+        if (!sqlParamsFromValue(args[first + 1], params, error)) {
+            error = std::string("Error: ") + name + " " + error;
+            return false;
+        }
+        out = db->query(sql, params);
+    } else {
+        out = db->query(sql);
+    }
+    return true;
+}
+
+/**
+ * @brief Opens (or joins) the connection pool for a database and makes it the current one.
+ * Dex usage: `db = Database.connect("sqlite://app.db")`, `Database.connect("postgresql://...", {maxSize: "16"})`
+ * A bare path is treated as a SQLite file. Connecting twice with the same
+ * string shares one pool; options only apply when the pool is created.
+ * @param interp The interpreter instance.
+ * @param args Connection string, then an optional options object:
+ *             minSize / maxSize (connections, default 1 / 8),
+ *             idleTimeout, checkoutTimeout, healthCheckAfter (milliseconds),
+ *             statementCache (prepared statements kept per connection, default 64),
+ *             resultCache (bytes of read-only query results to cache, default 0 = off),
+ *             resultCacheTtl (milliseconds a cached result is served, default 30000).
+ * @return A Database handle, or an error message string.
+ */
+Value dex_database_connect(Interpreter& interp, const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 2 || !args[0].isString()) {
+        std::cerr << "Database.connect: Expected a connection string and optional options." << std::endl;
+        return Value("Error: Invalid arguments for Database.connect");
+    }
+
+    std::string connStr = args[0].asString();
+    if (connStr.find("://") == std::string::npos) {
+        connStr = "sqlite://" + connStr;
+    }
+    if (!createDatabase(connStr)) {
+        std::string error_msg = "Unsupported connection string: " + connStr;
         std::cerr << error_msg << std::endl;
-        return error_msg;
+        return Value(error_msg);
     }
-    return "OK";
+
+    PoolOptions options;
+    if (args.size() == 2) {
+        const Value& o = args[1];
+        auto count = [&](const char* key, size_t fallback) {
+            long long n = optionInt(o, key, static_cast<long long>(fallback));
+            return n > 0 ? static_cast<size_t>(n) : size_t{0};
+        };
+        auto millis = [&](const char* key, std::chrono::milliseconds fallback) {
+            long long n = optionInt(o, key, fallback.count());
+            return std::chrono::milliseconds(n > 0 ? n : 0);
+        };
+        options.minSize = count("minSize", options.minSize);
+        options.maxSize = count("maxSize", options.maxSize);
+        options.idleTimeout = millis("idleTimeout", options.idleTimeout);
+        options.checkoutTimeout = millis("checkoutTimeout", options.checkoutTimeout);
+        options.healthCheckAfter = millis("healthCheckAfter", options.healthCheckAfter);
+        options.statementCacheSize = count("statementCache", options.statementCacheSize);
+        options.resultCacheBytes = count("resultCache", options.resultCacheBytes);
+        options.resultCacheTtl = millis("resultCacheTtl", options.resultCacheTtl);
+    }
+
+    auto pool = ConnectionPool::forConnection(connStr, options);
+    if (!pool) {
+        return Value("Can't open database: " + connStr);
+    }
+    // minSize 0 opens nothing up front; check the database is reachable anyway
+    if (!pool->acquire()) {
+        return Value("Can't open database: " + connStr);
+    }
+
+    auto handle = std::make_shared<DatabaseHandle>(pool, connStr);
+    setCurrentConnection(interp, handle);
+    std::cout << "Successfully connected to database: " << connStr << std::endl;
+    return Value(handle);
+}
+
+// Handle argument of the pool-level bindings: the explicit one or the current connection.
+static std::shared_ptr<DatabaseHandle> poolHandle(Interpreter& interp, const std::vector<Value>& args, const char* name) {
+    std::shared_ptr<DatabaseHandle> handle = currentConnection(interp);
+    if (!args.empty()) {
+        handle = args[0].asNative<DatabaseHandle>();
+    }
+    if (!handle || args.size() > 1) {
+        std::cerr << name << ": Expected an optional Database handle." << std::endl;
+        return nullptr;
+    }
+    return handle;
 }
 
 /**
- * @brief Connects to an SQLite database.
- * Dex usage: `Database.connect("path/to/database.db")`
+ * @brief Reports connection pool usage for a handle (or the current connection).
+ * Dex usage: `stats = Database.poolStats(db)`
  * @param interp The interpreter instance.
- * @param args A vector of Dex Values. Expects one argument: database path (string).
- * @return A string indicating success ("OK") or an error message.
+ * @param args Optional Database handle.
+ * @return An object with open, idle, inUse, checkouts, waits, timeouts, created and evicted counts.
  */
-std::string dex_database_connect(Interpreter& interp, const std::vector<Value>& args) {
-    if (args.size() != 1 || !args[0].isString()) {
-        std::cerr << "Database.connect: Expected 1 string argument (database path)." << std::endl;
-        return "Error: Invalid arguments for Database.connect";
+Value dex_database_poolStats(Interpreter& interp, const std::vector<Value>& args) {
+    auto handle = poolHandle(interp, args, "Database.poolStats");
+    if (!handle) {
+        return Value("Error: Invalid arguments for Database.poolStats");
     }
 
-    const std::string& db_path = args[0].asString();
+    PoolStats stats = handle->pool->stats();
+    std::unordered_map<std::string, Value> out;
+    out["open"] = Value(std::to_string(stats.open));
+    out["idle"] = Value(std::to_string(stats.idle));
+    out["inUse"] = Value(std::to_string(stats.inUse));
+    out["checkouts"] = Value(std::to_string(stats.checkouts));
+    out["waits"] = Value(std::to_string(stats.waits));
+    out["timeouts"] = Value(std::to_string(stats.timeouts));
+    out["created"] = Value(std::to_string(stats.created));
+    out["evicted"] = Value(std::to_string(stats.evicted));
+    return Value(std::move(out));
+}
 
-    // Close existing connection if any
-    if (db_connection) {
-        sqlite3_close(db_connection);
-        db_connection = nullptr;
+/**
+ * @brief Reports result cache effectiveness, for tuning resultCache / resultCacheTtl.
+ * Dex usage: `stats = Database.cacheStats(db)`
+ * @param interp The interpreter instance.
+ * @param args Optional Database handle.
+ * @return An object with hits, misses, hitRate, stores, invalidations, expired,
+ *         evictions, entries, bytes and maxBytes, or an error message string.
+ */
+Value dex_database_cacheStats(Interpreter& interp, const std::vector<Value>& args) {
+    auto handle = poolHandle(interp, args, "Database.cacheStats");
+    if (!handle) {
+        return Value("Error: Invalid arguments for Database.cacheStats");
+    }
+    const auto& cache = handle->pool->resultCache();
+    if (!cache) {
+        return Value("Error: Result cache not enabled (pass {resultCache: bytes} to Database.connect)");
     }
 
-    int rc = sqlite3_open(db_path.c_str(), &db_connection);
-    if (rc) {
-        std::string error_msg = "Can't open database: " + std::string(sqlite3_errmsg(db_connection));
-        std::cerr << error_msg << std::endl;
-        // Ensure db_connection is null if open fails, as sqlite3_open might not set it on failure
-        if (db_connection) {
-            sqlite3_close(db_connection);
-            db_connection = nullptr;
+    QueryCacheStats stats = cache->stats();
+    std::unordered_map<std::string, Value> out;
+    out["hits"] = Value(std::to_string(stats.hits));
+    out["misses"] = Value(std::to_string(stats.misses));
+    out["hitRate"] = Value(formatDouble(stats.hitRate()));
+    out["stores"] = Value(std::to_string(stats.stores));
+    out["invalidations"] = Value(std::to_string(stats.invalidations));
+    out["expired"] = Value(std::to_string(stats.expired));
+    out["evictions"] = Value(std::to_string(stats.evictions));
+    out["entries"] = Value(std::to_string(stats.entries));
+    out["bytes"] = Value(std::to_string(stats.bytes));
+    out["maxBytes"] = Value(std::to_string(stats.maxBytes));
+    return Value(std::move(out));
+}
+
+/**
+ * @brief Drops every cached query result, e.g. after another process changed the data.
+ * Dex usage: `Database.clearCache(db)`
+ * @param interp The interpreter instance.
+ * @param args Optional Database handle.
+ * @return "OK" or an error message string.
+ */
+Value dex_database_clearCache(Interpreter& interp, const std::vector<Value>& args) {
+    auto handle = poolHandle(interp, args, "Database.clearCache");
+    if (!handle) {
+        return Value("Error: Invalid arguments for Database.clearCache");
+    }
+    if (const auto& cache = handle->pool->resultCache()) {
+        cache->clear();
+    }
+    return Value("OK");
+}
+
+/**
+ * @brief Per-statement timings of every database statement run by this process,
+ * grouped by statement shape (literals replaced by `?`), slowest total time first.
+ * Dex usage: `for s in Database.stats() { ... s.statement, s.p95Ms ... }`
+ * Percentiles come from log-linear histograms and are accurate to within 25%.
+ * @param interp The interpreter instance.
+ * @param args None.
+ * @return An array of objects with statement, calls, errors, totalMs, meanMs, p50Ms,
+ *         p95Ms, p99Ms, maxMs, rows, rowsP50, rowsMax, bytes, bytesP50 and bytesMax.
+ */
+Value dex_database_stats(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (!args.empty()) {
+        std::cerr << "Database.stats: Expected no arguments." << std::endl;
+        return Value("Error: Invalid arguments for Database.stats");
+    }
+    std::vector<Value> out;
+    for (const auto& s : DatabaseStats::instance().snapshot()) {
+        std::unordered_map<std::string, Value> row;
+        row["statement"] = Value(s.statement);
+        row["calls"] = Value(std::to_string(s.calls));
+        row["errors"] = Value(std::to_string(s.errors));
+        row["totalMs"] = Value(formatDouble(s.totalMs));
+        row["meanMs"] = Value(formatDouble(s.meanMs));
+        row["p50Ms"] = Value(formatDouble(s.p50Ms));
+        row["p95Ms"] = Value(formatDouble(s.p95Ms));
+        row["p99Ms"] = Value(formatDouble(s.p99Ms));
+        row["maxMs"] = Value(formatDouble(s.maxMs));
+        row["rows"] = Value(std::to_string(s.rows));
+        row["rowsP50"] = Value(std::to_string(s.rowsP50));
+        row["rowsMax"] = Value(std::to_string(s.rowsMax));
+        row["bytes"] = Value(std::to_string(s.bytes));
+        row["bytesP50"] = Value(std::to_string(s.bytesP50));
+        row["bytesMax"] = Value(std::to_string(s.bytesMax));
+        out.push_back(Value(std::move(row)));
+    }
+    return Value(std::move(out));
+}
+
+/**
+ * @brief Zeroes the statement stats, e.g. after a warm-up phase.
+ * Dex usage: `Database.resetStats()`
+ * @param interp The interpreter instance.
+ * @param args None.
+ * @return "OK".
+ */
+Value dex_database_resetStats(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    (void)args;
+
+    DatabaseStats::instance().reset();
+    return Value("OK");
+}
+
+/**
+ * @brief Configures the slow-query log and the stats dump at exit (which
+ * otherwise come from DEX_SLOW_QUERY_MS, DEX_SLOW_QUERY_LOG and DEX_DB_STATS).
+ * Dex usage: `Database.instrument({slowMs: "50", slowLog: "slow.log", dumpAtExit: "true"})`
+ * Slow statements are logged with their SQL, parameters and the script line
+ * that ran them.
+ * @param interp The interpreter instance.
+ * @param args Options: slowMs (threshold; 0 turns the log off), slowLog (file to
+ *             append to, "" for stderr), dumpAtExit ("true", "false", or a file path).
+ * @return "OK" or an error message string.
+ */
+Value dex_database_instrument(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() != 1 || !args[0].isObject()) {
+        std::cerr << "Database.instrument: Expected an options object." << std::endl;
+        return Value("Error: Invalid arguments for Database.instrument");
+    }
+    const Value& options = args[0];
+    DatabaseStats& stats = DatabaseStats::instance();
+    if (const Value* slowMs = findOption(options, "slowMs")) {
+        char* end = nullptr;
+        std::string text = slowMs->toString();
+        double ms = std::strtod(text.c_str(), &end);
+        if (text.empty() || *end != '\0') {
+            return Value("Error: Database.instrument slowMs must be a number");
         }
-        return error_msg;
-    } else {
-        std::cout << "Successfully connected to database: " << db_path << std::endl;
-        return "OK";
+        stats.setSlowThreshold(ms);
     }
+    if (const Value* slowLog = findOption(options, "slowLog")) {
+        if (!stats.setSlowLog(slowLog->toString())) {
+            return Value("Error: Database.instrument cannot open slow query log " + slowLog->toString());
+        }
+    }
+    if (const Value* dump = findOption(options, "dumpAtExit")) {
+        std::string target = dump->toString();
+        if (target == "false" || target == "0" || target.empty()) {
+            stats.dumpAtExit(false);
+        } else {
+            stats.dumpAtExit(true, target == "true" || target == "1" ? "" : target);
+        }
+    }
+    return Value("OK");
 }
 
 /**
  * @brief Executes a non-query SQL statement (e.g., INSERT, UPDATE, DELETE, CREATE TABLE).
- * Dex usage: `Database.execute("CREATE TABLE users (id INT, name TEXT)")`
+ * Dex usage: `Database.execute("INSERT INTO users (name) VALUES (?)", ["Alice"])`
+ * Statements are prepared once per connection and reused from its LRU cache.
  * @param interp The interpreter instance.
- * @param args A vector of Dex Values. Expects one argument: SQL statement (string).
+ * @param args [handle,] SQL statement, optional array of positional `?` parameters.
  * @return A string indicating success ("OK") or an error message.
  */
-std::string dex_database_execute(Interpreter& interp, const std::vector<Value>& args) {
-    if (!db_connection) {
-        return "Error: Not connected to a database. Call Database.connect first.";
+Value dex_database_execute(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    std::string error;
+    auto db = leaseDatabase(interp, args, first, error);
+    if (!db) {
+        return Value(error);
     }
-    if (args.size() != 1 || !args[0].isString()) {
-        std::cerr << "Database.execute: Expected 1 string argument (SQL statement)." << std::endl;
-        return "Error: Invalid arguments for Database.execute";
+    if (args.size() < first + 1 || args.size() > first + 2 || !args[first].isString()) {
+        std::cerr << "Database.execute: Expected an SQL string and optional parameter array." << std::endl;
+        return Value("Error: Invalid arguments for Database.execute");
     }
 
-    const std::string& sql = args[0].asString();
-    char* zErrMsg = 0;
-    int rc = sqlite3_exec(db_connection, sql.c_str(), 0, 0, &zErrMsg);
+    const std::string& sql = args[first].asString();
+    bool ok;
+    if (args.size() == first + 2) {
+        SqlParams params;
+        if (!sqlParamsFromValue(args[first + 1], params, error)) {
+            return Value("Error: Database.execute " + error);
+        }
+        ok = db->execute(sql, params);
+    } else {
+        ok = db->execute(sql);
+    }
+    if (!ok) {
+        return Value("SQL error: statement failed: " + sql);
+    }
+    return Value("OK");
+}
 
-    if (rc != SQLITE_OK) {
-        std::string error_msg = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        std::cerr << error_msg << std::endl;
-        return error_msg;
+/**
+ * @brief Executes a SQL query (e.g., SELECT) and returns its result set.
+ * Dex usage: `rs = Database.query("SELECT id, name FROM users WHERE id = ?", [id])`
+ * Values stay in their native types inside the ResultSet; read them with
+ * Result.rows / Result.row / Result.get / Result.column, which convert only
+ * what they return.
+ * @param interp The interpreter instance.
+ * @param args [handle,] SQL query, optional array of positional `?` parameters.
+ * @return A ResultSet handle, or an error message string.
+ */
+Value dex_database_query(Interpreter& interp, const std::vector<Value>& args) {
+    QueryResult result;
+    std::string error;
+    if (!runQuery(interp, args, "Database.query", result, error)) {
+        return Value(error);
+    }
+    return Value(std::make_shared<QueryResult>(std::move(result)));
+}
+
+/**
+ * @brief Executes a SQL query and loads the result into a columnar Table.
+ * Dex usage: `Database.queryTable("SELECT region, amount FROM sales WHERE year = ?", [2024])`
+ * Integer and real columns stay numeric, so Table.sum/groupBy run on them directly.
+ * @param interp The interpreter instance.
+ * @param args [handle,] SQL query, optional array of positional `?` parameters.
+ * @return A Table value, or an error message string.
+ */
+Value dex_database_queryTable(Interpreter& interp, const std::vector<Value>& args) {
+    QueryResult result;
+    std::string error;
+    if (!runQuery(interp, args, "Database.queryTable", result, error)) {
+        return Value(error);
+    }
+    return Value(result.toTable());
+}
+
+/**
+ * @brief Opens a streaming cursor over a query, for results too large to hold in memory.
+ * Dex usage: `cur = Database.cursor("SELECT * FROM events WHERE day = ?", [day])`,
+ *            then `Cursor.next(cur)` / `Cursor.fetchMany(cur, 1000)` until exhausted.
+ * SQLite steps the statement incrementally, Postgres fetches from a server-side
+ * cursor and MySQL reads a forward-only (unbuffered) result set.
+ * @param interp The interpreter instance.
+ * @param args [handle,] SQL query, optional array of positional `?` parameters.
+ * @return A Cursor handle, or an error message string.
+ */
+Value dex_database_cursor(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    std::string error;
+    auto db = leaseDatabase(interp, args, first, error);
+    if (!db) {
+        return Value(error);
+    }
+    if (args.size() < first + 1 || args.size() > first + 2 || !args[first].isString()) {
+        std::cerr << "Database.cursor: Expected an SQL string and optional parameter array." << std::endl;
+        return Value("Error: Invalid arguments for Database.cursor");
+    }
+
+    SqlParams params;
+    if (args.size() == first + 2 && !sqlParamsFromValue(args[first + 1], params, error)) {
+        return Value("Error: Database.cursor " + error);
+    }
+    auto cursor = db->cursor(args[first].asString(), params);
+    if (!cursor) {
+        return Value("SQL error: could not open cursor: " + args[first].asString());
+    }
+    return Value(std::make_shared<CursorHandle>(std::move(db), std::move(cursor)));
+}
+
+static std::shared_ptr<CursorHandle> requireCursor(const std::vector<Value>& args, size_t count, const char* name) {
+    std::shared_ptr<CursorHandle> cursor = args.empty() ? nullptr : args[0].asNative<CursorHandle>();
+    if (!cursor || args.size() != count) {
+        std::cerr << "Runtime Error: " << name << " expects a Cursor and " << (count - 1)
+                  << " more argument(s)." << std::endl;
+        throw std::runtime_error(std::string(name) + ": invalid arguments");
+    }
+    return cursor;
+}
+
+/**
+ * @brief Next row of a cursor as an array, or null once exhausted.
+ * Dex usage: `row = Cursor.next(cur)`
+ */
+Value dex_cursor_next(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto cursor = requireCursor(args, 1, "Cursor.next");
+    Value row;
+    return cursor->next(row) ? row : Value();
+}
+
+/**
+ * @brief Up to n further rows of a cursor as a ResultSet; an empty one once exhausted.
+ * Dex usage: `batch = Cursor.fetchMany(cur, 1000)`
+ */
+Value dex_cursor_fetchMany(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto cursor = requireCursor(args, 2, "Cursor.fetchMany");
+    long long n = args[1].isString() ? std::strtoll(args[1].asString().c_str(), nullptr, 10) : 0;
+    if (n <= 0) {
+        std::cerr << "Runtime Error: Cursor.fetchMany expects a positive row count." << std::endl;
+        throw std::runtime_error("Cursor.fetchMany: invalid row count");
+    }
+    return Value(std::make_shared<QueryResult>(cursor->fetchMany(static_cast<size_t>(n))));
+}
+
+/**
+ * @brief Closes a cursor early and returns its connection to the pool.
+ * Dex usage: `Cursor.close(cur)`
+ */
+Value dex_cursor_close(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto cursor = requireCursor(args, 1, "Cursor.close");
+    cursor->close();
+    return Value("OK");
+}
+
+// Rows of a Table as bulkInsert parameters, keeping native column types.
+static std::vector<SqlParams> tableRows(const Table& table) {
+    std::vector<SqlParams> rows(table.rowCount);
+    for (auto& row : rows) row.reserve(table.columns.size());
+    for (const auto& col : table.columns) {
+        for (size_t r = 0; r < table.rowCount; ++r) {
+            if (!col.isValid(r)) {
+                rows[r].emplace_back(nullptr);
+            } else if (col.type == ColumnType::Int64) {
+                rows[r].emplace_back(col.ints[r]);
+            } else if (col.type == ColumnType::Double) {
+                rows[r].emplace_back(col.doubles[r]);
+            } else {
+                rows[r].emplace_back((*col.dictionary)[col.codes[r]]);
+            }
+        }
+    }
+    return rows;
+}
+
+/**
+ * @brief Loads many rows into a table in one go, using each backend's bulk path:
+ * COPY FROM STDIN on Postgres, multi-row INSERT batches on MySQL, and one
+ * transaction around a reused prepared statement on SQLite. All or nothing.
+ * Dex usage: `Database.bulkInsert("users", ["id", "name"], [["1", "Ann"], ["2", "Bo"]])`
+ *            `Database.bulkInsert(db, "sales", FileIO.loadTable("sales.csv"))`
+ * @param interp The interpreter instance.
+ * @param args [handle,] table name, then either a column-name array and an array of
+ *             row arrays, or a Table (its column names and native types are used).
+ * @return An object with rows, seconds and rowsPerSec, or an error message string.
+ */
+Value dex_database_bulkInsert(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    std::string error;
+    auto db = leaseDatabase(interp, args, first, error);
+    if (!db) {
+        return Value(error);
+    }
+
+    const size_t argc = args.size() - first;
+    if ((argc != 2 && argc != 3) || !args[first].isString()) {
+        std::cerr << "Database.bulkInsert: Expected a table name and either columns + rows or a Table." << std::endl;
+        return Value("Error: Invalid arguments for Database.bulkInsert");
+    }
+
+    std::vector<std::string> columns;
+    std::vector<SqlParams> rows;
+    if (argc == 2) {
+        auto table = args[first + 1].asNative<Table>();
+        if (!table) {
+            return Value("Error: Database.bulkInsert expects a Table or column and row arrays");
+        }
+        for (const auto& col : table->columns) columns.push_back(col.name);
+        rows = tableRows(*table);
     } else {
-        std::cout << "SQL executed successfully: " << sql << std::endl;
-        return "OK";
+        if (!args[first + 1].isArray() || !args[first + 2].isArray()) {
+            return Value("Error: Database.bulkInsert expects column and row arrays");
+        }
+        for (const auto& name : args[first + 1].asArray()) {
+            if (!name.isString()) return Value("Error: Database.bulkInsert column names must be strings");
+            columns.push_back(name.asString());
+        }
+        const auto& input = args[first + 2].asArray();
+        rows.resize(input.size());
+        for (size_t i = 0; i < input.size(); ++i) {
+            if (!sqlParamsFromValue(input[i], rows[i], error)) {
+                return Value("Error: Database.bulkInsert row " + std::to_string(i) + ": " + error);
+            }
+        }
     }
+
+    BulkInsertResult result = db->bulkInsert(args[first].asString(), columns, rows);
+    if (!result.ok) {
+        return Value("SQL error: bulk insert into " + args[first].asString() + " failed");
+    }
+
+    std::unordered_map<std::string, Value> out;
+    out["rows"] = Value(std::to_string(result.rows));
+    out["seconds"] = Value(formatDouble(result.seconds));
+    out["rowsPerSec"] = Value(std::to_string(static_cast<long long>(result.rowsPerSecond())));
+    return Value(std::move(out));
 }
 
-// Callback function for sqlite3_exec in dex_database_query
-// This simple callback just prints results and appends to a string.
-static int query_callback(void* data, int argc, char** argv, char** azColName) {
-    std::string* result_str = static_cast<std::string*>(data);
-    for (int i = 0; i < argc; i++) {
-        result_str->append(azColName[i]);
-        result_str->append(": ");
-        result_str->append(argv[i] ? argv[i] : "NULL");
-        if (i < argc - 1) {
-            result_str->append(", ");
+// Starts a transaction on a connection leased from `handle`'s pool and
+// returns the handle that pins it. Returns nullptr with `error` set on failure.
+static std::shared_ptr<DatabaseHandle> beginTransaction(const std::shared_ptr<DatabaseHandle>& handle, std::string& error) {
+    auto db = handle->pool->acquire();
+    if (!db) {
+        error = "Error: No database connection available (pool exhausted or connect failed)";
+        return nullptr;
+    }
+    if (!db->begin()) {
+        error = "SQL error: could not begin transaction";
+        return nullptr;
+    }
+    auto tx = std::make_shared<DatabaseHandle>(handle->pool, handle->connStr);
+    tx->pinned = std::move(db);
+    tx->parent = handle;
+    return tx;
+}
+
+// Commits or rolls back `tx` and returns its connection to the pool. If it
+// was the current connection, its parent becomes current again.
+static bool finishTransaction(Interpreter& interp, const std::shared_ptr<DatabaseHandle>& tx, bool commit) {
+    std::shared_ptr<Database> db = std::move(tx->pinned);
+    bool ok = commit ? db->commit() : db->rollback();
+    if (currentConnection(interp) == tx) setCurrentConnection(interp, tx->parent);
+    return ok;
+}
+
+// Handle argument for begin/commit/rollback/transaction: the explicit one, or
+// the current connection. Advances `first` past an explicit handle.
+static std::shared_ptr<DatabaseHandle> handleArgument(Interpreter& interp, const std::vector<Value>& args, size_t& first) {
+    first = 0;
+    if (!args.empty()) {
+        if (auto handle = args[0].asNative<DatabaseHandle>()) {
+            first = 1;
+            return handle;
         }
     }
-    result_str->append("\n"); // Newline for each row
-    return 0;
+    return currentConnection(interp);
 }
 
 /**
- * @brief Executes a SQL query (e.g., SELECT) and returns results.
- * Dex usage: `Database.query("SELECT * FROM users WHERE id = 1")`
+ * @brief Starts an explicit transaction.
+ * Dex usage: `tx = Database.begin(db)`, run statements through `tx`, then `Database.commit(tx)`.
+ * Statements inside share one connection and one commit instead of
+ * committing (and syncing) one by one. Without an explicit handle the
+ * transaction also becomes the current connection until it finishes.
  * @param interp The interpreter instance.
- * @param args A vector of Dex Values. Expects one argument: SQL query (string).
- * @return A string containing the query results as a string, or an error message.
+ * @param args Optional Database handle.
+ * @return A Transaction handle, or an error message string.
  */
-std::string dex_database_query(Interpreter& interp, const std::vector<Value>& args) {
-    if (!db_connection) {
-        return "Error: Not connected to a database. Call Database.connect first.";
+Value dex_database_begin(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    auto handle = handleArgument(interp, args, first);
+    if (!handle) {
+        return Value("Error: Not connected to a database. Call Database.connect first.");
+    }
+    if (args.size() != first) {
+        std::cerr << "Database.begin: Expected an optional Database handle." << std::endl;
+        return Value("Error: Invalid arguments for Database.begin");
+    }
+    if (handle->parent) {
+        return Value("Error: A transaction is already open on this handle");
+    }
+
+    std::string error;
+    auto tx = beginTransaction(handle, error);
+    if (!tx) {
+        return Value(error);
+    }
+    if (first == 0) setCurrentConnection(interp, tx);
+    return Value(tx);
+}
+
+static Value finishBinding(Interpreter& interp, const std::vector<Value>& args, bool commit) {
+    const char* name = commit ? "Database.commit" : "Database.rollback";
+    size_t first;
+    auto tx = handleArgument(interp, args, first);
+    if (args.size() != first) {
+        std::cerr << name << ": Expected an optional Transaction handle." << std::endl;
+        return Value(std::string("Error: Invalid arguments for ") + name);
     }
-    if (args.size() != 1 || !args[0].isString()) {
-        std::cerr << "Database.query: Expected 1 string argument (SQL query)." << std::endl;
-        return "Error: Invalid arguments for Database.query";
+    if (!tx || !tx->pinned) {
+        return Value(std::string("Error: ") + name + " without an open transaction");
     }
+    if (!finishTransaction(interp, tx, commit)) {
+        return Value(std::string("SQL error: ") + (commit ? "commit" : "rollback") + " failed");
+    }
+    return Value("OK");
+}
 
-    const std::string& sql = args[0].asString();
-    char* zErrMsg = 0;
-    std::string query_result_str; // String to accumulate query results
+/**
+ * @brief Commits a transaction started with Database.begin.
+ * Dex usage: `Database.commit(tx)`
+ * @return "OK" or an error message string.
+ */
+Value dex_database_commit(Interpreter& interp, const std::vector<Value>& args) {
+    return finishBinding(interp, args, true);
+}
 
-    int rc = sqlite3_exec(db_connection, sql.c_str(), query_callback, &query_result_str, &zErrMsg);
+/**
+ * @brief Rolls back a transaction started with Database.begin.
+ * Dex usage: `Database.rollback(tx)`
+ * @return "OK" or an error message string.
+ */
+Value dex_database_rollback(Interpreter& interp, const std::vector<Value>& args) {
+    return finishBinding(interp, args, false);
+}
 
-    if (rc != SQLITE_OK) {
-        std::string error_msg = "SQL error: " + std::string(zErrMsg);
-        sqlite3_free(zErrMsg);
-        std::cerr << error_msg << std::endl;
-        return error_msg;
+/**
+ * @brief Runs a function inside a transaction: committed if it returns,
+ * rolled back if it raises an error (which is then re-raised).
+ * Dex usage: `Database.transaction(db, "transferFunds")`
+ * The function receives the Transaction handle, which is also the current
+ * connection while it runs. Called inside another transaction, it joins it.
+ * @param interp The interpreter instance.
+ * @param args Optional Database handle, then the function to run.
+ * @return The function's result, or an error message string if the commit fails.
+ */
+Value dex_database_transaction(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    auto handle = handleArgument(interp, args, first);
+    if (!handle) {
+        return Value("Error: Not connected to a database. Call Database.connect first.");
+    }
+    if (args.size() != first + 1) {
+        std::cerr << "Database.transaction: Expected an optional Database handle and a function." << std::endl;
+        return Value("Error: Invalid arguments for Database.transaction");
+    }
+    const Value& fn = args[first];
+
+    if (handle->pinned) {
+        return interp.callFunction(fn, {Value(handle)});
+    }
+
+    std::string error;
+    auto tx = beginTransaction(handle, error);
+    if (!tx) {
+        return Value(error);
+    }
+
+    auto previous = currentConnection(interp);
+    setCurrentConnection(interp, tx);
+    Value result;
+    try {
+        result = interp.callFunction(fn, {Value(tx)});
+    } catch (...) {
+        finishTransaction(interp, tx, false);
+        setCurrentConnection(interp, previous);
+        throw;
+    }
+    bool committed = tx->pinned ? finishTransaction(interp, tx, true) : true; // the function may have finished it
+    setCurrentConnection(interp, previous);
+    if (!committed) {
+        return Value("SQL error: commit failed");
+    }
+    return result;
+}
+
+/**
+ * @brief Runs a list of statements as one unit, pipelined where the backend supports it
+ * (Postgres sends them all before reading any result).
+ * Dex usage: `Database.batch(db, ["DELETE FROM t", ["INSERT INTO t VALUES (?, ?)", ["1", "a"]]])`
+ * Inside a transaction the batch joins it; otherwise it runs in its own and
+ * is rolled back if any statement fails.
+ * @param interp The interpreter instance.
+ * @param args [handle,] array of SQL strings or [sql, params] pairs.
+ * @return "OK" or an error message string.
+ */
+Value dex_database_batch(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    std::string error;
+    auto db = leaseDatabase(interp, args, first, error);
+    if (!db) {
+        return Value(error);
+    }
+    if (args.size() != first + 1 || !args[first].isArray()) {
+        std::cerr << "Database.batch: Expected an array of statements." << std::endl;
+        return Value("Error: Invalid arguments for Database.batch");
+    }
+
+    std::vector<BatchStatement> statements;
+    for (const auto& item : args[first].asArray()) {
+        BatchStatement stmt;
+        if (item.isString()) {
+            stmt.sql = item.asString();
+        } else if (item.isArray() && !item.asArray().empty() && item.asArray().size() <= 2 &&
+                   item.asArray()[0].isString()) {
+            stmt.sql = item.asArray()[0].asString();
+            if (item.asArray().size() == 2 && !sqlParamsFromValue(item.asArray()[1], stmt.params, error)) {
+                return Value("Error: Database.batch " + error);
+            }
+        } else {
+            return Value("Error: Database.batch statements must be SQL strings or [sql, params] pairs");
+        }
+        statements.push_back(std::move(stmt));
+    }
+
+    if (!db->executeBatch(statements)) {
+        return Value("SQL error: batch failed");
+    }
+    return Value("OK");
+}
+
+/**
+ * @brief Exposes in-memory rows to SQL as a read-only table, so scripts can
+ * join, filter and group them with SQLite instead of looping in Dex. SQLite
+ * reads the cells in place through a virtual table; nothing is copied into
+ * the database, and equality/range filters use a sorted index per column.
+ * Dex usage: `Database.registerTable(db, "sales", FileIO.loadTable("sales.csv"))`
+ *            `Database.registerTable(db, "regions", FileIO.parseCSV(text))`
+ *            `Database.registerTable(db, "events", "events.csv.gz", {delimiter: ";"})`
+ *            then `db.query("SELECT r.name, sum(s.amount) FROM sales s JOIN regions r ON ... GROUP BY r.name")`
+ * Every pooled connection of the handle sees the table (as temp.<name>);
+ * registering a name again replaces it. SQLite only.
+ * @param interp The interpreter instance.
+ * @param args [handle,] table name, then a Table, an array of row arrays (the
+ *             first naming the columns unless {header: "false"}) or of row objects,
+ *             or a CSV path (options as for FileIO.loadTable: header, delimiter,
+ *             quote, compression), then an optional options object.
+ * @return "OK" or an error message string.
+ */
+Value dex_database_registerTable(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    auto handle = handleArgument(interp, args, first);
+    if (!handle) {
+        return Value("Error: Not connected to a database. Call Database.connect first.");
+    }
+    const size_t argc = args.size() - first;
+    if ((argc != 2 && argc != 3) || !args[first].isString() || (argc == 3 && !args[first + 2].isObject())) {
+        std::cerr << "Database.registerTable: Expected a table name, a Table, rows or a CSV path, and optional options." << std::endl;
+        return Value("Error: Invalid arguments for Database.registerTable");
+    }
+
+    const std::string& name = args[first].asString();
+    const Value& source = args[first + 1];
+    const Value options = argc == 3 ? args[first + 2] : Value::nil();
+    std::shared_ptr<const Table> table;
+    try {
+        if (auto native = source.asNative<Table>()) {
+            table = native;
+        } else if (source.isArray()) {
+            table = tableFromRows(source.asArray(), optionBool(options, "header", true));
+        } else if (source.isString()) {
+            CSVOptions csv;
+            csv.header = optionBool(options, "header", true);
+            std::string delimiter = optionString(options, "delimiter", ",");
+            std::string quote = optionString(options, "quote", "\"");
+            if (delimiter.size() != 1 || quote.size() != 1) {
+                return Value("Error: Database.registerTable delimiter and quote must be single characters");
+            }
+            csv.delimiter = delimiter[0];
+            csv.quote = quote[0];
+            csv.compression = parseCompression(optionString(options, "compression", "auto"));
+            CSVReader reader(source.asString(), csv);
+            table = tableFromCSV(reader);
+        } else {
+            return Value("Error: Database.registerTable expects a Table, an array of rows or a CSV path");
+        }
+    } catch (const std::exception& e) {
+        return Value(std::string("Error: Database.registerTable ") + e.what());
+    }
+
+    std::string error;
+    auto db = leaseDatabase(interp, args, first, error);
+    if (!db) {
+        return Value(error);
+    }
+    if (!db->registerTable(name, table)) {
+        return Value("SQL error: could not register table " + name);
+    }
+    handle->pool->shareTable(name, std::move(table));
+    return Value("OK");
+}
+
+// Pipeline batch as the transform callback sees it: an array of row objects keyed by column.
+static Value batchToDexValue(const std::vector<std::string>& columns, const RowBatch& batch) {
+    std::vector<Value> rows;
+    rows.reserve(batch.rows.size());
+    for (const auto& params : batch.rows) {
+        std::unordered_map<std::string, Value> row;
+        for (size_t i = 0; i < columns.size() && i < params.size(); ++i) {
+            const SqlValue& v = params[i];
+            if (std::holds_alternative<int64_t>(v)) {
+                row[columns[i]] = Value(std::to_string(std::get<int64_t>(v)));
+            } else if (std::holds_alternative<double>(v)) {
+                row[columns[i]] = Value(formatDouble(std::get<double>(v)));
+            } else if (std::holds_alternative<std::string>(v)) {
+                row[columns[i]] = Value(std::get<std::string>(v));
+            } else {
+                row[columns[i]] = Value::nil();
+            }
+        }
+        rows.push_back(Value(std::move(row)));
+    }
+    return Value(std::move(rows));
+}
+
+// Rows returned by the transform callback: row objects (missing keys are
+// null) or row arrays in column order.
+static bool batchFromDexValue(const std::vector<std::string>& columns, const Value& v, RowBatch& out,
+                              std::string& error) {
+    if (!v.isArray()) {
+        error = "the transform function must return an array of rows";
+        return false;
+    }
+    out.rows.clear();
+    out.rows.reserve(v.asArray().size());
+    for (const auto& row : v.asArray()) {
+        Value cells = row;
+        if (row.isObject()) {
+            std::vector<Value> ordered;
+            ordered.reserve(columns.size());
+            for (const auto& name : columns) {
+                auto it = row.asObject().find(name);
+                ordered.push_back(it == row.asObject().end() ? Value::nil() : it->second);
+            }
+            cells = Value(std::move(ordered));
+        } else if (!row.isArray() || row.asArray().size() > columns.size()) {
+            error = "transformed rows must be objects or arrays of at most " + std::to_string(columns.size()) + " cells";
+            return false;
+        }
+        SqlParams params;
+        if (!sqlParamsFromValue(cells, params, error)) return false;
+        params.resize(columns.size(), nullptr);
+        out.rows.push_back(std::move(params));
+    }
+    return true;
+}
+
+/**
+ * @brief Streams a CSV or JSONL file into a table: reading (and decompressing),
+ * parsing and bulk inserting run on separate threads joined by bounded queues,
+ * so parse and load overlap and memory stays flat however large the file is.
+ * Dex usage: `Pipeline.load("events.jsonl.gz", db, "events")`
+ *            `Pipeline.load("sales.csv", db, "sales", {batchRows: "10000", transform: "cleanBatch"})`
+ * The file is never materialized; a slow stage holds the others back
+ * (backpressure). The load is one transaction unless {atomic: "false"}.
+ * @param interp The interpreter instance.
+ * @param args Source path, Database (or Transaction) handle, table name, and optional options:
+ *             format ("csv" or "jsonl", default by extension), compression,
+ *             header / delimiter / quote (CSV), columns (target columns, default the
+ *             CSV header or the first JSON object's keys), batchRows (default 5000),
+ *             queueDepth (batches buffered per stage, default 8), bufferSize (read size),
+ *             atomic, and transform: a function called with each batch as an array of
+ *             row objects, returning the rows to load (an empty array skips the batch).
+ * @return An object with rows, seconds, rowsPerSec and stages (name, items, rows, bytes,
+ *         busy, waitIn and waitOut seconds per stage), or an error message string.
+ */
+Value dex_pipeline_load(Interpreter& interp, const std::vector<Value>& args) {
+    if (args.size() < 3 || args.size() > 4 || !args[0].isString() || !args[1].asNative<DatabaseHandle>() ||
+        !args[2].isString() || (args.size() == 4 && !args[3].isObject())) {
+        std::cerr << "Pipeline.load: Expected a source path, a Database handle, a table name and optional options." << std::endl;
+        return Value("Error: Invalid arguments for Pipeline.load");
+    }
+    const std::string& path = args[0].asString();
+    const std::string& table = args[2].asString();
+    const Value options = args.size() == 4 ? args[3] : Value::nil();
+
+    LoadOptions load;
+    Value transformFn;
+    try {
+        std::string format = optionString(options, "format", "");
+        if (format.empty()) {
+            load.format = sourceFormatFor(path);
+        } else if (format == "csv" || format == "jsonl") {
+            load.format = format == "csv" ? SourceFormat::CSV : SourceFormat::JSONL;
+        } else {
+            return Value("Error: Pipeline.load format must be csv or jsonl");
+        }
+        load.compression = parseCompression(optionString(options, "compression", "auto"));
+        std::string delimiter = optionString(options, "delimiter", ",");
+        std::string quote = optionString(options, "quote", "\"");
+        if (delimiter.size() != 1 || quote.size() != 1) {
+            return Value("Error: Pipeline.load delimiter and quote must be single characters");
+        }
+        load.delimiter = delimiter[0];
+        load.quote = quote[0];
+        load.header = optionBool(options, "header", true);
+        if (const Value* columns = findOption(options, "columns")) {
+            if (!columns->isArray()) return Value("Error: Pipeline.load columns must be an array of names");
+            for (const auto& name : columns->asArray()) {
+                if (!name.isString()) return Value("Error: Pipeline.load columns must be an array of names");
+                load.columns.push_back(name.asString());
+            }
+        }
+        auto count = [&](const char* key, size_t fallback) {
+            long long n = optionInt(options, key, static_cast<long long>(fallback));
+            return n > 0 ? static_cast<size_t>(n) : fallback;
+        };
+        load.batchRows = count("batchRows", load.batchRows);
+        load.queueDepth = count("queueDepth", load.queueDepth);
+        load.chunkBytes = count("bufferSize", load.chunkBytes);
+        load.atomic = optionBool(options, "atomic", true);
+        if (const Value* fn = findOption(options, "transform")) transformFn = *fn;
+    } catch (const std::exception& e) {
+        return Value(std::string("Error: Pipeline.load ") + e.what());
+    }
+
+    size_t first;
+    std::string error;
+    auto db = leaseDatabase(interp, {args[1]}, first, error);
+    if (!db) {
+        return Value(error);
+    }
+
+    BatchTransform transform;
+    if (!transformFn.isNull()) {
+        transform = [&](const std::vector<std::string>& columns, RowBatch& batch, std::string& err) {
+            Value result = interp.callFunction(transformFn, {batchToDexValue(columns, batch)});
+            return batchFromDexValue(columns, result, batch, err);
+        };
+    }
+    LoadReport report = loadFile(path, *db, table, load, transform);
+    if (!report.ok) {
+        return Value("Error: Pipeline.load " + report.error);
+    }
+
+    std::vector<Value> stages;
+    for (const auto& m : report.stages) {
+        std::unordered_map<std::string, Value> stage;
+        stage["name"] = Value(m.name);
+        stage["items"] = Value(std::to_string(m.items));
+        stage["rows"] = Value(std::to_string(m.rows));
+        stage["bytes"] = Value(std::to_string(m.bytes));
+        stage["busy"] = Value(formatDouble(m.busySeconds));
+        stage["waitIn"] = Value(formatDouble(m.waitInSeconds));
+        stage["waitOut"] = Value(formatDouble(m.waitOutSeconds));
+        stages.push_back(Value(std::move(stage)));
+    }
+    std::unordered_map<std::string, Value> out;
+    out["rows"] = Value(std::to_string(report.rows));
+    out["seconds"] = Value(formatDouble(report.seconds));
+    out["rowsPerSec"] = Value(std::to_string(static_cast<long long>(report.rowsPerSecond())));
+    out["stages"] = Value(std::move(stages));
+    return Value(std::move(out));
+}
+
+/**
+ * @brief Writes the rows of a query straight to a file, without building the
+ * result in memory: rows stream from a cursor, batch by batch, through the
+ * serializer into a buffered (optionally compressed) file writer.
+ * Dex usage: `Database.exportTo("SELECT * FROM events", "events.csv.gz")`
+ *            `Database.exportTo(db, "SELECT * FROM events WHERE day = ?", "day.dexv", "binary", {params: [day]})`
+ * The file appears only once the export is complete.
+ * @param interp The interpreter instance.
+ * @param args [handle,] SQL query, target path, optional format ("csv", "jsonl" or
+ *             "binary"; default by extension: .jsonl/.ndjson, .dexv, otherwise CSV),
+ *             and optional options: params (array of positional `?` parameters),
+ *             compression, header / delimiter (CSV), batchRows (rows per fetch,
+ *             default 1024), bufferSize (bytes per write).
+ *             Binary files read back with FileIO.openValues: the column names first, then one array per row.
+ * @return An object with rows, bytes (before compression) and seconds, or an error message string.
+ */
+Value dex_database_exportTo(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    std::string error;
+    auto db = leaseDatabase(interp, args, first, error);
+    if (!db) {
+        return Value(error);
+    }
+    size_t n = args.size() - first;
+    bool hasFormat = n >= 3 && args[first + 2].isString();
+    size_t optionsAt = first + (hasFormat ? 3 : 2);
+    if (n < 2 || !args[first].isString() || !args[first + 1].isString() || args.size() > optionsAt + 1 ||
+        (args.size() == optionsAt + 1 && !args[optionsAt].isObject())) {
+        std::cerr << "Database.exportTo: Expected an SQL string, a path, an optional format and optional options." << std::endl;
+        return Value("Error: Invalid arguments for Database.exportTo");
+    }
+    const std::string& sql = args[first].asString();
+    const std::string& path = args[first + 1].asString();
+    const Value options = args.size() == optionsAt + 1 ? args[optionsAt] : Value::nil();
+
+    ExportOptions exportOptions;
+    SqlParams params;
+    try {
+        std::string format = hasFormat ? args[first + 2].asString() : optionString(options, "format", "");
+        if (format.empty()) {
+            exportOptions.format = exportFormatFor(path);
+        } else if (format == "csv") {
+            exportOptions.format = ExportFormat::CSV;
+        } else if (format == "jsonl") {
+            exportOptions.format = ExportFormat::JSONL;
+        } else if (format == "binary") {
+            exportOptions.format = ExportFormat::Binary;
+        } else {
+            return Value("Error: Database.exportTo format must be csv, jsonl or binary");
+        }
+        exportOptions.compression = parseCompression(optionString(options, "compression", "auto"));
+        std::string delimiter = optionString(options, "delimiter", ",");
+        if (delimiter.size() != 1) {
+            return Value("Error: Database.exportTo delimiter must be a single character");
+        }
+        exportOptions.delimiter = delimiter[0];
+        exportOptions.header = optionBool(options, "header", true);
+        long long batchRows = optionInt(options, "batchRows", static_cast<long long>(exportOptions.batchRows));
+        long long bufferSize = optionInt(options, "bufferSize", static_cast<long long>(exportOptions.bufferSize));
+        if (batchRows > 0) exportOptions.batchRows = static_cast<size_t>(batchRows);
+        if (bufferSize > 0) exportOptions.bufferSize = static_cast<size_t>(bufferSize);
+    } catch (const std::exception& e) {
+        return Value(std::string("Error: Database.exportTo ") + e.what());
+    }
+    if (const Value* bound = findOption(options, "params")) {
+        if (!sqlParamsFromValue(*bound, params, error)) return Value("Error: Database.exportTo " + error);
+    }
+
+    ExportReport report = exportQuery(*db, sql, params, path, exportOptions);
+    if (!report.ok) {
+        return Value("Error: Database.exportTo " + report.error);
+    }
+    std::unordered_map<std::string, Value> out;
+    out["rows"] = Value(std::to_string(report.rows));
+    out["bytes"] = Value(std::to_string(report.bytes));
+    out["seconds"] = Value(formatDouble(report.seconds));
+    return Value(std::move(out));
+}
+
+/**
+ * @brief Sends a query without waiting for its result.
+ * Dex usage: `a = Database.queryAsync(db, "SELECT ...")`, `b = Database.queryAsync(db, "SELECT ...", [id])`,
+ *            then `rs = Future.await(a)`.
+ * Queries issued through one handle while its earlier futures are pending
+ * share a connection and are pipelined on Postgres, so N independent
+ * queries cost about one round trip instead of N. They run in the order
+ * issued; statements run through other calls may use another connection,
+ * so await a write before relying on it. Other backends run the query
+ * immediately and return a ready future.
+ * @param interp The interpreter instance.
+ * @param args [handle,] SQL query, optional array of positional `?` parameters.
+ * @return A Future handle, or an error message string.
+ */
+Value dex_database_queryAsync(Interpreter& interp, const std::vector<Value>& args) {
+    size_t first;
+    auto handle = handleArgument(interp, args, first);
+    if (!handle) {
+        return Value("Error: Not connected to a database. Call Database.connect first.");
+    }
+    if (args.size() < first + 1 || args.size() > first + 2 || !args[first].isString()) {
+        std::cerr << "Database.queryAsync: Expected an SQL string and optional parameter array." << std::endl;
+        return Value("Error: Invalid arguments for Database.queryAsync");
+    }
+    std::string error;
+    SqlParams params;
+    if (args.size() == first + 2 && !sqlParamsFromValue(args[first + 1], params, error)) {
+        return Value("Error: Database.queryAsync " + error);
+    }
+
+    std::shared_ptr<Database> db;
+    if (handle->parent) {
+        db = handle->pinned;
+        if (!db) return Value("Error: Transaction already committed or rolled back");
     } else {
-        std::cout << "SQL query executed successfully: " << sql << std::endl;
-        // If no rows returned, query_result_str might be empty.
-        if (query_result_str.empty()) {
-            return "Query successful, no rows returned.";
+        db = handle->asyncConnection();
+        if (!db) return Value("Error: No database connection available (pool exhausted or connect failed)");
+    }
+    auto future = db->queryAsync(args[first].asString(), params);
+    return Value(std::make_shared<FutureHandle>(std::move(db), std::move(future)));
+}
+
+static std::shared_ptr<FutureHandle> requireFuture(const Value& v, const char* name) {
+    std::shared_ptr<FutureHandle> future = v.asNative<FutureHandle>();
+    if (!future) {
+        std::cerr << "Runtime Error: " << name << " expects a Future from Database.queryAsync." << std::endl;
+        throw std::runtime_error(std::string(name) + ": invalid arguments");
+    }
+    return future;
+}
+
+/**
+ * @brief Whether a future's result has arrived, without waiting.
+ * Dex usage: `if (Future.ready(f) == "true") { ... }`
+ */
+Value dex_future_ready(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    if (args.size() != 1) {
+        std::cerr << "Runtime Error: Future.ready expects one Future." << std::endl;
+        throw std::runtime_error("Future.ready: invalid arguments");
+    }
+    return Value(requireFuture(args[0], "Future.ready")->ready() ? "true" : "false");
+}
+
+/**
+ * @brief Waits for a future and returns its ResultSet (empty if the query failed).
+ * Dex usage: `rs = Future.await(f)`
+ */
+Value dex_future_await(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    if (args.size() != 1) {
+        std::cerr << "Runtime Error: Future.await expects one Future." << std::endl;
+        throw std::runtime_error("Future.await: invalid arguments");
+    }
+    return Value(requireFuture(args[0], "Future.await")->await());
+}
+
+/**
+ * @brief Waits for an array of futures and returns their ResultSets in the same order.
+ * Dex usage: `results = Future.awaitAll([a, b, c])`
+ */
+Value dex_future_awaitAll(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    if (args.size() != 1 || !args[0].isArray()) {
+        std::cerr << "Runtime Error: Future.awaitAll expects an array of Futures." << std::endl;
+        throw std::runtime_error("Future.awaitAll: invalid arguments");
+    }
+    std::vector<Value> results;
+    results.reserve(args[0].asArray().size());
+    for (const auto& item : args[0].asArray()) {
+        results.push_back(Value(requireFuture(item, "Future.awaitAll")->await()));
+    }
+    return Value(std::move(results));
+}
+
+// Result.* accessors. The first argument is a ResultSet from Database.query.
+static std::shared_ptr<QueryResult> requireResultSet(const std::vector<Value>& args, size_t count, const char* name) {
+    std::shared_ptr<QueryResult> rs = args.empty() ? nullptr : args[0].asNative<QueryResult>();
+    if (!rs || args.size() != count) {
+        std::cerr << "Runtime Error: " << name << " expects a ResultSet and " << (count - 1)
+                  << " more argument(s)." << std::endl;
+        throw std::runtime_error(std::string(name) + ": invalid arguments");
+    }
+    return rs;
+}
+
+// Row index argument, bounds-checked against the result.
+static size_t rowIndex(const QueryResult& rs, const Value& v, const char* name) {
+    long long row = v.isString() ? std::strtoll(v.asString().c_str(), nullptr, 10) : -1;
+    if (row < 0 || static_cast<size_t>(row) >= rs.rowCount) {
+        std::cerr << "Runtime Error: " << name << ": row " << v.toString() << " out of range (result has "
+                  << rs.rowCount << " rows)." << std::endl;
+        throw std::runtime_error(std::string(name) + ": row out of range");
+    }
+    return static_cast<size_t>(row);
+}
+
+// Column argument: a column name or a numeric position.
+static size_t columnIndex(const QueryResult& rs, const Value& v, const char* name) {
+    if (v.isString()) {
+        const std::string& key = v.asString();
+        for (size_t i = 0; i < rs.columns.size(); ++i) {
+            if (rs.columns[i].name == key) return i;
         }
-        return query_result_str;
+        char* end = nullptr;
+        unsigned long long idx = std::strtoull(key.c_str(), &end, 10);
+        if (!key.empty() && *end == '\0' && idx < rs.columns.size()) return static_cast<size_t>(idx);
     }
+    std::cerr << "Runtime Error: " << name << ": no column " << v.toString() << "." << std::endl;
+    throw std::runtime_error(std::string(name) + ": unknown column");
+}
+
+/**
+ * @brief Number of rows in a ResultSet.
+ * Dex usage: `n = Result.rowCount(rs)`
+ */
+Value dex_result_rowCount(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto rs = requireResultSet(args, 1, "Result.rowCount");
+    return Value(std::to_string(rs->rowCount));
+}
+
+/**
+ * @brief Column names of a ResultSet, in select order.
+ * Dex usage: `names = Result.columns(rs)`
+ */
+Value dex_result_columns(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto rs = requireResultSet(args, 1, "Result.columns");
+    std::vector<Value> names;
+    for (const auto& c : rs->columns) names.emplace_back(c.name);
+    return Value(std::move(names));
+}
+
+/**
+ * @brief Column storage types of a ResultSet: integer, real, text, blob, or null when unknown.
+ * Dex usage: `types = Result.types(rs)`
+ */
+Value dex_result_types(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto rs = requireResultSet(args, 1, "Result.types");
+    std::vector<Value> types;
+    for (const auto& c : rs->columns) types.emplace_back(sqlTypeName(c.type));
+    return Value(std::move(types));
+}
+
+/**
+ * @brief All rows as arrays (NULL cells are null).
+ * Dex usage: `for row in Result.rows(rs) { print(row[0]) }`
+ */
+Value dex_result_rows(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto rs = requireResultSet(args, 1, "Result.rows");
+    return rs->toDexValue();
+}
+
+/**
+ * @brief One row as an array.
+ * Dex usage: `row = Result.row(rs, 0)`
+ */
+Value dex_result_row(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto rs = requireResultSet(args, 2, "Result.row");
+    return rs->rowToDexValue(rowIndex(*rs, args[1], "Result.row"));
+}
+
+/**
+ * @brief One cell, by row index and column name or position.
+ * Dex usage: `name = Result.get(rs, 0, "name")`
+ */
+Value dex_result_get(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto rs = requireResultSet(args, 3, "Result.get");
+    size_t row = rowIndex(*rs, args[1], "Result.get");
+    size_t col = columnIndex(*rs, args[2], "Result.get");
+    return rs->columns[col].cellToDexValue(row);
+}
+
+/**
+ * @brief One column as an array, by name or position.
+ * Dex usage: `ids = Result.column(rs, "id")`
+ */
+Value dex_result_column(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto rs = requireResultSet(args, 2, "Result.column");
+    return rs->columnToDexValue(columnIndex(*rs, args[1], "Result.column"));
+}
+
+/**
+ * @brief Converts a ResultSet to a columnar Table.
+ * Dex usage: `t = Result.toTable(rs)`
+ */
+Value dex_result_toTable(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto rs = requireResultSet(args, 1, "Result.toTable");
+    return Value(rs->toTable());
 }
 
 /**
@@ -151,6 +1481,41 @@ void registerDatabaseBindings(Interpreter& interp) {
     interp.registerFunction("Database.connect", dex_database_connect);
     interp.registerFunction("Database.execute", dex_database_execute);
     interp.registerFunction("Database.query", dex_database_query);
+    interp.registerFunction("Database.queryTable", dex_database_queryTable);
+    interp.registerFunction("Database.cursor", dex_database_cursor);
+    interp.registerFunction("Database.exportTo", dex_database_exportTo);
+    interp.registerFunction("Database.bulkInsert", dex_database_bulkInsert);
+    interp.registerFunction("Database.begin", dex_database_begin);
+    interp.registerFunction("Database.commit", dex_database_commit);
+    interp.registerFunction("Database.rollback", dex_database_rollback);
+    interp.registerFunction("Database.transaction", dex_database_transaction);
+    interp.registerFunction("Database.batch", dex_database_batch);
+    interp.registerFunction("Database.registerTable", dex_database_registerTable);
+    interp.registerFunction("Pipeline.load", dex_pipeline_load);
+    interp.registerFunction("Database.poolStats", dex_database_poolStats);
+    interp.registerFunction("Database.cacheStats", dex_database_cacheStats);
+    interp.registerFunction("Database.clearCache", dex_database_clearCache);
+    interp.registerFunction("Database.stats", dex_database_stats);
+    interp.registerFunction("Database.resetStats", dex_database_resetStats);
+    interp.registerFunction("Database.instrument", dex_database_instrument);
+
+    interp.registerFunction("Database.queryAsync", dex_database_queryAsync);
+    interp.registerFunction("Future.ready", dex_future_ready);
+    interp.registerFunction("Future.await", dex_future_await);
+    interp.registerFunction("Future.awaitAll", dex_future_awaitAll);
+
+    interp.registerFunction("Cursor.next", dex_cursor_next);
+    interp.registerFunction("Cursor.fetchMany", dex_cursor_fetchMany);
+    interp.registerFunction("Cursor.close", dex_cursor_close);
+
+    interp.registerFunction("Result.rowCount", dex_result_rowCount);
+    interp.registerFunction("Result.columns", dex_result_columns);
+    interp.registerFunction("Result.types", dex_result_types);
+    interp.registerFunction("Result.rows", dex_result_rows);
+    interp.registerFunction("Result.row", dex_result_row);
+    interp.registerFunction("Result.get", dex_result_get);
+    interp.registerFunction("Result.column", dex_result_column);
+    interp.registerFunction("Result.toTable", dex_result_toTable);
 }
 
 } // namespace dex
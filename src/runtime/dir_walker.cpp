@@ -0,0 +1,316 @@
+// src/runtime/dir_walker.cpp
+#include "dir_walker.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace dex {
+
+namespace {
+
+constexpr size_t kMaxQueuedPaths = 1 << 16;
+
+#ifdef __linux__
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+#endif
+
+std::string joinPath(const std::string& dir, const char* name) {
+    if (dir.empty()) return name;
+    std::string out;
+    out.reserve(dir.size() + 1 + std::strlen(name));
+    out += dir;
+    if (out.back() != '/') out += '/';
+    out += name;
+    return out;
+}
+
+bool hasWildcard(std::string_view segment) {
+    return segment.find_first_of("*?[\\") != std::string_view::npos;
+}
+
+// Matches a "[...]" class at p (just past '['). Returns the position after
+// the closing ']' or nullptr if the class is unterminated.
+const char* matchClass(const char* p, const char* pe, char c, bool& matched) {
+    bool negate = p < pe && (*p == '!' || *p == '^');
+    if (negate) ++p;
+    bool hit = false;
+    bool first = true;
+    while (p < pe && (*p != ']' || first)) {
+        first = false;
+        char lo = *p++;
+        if (lo == '\\' && p < pe) lo = *p++;
+        char hi = lo;
+        if (p + 1 < pe && *p == '-' && p[1] != ']') {
+            hi = p[1];
+            p += 2;
+            if (hi == '\\' && p < pe) hi = *p++;
+        }
+        if (c >= lo && c <= hi) hit = true;
+    }
+    if (p >= pe) return nullptr;
+    matched = hit != negate;
+    return p + 1;
+}
+
+bool matchFrom(const char* p, const char* pe, const char* s, const char* se) {
+    while (p < pe) {
+        if (*p == '*') {
+            if (p + 1 < pe && p[1] == '*') {
+                p += 2;
+                if (p < pe && *p == '/') {
+                    // "**/" matches zero or more whole directories
+                    ++p;
+                    if (matchFrom(p, pe, s, se)) return true;
+                    for (const char* t = s; t < se; ++t) {
+                        if (*t == '/' && matchFrom(p, pe, t + 1, se)) return true;
+                    }
+                    return false;
+                }
+                for (const char* t = s; t <= se; ++t) {
+                    if (matchFrom(p, pe, t, se)) return true;
+                }
+                return false;
+            }
+            ++p;
+            for (const char* t = s;; ++t) {
+                if (matchFrom(p, pe, t, se)) return true;
+                if (t == se || *t == '/') return false;
+            }
+        }
+        if (s == se) return false;
+        if (*p == '?') {
+            if (*s == '/') return false;
+            ++p;
+            ++s;
+            continue;
+        }
+        if (*p == '[' && *s != '/') {
+            bool matched = false;
+            const char* after = matchClass(p + 1, pe, *s, matched);
+            if (after) {
+                if (!matched) return false;
+                p = after;
+                ++s;
+                continue;
+            }
+            // unterminated class: '[' is literal
+        }
+        if (*p == '\\' && p + 1 < pe) ++p;
+        if (*p != *s) return false;
+        ++p;
+        ++s;
+    }
+    return s == se;
+}
+
+} // namespace
+
+bool globMatch(std::string_view pattern, std::string_view path) {
+    return matchFrom(pattern.data(), pattern.data() + pattern.size(), path.data(), path.data() + path.size());
+}
+
+std::pair<std::string, std::string> splitGlob(const std::string& pattern) {
+    size_t baseEnd = 0; // end of the wildcard-free directory prefix
+    size_t start = 0;
+    while (true) {
+        size_t slash = pattern.find('/', start);
+        if (slash == std::string::npos) break;
+        if (hasWildcard(std::string_view(pattern).substr(start, slash - start))) break;
+        baseEnd = slash;
+        start = slash + 1;
+    }
+    if (start == 0) return {"", pattern};
+    std::string base = pattern.substr(0, baseEnd);
+    if (base.empty()) base = "/"; // pattern like "/*.log"
+    return {base, pattern.substr(start)};
+}
+
+DirWalker::DirWalker(std::string rootPath, WalkOptions opts)
+    : root(std::move(rootPath)), options(std::move(opts)) {
+    struct stat st;
+    if (::stat(root.empty() ? "." : root.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        throw std::runtime_error("Not a directory: " + root);
+    }
+    if (options.followSymlinks) visited.insert({st.st_dev, st.st_ino});
+
+    size_t threads = options.threads;
+    if (threads == 0) threads = std::min(8u, std::max(2u, std::thread::hardware_concurrency()));
+
+    dirs.push_back({root, 0});
+    activeDirs = 1;
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back([this]() { run(); });
+    }
+}
+
+DirWalker::~DirWalker() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    outputSpace.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+std::string DirWalker::firstError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+bool DirWalker::nextPath(std::string& out) {
+    std::unique_lock<std::mutex> lock(mutex);
+    outputReady.wait(lock, [this]() { return !output.empty() || activeDirs == 0 || stopping; });
+    if (output.empty()) return false;
+    out = std::move(output.front());
+    output.pop_front();
+    if (output.size() == kMaxQueuedPaths - 1) outputSpace.notify_all();
+    return true;
+}
+
+bool DirWalker::next(Value& out) {
+    std::string path;
+    if (!nextPath(path)) return false;
+    out = Value(std::move(path));
+    return true;
+}
+
+void DirWalker::run() {
+    std::vector<std::string> found;
+    std::vector<PendingDir> subdirs;
+    for (;;) {
+        PendingDir dir;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [this]() { return stopping || !dirs.empty() || activeDirs == 0; });
+            if (stopping || dirs.empty()) return;
+            dir = std::move(dirs.back()); // LIFO keeps the frontier small on deep trees
+            dirs.pop_back();
+        }
+
+        found.clear();
+        subdirs.clear();
+        scan(dir, found, subdirs);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        for (auto& d : subdirs) dirs.push_back(std::move(d));
+        activeDirs += subdirs.size();
+        if (!subdirs.empty()) workReady.notify_all();
+        lock.unlock();
+
+        bool keepGoing = emit(found);
+
+        lock.lock();
+        if (--activeDirs == 0) {
+            workReady.notify_all();
+            outputReady.notify_all();
+        }
+        if (!keepGoing) return;
+    }
+}
+
+bool DirWalker::emit(std::vector<std::string>& found) {
+    if (found.empty()) return true;
+    std::unique_lock<std::mutex> lock(mutex);
+    outputSpace.wait(lock, [this]() { return stopping || output.size() < kMaxQueuedPaths; });
+    if (stopping) return false;
+    for (auto& p : found) output.push_back(std::move(p));
+    outputReady.notify_one();
+    return true;
+}
+
+bool DirWalker::markVisited(const std::string& path) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) return false;
+    std::lock_guard<std::mutex> lock(mutex);
+    return visited.insert({st.st_dev, st.st_ino}).second;
+}
+
+void DirWalker::scan(const PendingDir& dir, std::vector<std::string>& found, std::vector<PendingDir>& subdirs) {
+    const std::string& dirPath = dir.path;
+    int fd = ::open(dirPath.empty() ? "." : dirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty()) error = "Cannot open directory: " + dirPath + " (" + std::strerror(errno) + ")";
+        return;
+    }
+
+    const size_t relStart = root.empty() ? 0 : root.size() + (root.back() == '/' ? 0 : 1);
+    const bool descend = options.maxDepth < 0 || dir.depth < options.maxDepth;
+
+    auto handle = [&](const char* name, unsigned char type) {
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) return;
+
+        if (type == DT_UNKNOWN) {
+            // Some filesystems (XFS without ftype, some FUSE) leave d_type unset.
+            struct stat st;
+            if (::fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) return;
+            type = S_ISDIR(st.st_mode) ? DT_DIR : S_ISLNK(st.st_mode) ? DT_LNK : DT_REG;
+        }
+        std::string path = joinPath(dirPath, name);
+        bool isDir = type == DT_DIR;
+        if (type == DT_LNK && options.followSymlinks) {
+            struct stat st;
+            isDir = ::fstatat(fd, name, &st, 0) == 0 && S_ISDIR(st.st_mode);
+        }
+
+        bool matches = options.pattern.empty()
+            || globMatch(options.pattern, std::string_view(path).substr(std::min(relStart, path.size())));
+        if (isDir) {
+            if (descend && (!options.followSymlinks || markVisited(path))) {
+                subdirs.push_back({path, dir.depth + 1});
+            }
+            if (options.includeDirs && matches) found.push_back(std::move(path));
+        } else if (matches) {
+            found.push_back(std::move(path));
+        }
+    };
+
+#ifdef __linux__
+    alignas(8) char buf[32 * 1024];
+    for (;;) {
+        long n = ::syscall(SYS_getdents64, fd, buf, sizeof(buf));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error.empty()) error = "Error reading directory: " + dirPath + " (" + std::strerror(errno) + ")";
+            break;
+        }
+        if (n == 0) break;
+        for (long off = 0; off < n;) {
+            auto* d = reinterpret_cast<LinuxDirent64*>(buf + off);
+            off += d->d_reclen;
+            handle(d->d_name, d->d_type);
+        }
+    }
+    ::close(fd);
+#else
+    DIR* d = ::fdopendir(fd);
+    if (!d) {
+        ::close(fd);
+        return;
+    }
+    while (struct dirent* e = ::readdir(d)) {
+        handle(e->d_name, e->d_type);
+    }
+    ::closedir(d);
+#endif
+}
+
+} // namespace dex
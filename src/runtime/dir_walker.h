@@ -0,0 +1,86 @@
+// src/runtime/dir_walker.h
+#ifndef DEX_DIR_WALKER_H
+#define DEX_DIR_WALKER_H
+
+#include "../interpreter/interpreter.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/types.h>
+
+namespace dex {
+
+struct WalkOptions {
+    bool includeDirs = false;    // also yield directory paths
+    bool followSymlinks = false; // descend into symlinked directories (cycle-safe)
+    int maxDepth = -1;           // -1 = unlimited; 0 = entries of the root only
+    size_t threads = 0;          // 0 = pick from hardware concurrency
+    std::string pattern;         // glob filter on the path relative to the root
+};
+
+// Parallel recursive directory scan. Worker threads pull directories off a
+// shared stack, list them with getdents64 (readdir elsewhere) and push the
+// paths they find into a bounded queue that next() drains, so traversal runs
+// ahead of the consumer without materializing the whole tree.
+// Paths come out in no particular order. Destroying the walker stops it.
+class DirWalker : public NativeIterator {
+public:
+    DirWalker(std::string root, WalkOptions options);
+    ~DirWalker() override;
+
+    DirWalker(const DirWalker&) = delete;
+    DirWalker& operator=(const DirWalker&) = delete;
+
+    bool next(Value& out) override;
+    bool nextPath(std::string& out);
+    std::string typeName() const override { return "DirWalker"; }
+
+    // First error seen (unreadable directory etc.); the walk skips past it.
+    std::string firstError() const;
+
+private:
+    struct PendingDir {
+        std::string path;
+        int depth;
+    };
+
+    std::string root;
+    WalkOptions options;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable outputReady;
+    std::condition_variable outputSpace;
+    std::vector<PendingDir> dirs;
+    std::deque<std::string> output;
+    size_t activeDirs = 0; // queued + being scanned
+    bool stopping = false;
+    std::set<std::pair<dev_t, ino_t>> visited; // only with followSymlinks
+    std::string error;
+
+    void run();
+    void scan(const PendingDir& dir, std::vector<std::string>& found, std::vector<PendingDir>& subdirs);
+    bool emit(std::vector<std::string>& found);
+    bool markVisited(const std::string& path);
+};
+
+// Splits a glob into the directory to start from (the longest wildcard-free
+// leading segments) and the remaining pattern. "src/**/*.cpp" -> {"src", "**/*.cpp"}.
+std::pair<std::string, std::string> splitGlob(const std::string& pattern);
+
+// Shell-style matching: '*' and '?' stay within a path segment, "**" spans
+// segments ("**/" also matches zero directories), "[a-z]" / "[!a-z]" classes,
+// backslash escapes the next character.
+bool globMatch(std::string_view pattern, std::string_view path);
+
+} // namespace dex
+
+#endif // DEX_DIR_WALKER_H
@@ -0,0 +1,300 @@
+// src/runtime/file_cache.cpp
+#include "file_cache.h"
+#include "fileio.h"
+#include <algorithm>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace dex {
+
+namespace {
+
+#ifdef __linux__
+constexpr uint32_t kWatchMask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_MOVE_SELF | IN_DELETE_SELF;
+#endif
+
+// Rough per-entry bookkeeping (list node, hash slot, key) so that many tiny
+// files still count against the budget.
+constexpr size_t kEntryOverhead = 128;
+
+} // namespace
+
+FileCache& FileCache::instance() {
+    static FileCache cache;
+    return cache;
+}
+
+FileCache::~FileCache() {
+    if (inotifyFd >= 0) ::close(inotifyFd);
+}
+
+void FileCache::enable(size_t bytes, bool watch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    watchedPaths.clear();
+    if (inotifyFd >= 0) {
+        ::close(inotifyFd);
+        inotifyFd = -1;
+    }
+#ifdef __linux__
+    if (watch) inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#else
+    (void)watch;
+#endif
+    ++generation;
+    maxBytes = bytes;
+    entries.setCapacity(bytes);
+    entries.onEvict([this](const std::string& path, Entry& e) {
+        if (e.wd >= 0) dropWatch(path, e.wd);
+    });
+    counters = FileCacheStats();
+    on = true;
+}
+
+void FileCache::disable() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    watchedPaths.clear();
+    if (inotifyFd >= 0) {
+        ::close(inotifyFd);
+        inotifyFd = -1;
+    }
+    ++generation;
+    on = false;
+}
+
+bool FileCache::enabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return on;
+}
+
+std::shared_ptr<const std::string> FileCache::read(const std::string& path) {
+    Entry e = load(path);
+    if (!e.bytes) return std::make_shared<const std::string>(readFile(path));
+    return e.bytes;
+}
+
+// `parse` runs without the lock held, so a slow parse doesn't stall other
+// cached reads. The bytes are cached first; the parsed value is only added
+// if that same entry is still there afterwards.
+std::shared_ptr<const Value> FileCache::readParsed(const std::string& path,
+                                                   const std::function<Value(const std::string&)>& parse) {
+    Entry updated = load(path);
+    if (!updated.bytes) return std::make_shared<const Value>(parse(readFile(path)));
+    if (updated.parsed) return updated.parsed;
+
+    updated.parsed = std::make_shared<const Value>(parse(*updated.bytes));
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!on) return updated.parsed;
+    drainEvents();
+    Entry* current = entries.peek(path);
+    // Invalidated, evicted or re-read meanwhile: hand out this parse uncached
+    if (!current || current->bytes != updated.bytes || !(current->id == updated.id)) return updated.parsed;
+    if (current->parsed) return current->parsed; // another thread parsed it first
+    auto parsed = updated.parsed;
+    store(path, std::move(updated));
+    return parsed;
+}
+
+void FileCache::invalidate(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!on) return;
+    auto pending = fetches.find(path);
+    if (pending != fetches.end()) pending->second->stale = true;
+    if (entries.peek(path)) {
+        ++counters.invalidations;
+        removeEntry(path);
+    }
+}
+
+FileCacheStats FileCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    FileCacheStats s = counters;
+    s.evictions = entries.evictions();
+    s.entries = entries.size();
+    s.bytes = entries.cost();
+    s.maxBytes = maxBytes;
+    s.watching = inotifyFd >= 0;
+    return s;
+}
+
+// Valid entry for `path`, or a copy with null bytes if the cache is off.
+// A hit validated by stat() makes that call with the lock released.
+FileCache::Entry FileCache::load(const std::string& path) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!on) return Entry();
+    drainEvents();
+    if (Entry* e = entries.get(path)) {
+        Entry cached = *e;
+        if (cached.wd >= 0) { // inotify would have invalidated it
+            ++counters.hits;
+            return cached;
+        }
+        lock.unlock();
+        Identity now;
+        bool unchanged = statIdentity(path, now) && now == cached.id;
+        lock.lock();
+        if (unchanged) {
+            ++counters.hits;
+            return cached;
+        }
+        Entry* current = entries.peek(path);
+        if (current && current->bytes == cached.bytes) { // not already replaced
+            ++counters.invalidations;
+            removeEntry(path);
+        }
+        if (!on) return Entry();
+    }
+    ++counters.misses;
+    return fetch(path, lock);
+}
+
+// Reads `path` with `lock` released, unless another thread already is: then
+// waits for its result instead. Caches what it read if nothing invalidated
+// the path meanwhile. Returns with `lock` held, or throws without it.
+FileCache::Entry FileCache::fetch(const std::string& path, std::unique_lock<std::mutex>& lock) {
+    auto pending = fetches.find(path);
+    if (pending != fetches.end()) {
+        std::shared_future<Entry> result = pending->second->result;
+        lock.unlock();
+        Entry e = result.get(); // rethrows the reader's error
+        lock.lock();
+        return e;
+    }
+
+    auto mine = std::make_shared<Fetch>();
+    fetches.emplace(path, mine);
+    const uint64_t gen = generation;
+    Entry e;
+    // Watch before reading so a change during the read is not missed.
+    e.wd = addWatch(path);
+    auto finished = [&]() {
+        auto it = fetches.find(path);
+        if (it != fetches.end() && it->second == mine) fetches.erase(it);
+    };
+    lock.unlock();
+    try {
+        if (!statIdentity(path, e.id)) throw std::runtime_error("Cannot open file: " + path);
+        e.bytes = std::make_shared<const std::string>(readFile(path));
+    } catch (...) {
+        lock.lock();
+        finished();
+        if (e.wd >= 0 && gen == generation) dropWatch(path, e.wd);
+        lock.unlock();
+        mine->promise.set_exception(std::current_exception());
+        throw;
+    }
+    lock.lock();
+    finished();
+    mine->promise.set_value(e);
+    if (gen != generation) return e; // enabled or disabled again: its watch is gone
+    drainEvents();
+    bool watched = false;
+    if (e.wd >= 0) {
+        auto it = watchedPaths.find(e.wd);
+        watched = it != watchedPaths.end() && std::find(it->second.begin(), it->second.end(), path) != it->second.end();
+    }
+    if (mine->stale || (e.wd >= 0 && !watched)) {
+        // Written or changed while we read it: don't cache what may be a mix
+        if (watched) dropWatch(path, e.wd);
+        return e;
+    }
+    store(path, e);
+    return e;
+}
+
+void FileCache::store(const std::string& path, Entry e) {
+    if (Entry* old = entries.peek(path)) {
+        if (old->wd >= 0 && old->wd != e.wd) dropWatch(path, old->wd);
+        entries.erase(path);
+    }
+    int wd = e.wd;
+    size_t cost = costOf(e);
+    if (cost > maxBytes / 4 || !entries.put(path, std::move(e), cost)) {
+        if (wd >= 0) dropWatch(path, wd);
+    }
+}
+
+void FileCache::drainEvents() {
+#ifdef __linux__
+    if (inotifyFd < 0 || watchedPaths.empty()) return;
+    alignas(inotify_event) char buf[4096];
+    for (;;) {
+        ssize_t n = ::read(inotifyFd, buf, sizeof(buf));
+        if (n <= 0) return; // EAGAIN: queue drained
+        for (ssize_t off = 0; off < n;) {
+            auto* ev = reinterpret_cast<const inotify_event*>(buf + off);
+            off += sizeof(inotify_event) + ev->len;
+            auto it = watchedPaths.find(ev->wd);
+            if (it == watchedPaths.end()) continue;
+            std::vector<std::string> paths = std::move(it->second);
+            watchedPaths.erase(it);
+            if (!(ev->mask & IN_IGNORED)) ::inotify_rm_watch(inotifyFd, ev->wd);
+            for (const auto& p : paths) {
+                if (entries.erase(p)) ++counters.invalidations;
+            }
+        }
+    }
+#endif
+}
+
+int FileCache::addWatch(const std::string& path) {
+#ifdef __linux__
+    if (inotifyFd < 0) return -1;
+    int wd = ::inotify_add_watch(inotifyFd, path.c_str(), kWatchMask);
+    if (wd < 0) return -1; // e.g. watch limit reached: fall back to stat checks
+    auto& paths = watchedPaths[wd];
+    if (std::find(paths.begin(), paths.end(), path) == paths.end()) paths.push_back(path);
+    return wd;
+#else
+    (void)path;
+    return -1;
+#endif
+}
+
+void FileCache::dropWatch(const std::string& path, int wd) {
+#ifdef __linux__
+    auto it = watchedPaths.find(wd);
+    if (it == watchedPaths.end()) return;
+    auto& paths = it->second;
+    paths.erase(std::remove(paths.begin(), paths.end(), path), paths.end());
+    if (paths.empty()) {
+        ::inotify_rm_watch(inotifyFd, wd);
+        watchedPaths.erase(it);
+    }
+#else
+    (void)path;
+    (void)wd;
+#endif
+}
+
+void FileCache::removeEntry(const std::string& path) {
+    Entry* e = entries.peek(path);
+    if (!e) return;
+    if (e->wd >= 0) dropWatch(path, e->wd);
+    entries.erase(path);
+}
+
+bool FileCache::statIdentity(const std::string& path, Identity& id) {
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) return false;
+    id.dev = st.st_dev;
+    id.ino = st.st_ino;
+    id.mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    id.size = static_cast<int64_t>(st.st_size);
+    return true;
+}
+
+size_t FileCache::costOf(const Entry& e) {
+    size_t n = kEntryOverhead + (e.bytes ? e.bytes->size() : 0);
+    // Parsed values are several times larger than their text; count them at 2x.
+    if (e.parsed) n += 2 * (e.bytes ? e.bytes->size() : 0);
+    return n;
+}
+
+} // namespace dex
@@ -0,0 +1,109 @@
+// src/runtime/file_cache.h
+#ifndef DEX_FILE_CACHE_H
+#define DEX_FILE_CACHE_H
+
+#include "../interpreter/interpreter.h"
+#include "lru_cache.h"
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sys/types.h>
+
+namespace dex {
+
+struct FileCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t invalidations = 0; // entries dropped because the file changed
+    uint64_t evictions = 0;     // entries dropped to stay under maxBytes
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t maxBytes = 0;
+    bool watching = false;
+};
+
+// Opt-in, size-bounded cache of file contents (and their parsed form) for
+// FileIO.readFile / FileIO.readJSON. Entries are keyed by path and remember
+// the device, inode, mtime and size they were read at. By default every hit
+// is validated with stat(); with `watch` enabled an inotify watch per entry
+// invalidates it instead and hits skip the syscall entirely.
+// Files larger than a quarter of maxBytes are read through uncached.
+// stat() and reads run without the cache's lock held; concurrent misses on
+// one path share a single read. Writes through FileIO call invalidate().
+class FileCache {
+public:
+    static FileCache& instance();
+
+    void enable(size_t maxBytes, bool watch);
+    void disable();
+    bool enabled() const;
+
+    // Contents of `path`, from the cache when still valid.
+    std::shared_ptr<const std::string> read(const std::string& path);
+    // Parsed form of `path`; `parse` runs on a miss or after invalidation,
+    // without the cache's lock held (concurrent misses may each parse).
+    std::shared_ptr<const Value> readParsed(const std::string& path,
+                                            const std::function<Value(const std::string&)>& parse);
+
+    // Drops the entry for `path`, and keeps a read of it already under way
+    // from being cached.
+    void invalidate(const std::string& path);
+    FileCacheStats stats() const;
+
+private:
+    struct Identity {
+        dev_t dev = 0;
+        ino_t ino = 0;
+        int64_t mtimeNs = 0;
+        int64_t size = -1;
+        bool operator==(const Identity& o) const {
+            return dev == o.dev && ino == o.ino && mtimeNs == o.mtimeNs && size == o.size;
+        }
+    };
+
+    struct Entry {
+        Identity id;
+        std::shared_ptr<const std::string> bytes;
+        std::shared_ptr<const Value> parsed;
+        int wd = -1; // inotify watch, -1 = validate by stat
+    };
+
+    // A read of one path under way; other readers of the path wait for it.
+    struct Fetch {
+        std::promise<Entry> promise;
+        std::shared_future<Entry> result = promise.get_future().share();
+        bool stale = false; // invalidated meanwhile: don't cache what it read
+    };
+
+    FileCache() = default;
+    ~FileCache();
+
+    mutable std::mutex mutex;
+    bool on = false;
+    size_t maxBytes = 0;
+    LruCache<std::string, Entry> entries;
+    std::unordered_map<std::string, std::shared_ptr<Fetch>> fetches;
+    uint64_t generation = 0; // bumped by enable/disable, which drop every watch
+    int inotifyFd = -1;
+    std::unordered_map<int, std::vector<std::string>> watchedPaths;
+    mutable FileCacheStats counters;
+
+    Entry load(const std::string& path);
+    Entry fetch(const std::string& path, std::unique_lock<std::mutex>& lock);
+    void store(const std::string& path, Entry e);
+    void drainEvents();
+    int addWatch(const std::string& path);
+    void dropWatch(const std::string& path, int wd);
+    void removeEntry(const std::string& path);
+    static bool statIdentity(const std::string& path, Identity& id);
+    static size_t costOf(const Entry& e);
+};
+
+} // namespace dex
+
+#endif // DEX_FILE_CACHE_H
@@ -0,0 +1,207 @@
+// src/runtime/file_handle.cpp
+#include "file_handle.h"
+#include "file_cache.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace dex {
+
+FileHandle::FileHandle(const std::string& p, const std::string& mode, size_t size)
+    : path(p), bufferSize(size ? size : defaultBufferSize) {
+    bool plus = mode.find('+') != std::string::npos;
+    int flags = O_CLOEXEC;
+    switch (mode.empty() ? '\0' : mode[0]) {
+    case 'r':
+        flags |= plus ? O_RDWR : O_RDONLY;
+        readable = true;
+        writable = plus;
+        break;
+    case 'w':
+        flags |= (plus ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC;
+        readable = plus;
+        writable = true;
+        break;
+    case 'a':
+        flags |= (plus ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND;
+        readable = plus;
+        writable = true;
+        break;
+    default:
+        throw std::runtime_error("Invalid file mode '" + mode + "' (expected r, w, a, r+, w+ or a+)");
+    }
+
+    fd = ::open(path.c_str(), flags, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + path + " (" + std::strerror(errno) + ")");
+    }
+    if (readable) rbuf.resize(bufferSize);
+    if (writable) wbuf.reserve(bufferSize);
+    if (flags & O_TRUNC) FileCache::instance().invalidate(path);
+}
+
+FileHandle::~FileHandle() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // Destructors must not throw; call close() explicitly to see write errors.
+    }
+}
+
+void FileHandle::requireOpen(const char* op) const {
+    if (fd < 0) throw std::runtime_error(std::string(op) + ": file handle is closed: " + path);
+}
+
+void FileHandle::writeAll(const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Error writing file: " + path + " (" + std::strerror(errno) + ")");
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    FileCache::instance().invalidate(path);
+}
+
+void FileHandle::flush() {
+    requireOpen("flush");
+    if (wbuf.empty()) return;
+    writeAll(wbuf.data(), wbuf.size());
+    wbuf.clear();
+}
+
+// Gives unread bytes back to the kernel file offset before writing or seeking.
+void FileHandle::discardReadBuffer() {
+    if (rpos < rend) {
+        ::lseek(fd, -static_cast<off_t>(rend - rpos), SEEK_CUR);
+    }
+    rpos = rend = 0;
+    eof = false;
+}
+
+bool FileHandle::fillReadBuffer() {
+    if (eof) return false;
+    if (!wbuf.empty()) flush();
+    ssize_t n;
+    do {
+        n = ::read(fd, rbuf.data(), rbuf.size());
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        throw std::runtime_error("Error reading file: " + path + " (" + std::strerror(errno) + ")");
+    }
+    rpos = 0;
+    rend = static_cast<size_t>(n);
+    if (n == 0) eof = true;
+    return n > 0;
+}
+
+bool FileHandle::readLine(std::string& line) {
+    requireOpen("readLine");
+    if (!readable) throw std::runtime_error("readLine: file not opened for reading: " + path);
+    line.clear();
+    bool any = false;
+    for (;;) {
+        if (rpos == rend && !fillReadBuffer()) break;
+        any = true;
+        const char* start = rbuf.data() + rpos;
+        const char* nl = static_cast<const char*>(std::memchr(start, '\n', rend - rpos));
+        if (nl) {
+            line.append(start, nl - start);
+            rpos += static_cast<size_t>(nl - start) + 1;
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            return true;
+        }
+        line.append(start, rend - rpos);
+        rpos = rend;
+    }
+    return any;
+}
+
+std::string FileHandle::readChunk(size_t n) {
+    requireOpen("readChunk");
+    if (!readable) throw std::runtime_error("readChunk: file not opened for reading: " + path);
+    std::string out;
+    out.reserve(n < bufferSize ? n : bufferSize);
+    while (out.size() < n) {
+        if (rpos == rend && !fillReadBuffer()) break;
+        size_t take = std::min(n - out.size(), rend - rpos);
+        out.append(rbuf.data() + rpos, take);
+        rpos += take;
+    }
+    return out;
+}
+
+void FileHandle::write(std::string_view data) {
+    requireOpen("write");
+    if (!writable) throw std::runtime_error("write: file not opened for writing: " + path);
+    if (rpos < rend || eof) discardReadBuffer();
+    if (wbuf.size() + data.size() > bufferSize) {
+        flush();
+        // Large writes skip the buffer entirely.
+        if (data.size() >= bufferSize) {
+            writeAll(data.data(), data.size());
+            return;
+        }
+    }
+    wbuf.append(data.data(), data.size());
+}
+
+int64_t FileHandle::seek(int64_t offset, const std::string& whence) {
+    requireOpen("seek");
+    int w;
+    if (whence == "set") {
+        w = SEEK_SET;
+    } else if (whence == "cur") {
+        w = SEEK_CUR;
+        offset -= static_cast<int64_t>(rend - rpos); // the kernel offset is past our read buffer
+    } else if (whence == "end") {
+        w = SEEK_END;
+    } else {
+        throw std::runtime_error("seek: whence must be set, cur or end");
+    }
+    if (!wbuf.empty()) flush();
+    rpos = rend = 0;
+    eof = false;
+    off_t pos = ::lseek(fd, static_cast<off_t>(offset), w);
+    if (pos < 0) {
+        throw std::runtime_error("seek failed on " + path + " (" + std::strerror(errno) + ")");
+    }
+    return static_cast<int64_t>(pos);
+}
+
+int64_t FileHandle::tell() {
+    requireOpen("tell");
+    off_t pos = ::lseek(fd, 0, SEEK_CUR);
+    if (pos < 0) return -1;
+    return static_cast<int64_t>(pos) - static_cast<int64_t>(rend - rpos) + static_cast<int64_t>(wbuf.size());
+}
+
+void FileHandle::close() {
+    if (fd < 0) return;
+    int handle = fd;
+    try {
+        flush();
+    } catch (...) {
+        ::close(handle);
+        fd = -1;
+        throw;
+    }
+    fd = -1;
+    if (::close(handle) != 0) {
+        throw std::runtime_error("Error closing file: " + path);
+    }
+}
+
+bool FileHandle::next(Value& out) {
+    std::string line;
+    if (!readLine(line)) return false;
+    out = Value(std::move(line));
+    return true;
+}
+
+} // namespace dex
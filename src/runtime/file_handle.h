@@ -0,0 +1,68 @@
+// src/runtime/file_handle.h
+#ifndef DEX_FILE_HANDLE_H
+#define DEX_FILE_HANDLE_H
+
+#include "../interpreter/interpreter.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace dex {
+
+// Buffered file handle for incremental I/O. Modes follow fopen: "r", "w",
+// "a" (O_APPEND, every write lands at the end), plus "+" for read/write.
+// Reads and writes go through separate user-space buffers; switching
+// direction or seeking flushes/discards them as needed.
+// Iterating a handle yields its lines.
+class FileHandle : public NativeIterator {
+public:
+    static constexpr size_t defaultBufferSize = 256 * 1024;
+
+    FileHandle(const std::string& path, const std::string& mode, size_t bufferSize = defaultBufferSize);
+    ~FileHandle() override;
+
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    // Reads up to the next '\n' (or "\r\n"), which is not included in `line`.
+    // Returns false at end of file.
+    bool readLine(std::string& line);
+    // Reads up to `n` bytes; returns fewer only at end of file.
+    std::string readChunk(size_t n);
+
+    void write(std::string_view data);
+    void flush();
+
+    // whence is "set", "cur" or "end". Returns the new absolute offset.
+    int64_t seek(int64_t offset, const std::string& whence);
+    int64_t tell();
+
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    bool next(Value& out) override;
+    std::string typeName() const override { return "FileHandle"; }
+
+private:
+    std::string path;
+    int fd = -1;
+    bool readable = false;
+    bool writable = false;
+    size_t bufferSize;
+
+    std::vector<char> rbuf;
+    size_t rpos = 0;
+    size_t rend = 0;
+    bool eof = false;
+    std::string wbuf;
+
+    void requireOpen(const char* op) const;
+    bool fillReadBuffer();
+    void discardReadBuffer();
+    void writeAll(const char* data, size_t size);
+};
+
+} // namespace dex
+
+#endif // DEX_FILE_HANDLE_H
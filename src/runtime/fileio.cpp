@@ -1,22 +1,56 @@
-#include "fileio.h"
-#include <fstream>
-#include <sstream>
-#include <stdexcept>
-
-namespace dex {
-
-std::string readFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file) throw std::runtime_error("Cannot open file: " + filename);
-    std::stringstream ss;
-    ss << file.rdbuf();
-    return ss.str();
-}
-
-void writeFile(const std::string& filename, const std::string& data) {
-    std::ofstream file(filename);
-    if (!file) throw std::runtime_error("Cannot open file for writing: " + filename);
-    file << data;
-}
-
-}
+#include "fileio.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace dex {
+
+// Reads straight into a string sized from fstat, so the contents are held
+// once; files without a usable size (pipes, /proc) grow the string as they go.
+std::string readFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) throw std::runtime_error("Cannot open file: " + filename);
+
+    std::string data;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        data.resize(static_cast<size_t>(st.st_size));
+    }
+
+    size_t used = 0;
+    for (;;) {
+        // Once the buffer is full (normally at st_size), probe for EOF with a
+        // small read instead of doubling the buffer; only grow if the file
+        // turns out to be longer (it grew, or st_size was unknown).
+        char probe[4096];
+        const bool full = used == data.size();
+        ssize_t n = full ? ::read(fd, probe, sizeof probe) : ::read(fd, &data[used], data.size() - used);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            throw std::runtime_error("Error reading file: " + filename);
+        }
+        if (n == 0) break;
+        if (full) {
+            data.resize(std::max(data.size() * 2, used + 64 * 1024));
+            std::memcpy(&data[used], probe, static_cast<size_t>(n));
+        }
+        used += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    data.resize(used);
+    return data;
+}
+
+void writeFile(const std::string& filename, const std::string& data) {
+    std::ofstream file(filename);
+    if (!file) throw std::runtime_error("Cannot open file for writing: " + filename);
+    file << data;
+}
+
+}
@@ -1,93 +1,713 @@
-#include "fileio.h"      // Assumed to provide readFile, writeFile
-#include "../../external/nlohmann/json_utils.h"  // Assumed to provide parseJSON, toJSON (for nlohmann::json)
-#include "csv_utils.h"   // Assumed to provide parseCSV, toCSV (for vector<vector<string>>)
-#include "../interpreter/interpreter.h" // Your updated interpreter.h
-#include <stdexcept>     // For std::runtime_error
-#include <iostream>      // For std::cerr (for error messages)
-
-// Assuming nlohmann/json.hpp is included by json_utils.h or directly in your build system.
-// If not, you might need to add: #include "nlohmann/json.hpp" here.
-
-namespace dex {
-
-Value dex_readFile(Interpreter& interp, const std::vector<Value>& args) {
-    (void)interp; // Suppress unused parameter warning
-
-    if (args.size() != 1 || !args[0].isString()) {
-        std::cerr << "Runtime Error: readFile expects 1 string argument." << std::endl;
-        throw std::runtime_error("readFile expects 1 string argument");
-    }
-    // Assuming readFile is a global or utility function that returns std::string
-    return Value(readFile(args[0].asString()));
-}
-
-Value dex_writeFile(Interpreter& interp, const std::vector<Value>& args) {
-    (void)interp; // Suppress unused parameter warning
-
-    if (args.size() != 2 || !args[0].isString() || !args[1].isString()) {
-        std::cerr << "Runtime Error: writeFile expects 2 string arguments." << std::endl;
-        throw std::runtime_error("writeFile expects 2 string arguments");
-    }
-    // Assuming writeFile is a global or utility function
-    writeFile(args[0].asString(), args[1].asString());
-    return Value::nil();
-}
-
-Value dex_parseJSON(Interpreter& interp, const std::vector<Value>& args) {
-    if (args.size() != 1 || !args[0].isString()) {
-        std::cerr << "Runtime Error: parseJSON expects 1 string argument." << std::endl;
-        throw std::runtime_error("parseJSON expects 1 string argument");
-    }
-
-    // Assuming parseJSON is a global or utility function that returns nlohmann::json
-    auto j = parseJSON(args[0].asString());
-    // Convert nlohmann::json to Dex Value using the Interpreter's method
-    return interp.jsonToDexValue(j);
-}
-
-Value dex_toJSON(Interpreter& interp, const std::vector<Value>& args) {
-    if (args.size() != 1) {
-        std::cerr << "Runtime Error: toJSON expects 1 argument." << std::endl;
-        throw std::runtime_error("toJSON expects 1 argument");
-    }
-
-    // Convert Dex Value to nlohmann::json using the Interpreter's method
-    nlohmann::json j = interp.dexValueToJson(args[0]);
-    // Assuming toJSON is a global or utility function that takes nlohmann::json and returns std::string
-    return Value(toJSON(j));
-}
-
-Value dex_parseCSV(Interpreter& interp, const std::vector<Value>& args) {
-    if (args.size() != 1 || !args[0].isString()) {
-        std::cerr << "Runtime Error: parseCSV expects 1 string argument." << std::endl;
-        throw std::runtime_error("parseCSV expects 1 string argument");
-    }
-
-    // Assuming parseCSV is a global or utility function that returns std::vector<std::vector<std::string>>
-    auto rows = parseCSV(args[0].asString());
-    // Convert vector<vector<string>> to Dex array of arrays using the Interpreter's method
-    return interp.csvToDexValue(rows);
-}
-
-Value dex_toCSV(Interpreter& interp, const std::vector<Value>& args) {
-    if (args.size() != 1 || !args[0].isArray()) {
-        std::cerr << "Runtime Error: toCSV expects 1 array argument." << std::endl;
-        throw std::runtime_error("toCSV expects 1 array argument");
-    }
-
-    // Convert Dex array of arrays to vector<vector<string>> using the Interpreter's method
-    auto rows = interp.dexValueToCSV(args[0]);
-    // Assuming toCSV is a global or utility function that takes vector<vector<string>> and returns std::string
-    return Value(toCSV(rows));
-}
-
-void registerFileIOBindings(Interpreter& interp) {
-    interp.registerFunction("FileIO.readFile", dex_readFile);
-    interp.registerFunction("FileIO.writeFile", dex_writeFile);
-    interp.registerFunction("FileIO.parseJSON", dex_parseJSON);
-    interp.registerFunction("FileIO.toJSON", dex_toJSON);
-    interp.registerFunction("FileIO.parseCSV", dex_parseCSV);
-    interp.registerFunction("FileIO.toCSV", dex_toCSV);
-}
-
-} // namespace dex
+#include "fileio.h"      // Assumed to provide readFile, writeFile
+#include "../../external/nlohmann/json_utils.h"  // Assumed to provide parseJSON, toJSON (for nlohmann::json)
+#include "csv_utils.h"   // Assumed to provide parseCSV, toCSV (for vector<vector<string>>)
+#include "csv_reader.h"  // Streaming CSVReader cursor
+#include "table.h"       // Columnar Table built by loadTable
+#include "csv_writer.h"  // Buffered RFC 4180 writer for toCSV/writeCSV
+#include "byte_buffer.h" // mmap-backed ByteBuffer for zero-copy reads
+#include "file_handle.h" // Buffered FileHandle for incremental I/O
+#include "async_io.h"    // Batched io_uring / thread-pool file I/O
+#include "dir_walker.h"  // Parallel directory walk for walk/glob
+#include "thread_pool.h"
+#include "file_cache.h"   // Opt-in LRU cache behind readFile/readJSON
+#include "compression.h"  // gzip/zstd sources and sinks
+#include "value_codec.h"  // Binary Value files for openValues
+#include "binding_utils.h"
+#include "../interpreter/interpreter.h" // Your updated interpreter.h
+#include <stdexcept>     // For std::runtime_error
+#include <algorithm>
+#include <iostream>      // For std::cerr (for error messages)
+#include <mutex>
+#include <sys/stat.h>
+
+// Assuming nlohmann/json.hpp is included by json_utils.h or directly in your build system.
+// If not, you might need to add: #include "nlohmann/json.hpp" here.
+
+namespace dex {
+
+// Compression named by options.compression ("auto" by default), resolved
+// against the path's extension.
+static Compression compressionFor(const std::vector<Value>& args, size_t optionsIndex, const std::string& path) {
+    std::string name = args.size() > optionsIndex ? optionString(args[optionsIndex], "compression", "auto") : "auto";
+    return resolveCompression(parseCompression(name), path);
+}
+
+// Argument `v` of binding `name` as a byte count or offset.
+static size_t sizeArg(const Value& v, const char* name, const char* what) {
+    size_t n = 0;
+    if (!v.isString() || !parseInteger(v.asString(), n)) {
+        std::cerr << "Runtime Error: " << name << " expects " << what << " to be a non-negative integer." << std::endl;
+        throw std::runtime_error(std::string(name) + " expects " + what + " to be a non-negative integer");
+    }
+    return n;
+}
+
+// FileIO.readFile(path, options). With {mmap: "true"} the file is mapped
+// and returned as a read-only ByteBuffer instead of being copied into a string.
+// .gz/.zst files are decompressed unless {compression: "none"}.
+Value dex_readFile(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp; // Suppress unused parameter warning
+
+    if (args.empty() || args.size() > 2 || !args[0].isString()) {
+        std::cerr << "Runtime Error: readFile expects 1 string argument and optional options." << std::endl;
+        throw std::runtime_error("readFile expects 1 string argument and optional options");
+    }
+    const std::string& path = args[0].asString();
+    Compression compression = compressionFor(args, 1, path);
+    if (args.size() == 2 && optionBool(args[1], "mmap", false)) {
+        if (compression != Compression::None) {
+            throw std::runtime_error("readFile: mmap cannot be combined with compression");
+        }
+        return Value(ByteBuffer::mapFile(path));
+    }
+    if (FileCache::instance().enabled()) {
+        auto raw = FileCache::instance().read(path);
+        if (compression == Compression::None) return Value(*raw);
+        auto source = decompress(std::make_unique<MemorySource>(raw->data(), raw->size()), compression);
+        return Value(readAll(*source));
+    }
+    if (compression != Compression::None) {
+        return Value(readAll(*openSource(path, compression)));
+    }
+    // Assuming readFile is a global or utility function that returns std::string
+    return Value(readFile(path));
+}
+
+// FileIO.writeFile(path, data, options). .gz/.zst paths are compressed
+// unless {compression: "none"}; options.level sets the compression level.
+Value dex_writeFile(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp; // Suppress unused parameter warning
+
+    if (args.size() < 2 || args.size() > 3 || !args[0].isString() || !args[1].isString()) {
+        std::cerr << "Runtime Error: writeFile expects 2 string arguments and optional options." << std::endl;
+        throw std::runtime_error("writeFile expects 2 string arguments and optional options");
+    }
+    const std::string& path = args[0].asString();
+    Compression compression = compressionFor(args, 2, path);
+    if (compression != Compression::None) {
+        int level = args.size() == 3 ? static_cast<int>(optionInt(args[2], "level", -1)) : -1;
+        auto sink = openSink(path, compression, false, level);
+        sink->write(args[1].asString().data(), args[1].asString().size());
+        sink->finish();
+    } else {
+        // Assuming writeFile is a global or utility function
+        writeFile(path, args[1].asString());
+    }
+    // mtime granularity can hide a rewrite of the same size; don't rely on it for our own writes
+    FileCache::instance().invalidate(path);
+    return Value::nil();
+}
+
+Value dex_parseJSON(Interpreter& interp, const std::vector<Value>& args) {
+    if (args.size() != 1) {
+        std::cerr << "Runtime Error: parseJSON expects 1 string or ByteBuffer argument." << std::endl;
+        throw std::runtime_error("parseJSON expects 1 string or ByteBuffer argument");
+    }
+
+    // Parses in place from either a string or a mapped ByteBuffer
+    std::string_view text = bytesOf(args[0], "parseJSON");
+    auto j = parseJSON(text.data(), text.size());
+    // Convert nlohmann::json to Dex Value using the Interpreter's method
+    return interp.jsonToDexValue(j);
+}
+
+Value dex_toJSON(Interpreter& interp, const std::vector<Value>& args) {
+    if (args.size() != 1) {
+        std::cerr << "Runtime Error: toJSON expects 1 argument." << std::endl;
+        throw std::runtime_error("toJSON expects 1 argument");
+    }
+
+    // Convert Dex Value to nlohmann::json using the Interpreter's method
+    nlohmann::json j = interp.dexValueToJson(args[0]);
+    // Assuming toJSON is a global or utility function that takes nlohmann::json and returns std::string
+    return Value(toJSON(j));
+}
+
+Value dex_parseCSV(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() != 1) {
+        std::cerr << "Runtime Error: parseCSV expects 1 string or ByteBuffer argument." << std::endl;
+        throw std::runtime_error("parseCSV expects 1 string or ByteBuffer argument");
+    }
+
+    // Tokenize in place from a string or mapped ByteBuffer straight into Dex rows
+    std::string_view text = bytesOf(args[0], "parseCSV");
+    CSVReader reader(text.data(), text.size(), CSVOptions{});
+    std::vector<Value> rows;
+    Value row;
+    while (reader.next(row)) {
+        rows.push_back(std::move(row));
+    }
+    return Value(std::move(rows));
+}
+
+// FileIO.slice(bytes, start, length) -> a ByteBuffer slice sharing the
+// original storage, or a substring when given a string.
+Value dex_slice(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() < 2 || args.size() > 3 || !args[1].isString() || (args.size() == 3 && !args[2].isString())) {
+        std::cerr << "Runtime Error: slice expects bytes, a start offset and an optional length." << std::endl;
+        throw std::runtime_error("slice expects bytes, a start offset and an optional length");
+    }
+    size_t start = sizeArg(args[1], "slice", "the start offset");
+    size_t count = args.size() == 3 ? sizeArg(args[2], "slice", "the length") : std::string::npos;
+
+    if (auto buf = args[0].asNative<ByteBuffer>()) {
+        return Value(buf->slice(start, count));
+    }
+    std::string_view text = bytesOf(args[0], "slice");
+    if (start > text.size()) start = text.size();
+    return Value(std::string(text.substr(start, count)));
+}
+
+// FileIO.size(bytes) -> length in bytes of a string or ByteBuffer.
+Value dex_size(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() != 1) {
+        std::cerr << "Runtime Error: size expects 1 argument." << std::endl;
+        throw std::runtime_error("size expects 1 argument");
+    }
+    return Value(std::to_string(bytesOf(args[0], "size").size()));
+}
+
+// FileIO.find(bytes, needle, from) -> offset of needle, or "-1".
+Value dex_find(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() < 2 || args.size() > 3 || !args[1].isString() || (args.size() == 3 && !args[2].isString())) {
+        std::cerr << "Runtime Error: find expects bytes, a needle string and an optional start offset." << std::endl;
+        throw std::runtime_error("find expects bytes, a needle string and an optional start offset");
+    }
+    std::string_view text = bytesOf(args[0], "find");
+    size_t from = args.size() == 3 ? sizeArg(args[2], "find", "the start offset") : 0;
+    size_t at = text.find(args[1].asString(), from);
+    return Value(at == std::string_view::npos ? std::string("-1") : std::to_string(at));
+}
+
+// FileIO.toString(bytes) -> copies a ByteBuffer (or slice) into a string.
+Value dex_bufferToString(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() != 1) {
+        std::cerr << "Runtime Error: toString expects 1 argument." << std::endl;
+        throw std::runtime_error("toString expects 1 argument");
+    }
+    return Value(std::string(bytesOf(args[0], "toString")));
+}
+
+Value dex_toCSV(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto table = args.size() == 1 ? args[0].asNative<Table>() : nullptr;
+    if (args.size() != 1 || (!args[0].isArray() && !table)) {
+        std::cerr << "Runtime Error: toCSV expects 1 array or Table argument." << std::endl;
+        throw std::runtime_error("toCSV expects 1 array or Table argument");
+    }
+
+    // Serialize straight from the Dex value; no intermediate vector<vector<string>>.
+    std::string out;
+    CSVWriter writer(out);
+    if (table) {
+        writer.writeTable(*table);
+    } else {
+        writer.writeRows(args[0]);
+    }
+    return Value(std::move(out));
+}
+
+// FileIO.writeCSV(path, rows | table, options) -> number of data rows
+// written, not counting the header. Streams to the file in 1 MiB chunks. Options: delimiter, append ("true"
+// to add to the end of an existing file), header (Tables and object rows,
+// default "true"; never written when appending to a non-empty file),
+// compression (auto by extension, none, gzip, zstd) and level.
+Value dex_writeCSV(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto table = args.size() >= 2 ? args[1].asNative<Table>() : nullptr;
+    if (args.size() < 2 || args.size() > 3 || !args[0].isString() || (!args[1].isArray() && !table)) {
+        std::cerr << "Runtime Error: writeCSV expects a path, an array or Table, and optional options." << std::endl;
+        throw std::runtime_error("writeCSV expects a path, an array or Table, and optional options");
+    }
+
+    Value options = args.size() == 3 ? args[2] : Value::nil();
+    std::string delimiter = optionString(options, "delimiter", ",");
+    if (delimiter.size() != 1) {
+        throw std::runtime_error("writeCSV: delimiter must be a single character");
+    }
+    bool append = optionBool(options, "append", false);
+    bool header = optionBool(options, "header", true);
+
+    const std::string& path = args[0].asString();
+    // Appending below existing rows: their header is already there
+    struct stat st;
+    if (append && header && ::stat(path.c_str(), &st) == 0 && st.st_size > 0) header = false;
+    Compression compression = resolveCompression(parseCompression(optionString(options, "compression", "auto")), path);
+    auto sink = openSink(path, compression, append, static_cast<int>(optionInt(options, "level", -1)));
+
+    CSVWriter writer(*sink, 1 << 20, delimiter[0]);
+    if (table) {
+        writer.writeTable(*table, header);
+    } else {
+        writer.writeRows(args[1], header);
+    }
+    writer.flush();
+    sink->finish();
+    FileCache::instance().invalidate(path);
+    size_t rows = writer.rowsWritten();
+    return Value(std::to_string(rows));
+}
+
+// Reads the CSV options object shared by openCSV and loadTable:
+// header ("true" to name columns after the first row), delimiter, quote,
+// bufferSize (bytes per read), compression (auto by extension, none, gzip, zstd).
+static CSVOptions csvOptionsFromArgs(const std::vector<Value>& args, const char* name, bool defaultHeader) {
+    if (args.empty() || args.size() > 2 || !args[0].isString()) {
+        std::cerr << "Runtime Error: " << name << " expects a path and an optional options object." << std::endl;
+        throw std::runtime_error(std::string(name) + " expects a path and an optional options object");
+    }
+
+    CSVOptions options;
+    options.header = defaultHeader;
+    if (args.size() == 2) {
+        const Value& opts = args[1];
+        std::string delimiter = optionString(opts, "delimiter", ",");
+        std::string quote = optionString(opts, "quote", "\"");
+        if (delimiter.size() != 1 || quote.size() != 1) {
+            throw std::runtime_error(std::string(name) + ": delimiter and quote must be single characters");
+        }
+        options.delimiter = delimiter[0];
+        options.quote = quote[0];
+        options.header = optionBool(opts, "header", defaultHeader);
+        long long bufferSize = optionInt(opts, "bufferSize", static_cast<long long>(options.bufferSize));
+        if (bufferSize > 0) options.bufferSize = static_cast<size_t>(bufferSize);
+        options.compression = parseCompression(optionString(opts, "compression", "auto"));
+    }
+    return options;
+}
+
+// FileIO.openCSV(path, options) -> CSVReader cursor.
+// With header set, rows come back as objects keyed by the first row.
+Value dex_openCSV(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    CSVOptions options = csvOptionsFromArgs(args, "openCSV", false);
+    return Value(std::make_shared<CSVReader>(args[0].asString(), options));
+}
+
+// FileIO.loadTable(path, options) -> columnar Table, typed per column.
+// Same options as openCSV, but header defaults to "true".
+Value dex_loadTable(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    CSVOptions options = csvOptionsFromArgs(args, "loadTable", true);
+    CSVReader reader(args[0].asString(), options);
+    return Value(tableFromCSV(reader));
+}
+
+// FileIO.openValues(path, options) -> iterator over the Values of a binary
+// Value file (see value_codec.h), e.g. one written by Database.exportTo.
+// options: compression.
+Value dex_openValues(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.empty() || args.size() > 2 || !args[0].isString()) {
+        std::cerr << "Runtime Error: openValues expects a path and optional options." << std::endl;
+        throw std::runtime_error("openValues expects a path and optional options");
+    }
+    const std::string& path = args[0].asString();
+    return Value(std::make_shared<ValueReader>(path, compressionFor(args, 1, path)));
+}
+
+// FileIO.next(iterator) -> next element, or null once the iterator is exhausted.
+Value dex_next(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto it = args.size() == 1 ? args[0].asNative<NativeIterator>() : nullptr;
+    if (!it) {
+        std::cerr << "Runtime Error: next expects 1 iterator argument." << std::endl;
+        throw std::runtime_error("next expects 1 iterator argument");
+    }
+    Value out;
+    return it->next(out) ? out : Value::nil();
+}
+
+Value dex_closeCSV(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto reader = args.size() == 1 ? args[0].asNative<CSVReader>() : nullptr;
+    if (!reader) {
+        std::cerr << "Runtime Error: closeCSV expects 1 CSVReader argument." << std::endl;
+        throw std::runtime_error("closeCSV expects 1 CSVReader argument");
+    }
+    reader->close();
+    return Value::nil();
+}
+
+static std::shared_ptr<FileHandle> handleArg(const std::vector<Value>& args, size_t count, const char* name) {
+    auto handle = args.size() == count ? args[0].asNative<FileHandle>() : nullptr;
+    if (!handle) {
+        std::cerr << "Runtime Error: " << name << " expects a FileHandle and " << (count - 1) << " more argument(s)." << std::endl;
+        throw std::runtime_error(std::string(name) + " expects a FileHandle as its first argument");
+    }
+    return handle;
+}
+
+// FileIO.open(path, mode, options) -> FileHandle.
+// mode is r, w, a, r+, w+ or a+ ("a" opens with O_APPEND); options: bufferSize.
+Value dex_open(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.empty() || args.size() > 3 || !args[0].isString() || (args.size() >= 2 && !args[1].isString())) {
+        std::cerr << "Runtime Error: open expects a path, an optional mode and optional options." << std::endl;
+        throw std::runtime_error("open expects a path, an optional mode and optional options");
+    }
+    std::string mode = args.size() >= 2 ? args[1].asString() : "r";
+    long long bufferSize = args.size() == 3
+        ? optionInt(args[2], "bufferSize", static_cast<long long>(FileHandle::defaultBufferSize))
+        : static_cast<long long>(FileHandle::defaultBufferSize);
+    return Value(std::make_shared<FileHandle>(args[0].asString(), mode,
+                                              bufferSize > 0 ? static_cast<size_t>(bufferSize) : 0));
+}
+
+// FileIO.readLine(handle) -> next line without its terminator, or null at EOF.
+Value dex_readLine(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto handle = handleArg(args, 1, "readLine");
+    std::string line;
+    return handle->readLine(line) ? Value(std::move(line)) : Value::nil();
+}
+
+// FileIO.readChunk(handle, n) -> up to n bytes, or null at EOF.
+Value dex_readChunk(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto handle = handleArg(args, 2, "readChunk");
+    std::string chunk = handle->readChunk(sizeArg(args[1], "readChunk", "the byte count"));
+    return chunk.empty() ? Value::nil() : Value(std::move(chunk));
+}
+
+// FileIO.write(handle, data) -> number of bytes written. Accepts strings and ByteBuffers.
+Value dex_write(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto handle = handleArg(args, 2, "write");
+    std::string_view data = bytesOf(args[1], "write");
+    handle->write(data);
+    return Value(std::to_string(data.size()));
+}
+
+Value dex_flush(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    handleArg(args, 1, "flush")->flush();
+    return Value::nil();
+}
+
+// FileIO.seek(handle, offset, whence) -> new offset. whence: set (default), cur, end.
+Value dex_seek(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto handle = args.size() == 3 ? handleArg(args, 3, "seek") : handleArg(args, 2, "seek");
+    if (!args[1].isString() || (args.size() == 3 && !args[2].isString())) {
+        throw std::runtime_error("seek expects a numeric offset and an optional whence string");
+    }
+    std::string whence = args.size() == 3 ? args[2].asString() : "set";
+    long long offset = 0;
+    if (!parseInteger(args[1].asString(), offset)) {
+        std::cerr << "Runtime Error: seek expects the offset to be an integer." << std::endl;
+        throw std::runtime_error("seek expects the offset to be an integer");
+    }
+    return Value(std::to_string(handle->seek(offset, whence)));
+}
+
+Value dex_close(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    handleArg(args, 1, "close")->close();
+    return Value::nil();
+}
+
+// FileIO.readFileAsync(path) -> FileFuture; FileIO.await yields the contents.
+Value dex_readFileAsync(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() != 1 || !args[0].isString()) {
+        std::cerr << "Runtime Error: readFileAsync expects 1 string argument." << std::endl;
+        throw std::runtime_error("readFileAsync expects 1 string argument");
+    }
+    return Value(std::make_shared<FileFuture>(AsyncFileIO::instance().readAsync(args[0].asString())));
+}
+
+// FileIO.writeFileAsync(path, data, options) -> FileFuture; FileIO.await yields
+// the byte count. options: append.
+Value dex_writeFileAsync(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() < 2 || args.size() > 3 || !args[0].isString()) {
+        std::cerr << "Runtime Error: writeFileAsync expects a path, data and optional options." << std::endl;
+        throw std::runtime_error("writeFileAsync expects a path, data and optional options");
+    }
+    FileWriteRequest req;
+    req.path = args[0].asString();
+    req.data = std::string(bytesOf(args[1], "writeFileAsync"));
+    req.append = args.size() == 3 && optionBool(args[2], "append", false);
+    return Value(std::make_shared<FileFuture>(AsyncFileIO::instance().writeAsync(std::move(req))));
+}
+
+// FileIO.await(future) -> result of a readFileAsync/writeFileAsync call.
+Value dex_await(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    auto future = args.size() == 1 ? args[0].asNative<FileFuture>() : nullptr;
+    if (!future) {
+        std::cerr << "Runtime Error: await expects 1 FileFuture argument." << std::endl;
+        throw std::runtime_error("await expects 1 FileFuture argument");
+    }
+    return future->get();
+}
+
+// FileIO.readMany(paths) -> array of contents in the same order. Files that
+// cannot be read yield null (the error is reported on stderr).
+Value dex_readMany(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() != 1 || !args[0].isArray()) {
+        std::cerr << "Runtime Error: readMany expects 1 array of paths." << std::endl;
+        throw std::runtime_error("readMany expects 1 array of paths");
+    }
+    std::vector<std::string> paths;
+    paths.reserve(args[0].asArray().size());
+    for (const auto& p : args[0].asArray()) {
+        if (!p.isString()) throw std::runtime_error("readMany expects an array of path strings");
+        paths.push_back(p.asString());
+    }
+
+    std::vector<Value> out;
+    out.reserve(paths.size());
+    for (auto& r : AsyncFileIO::instance().readMany(paths)) {
+        if (!r.ok()) {
+            std::cerr << "Runtime Error: " << r.error << std::endl;
+            out.push_back(Value::nil());
+        } else {
+            out.push_back(Value(std::move(r.data)));
+        }
+    }
+    return Value(std::move(out));
+}
+
+// FileIO.writeMany([[path, data], ...]) -> array of byte counts (null on failure).
+Value dex_writeMany(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() != 1 || !args[0].isArray()) {
+        std::cerr << "Runtime Error: writeMany expects 1 array of [path, data] pairs." << std::endl;
+        throw std::runtime_error("writeMany expects 1 array of [path, data] pairs");
+    }
+    std::vector<FileWriteRequest> requests;
+    requests.reserve(args[0].asArray().size());
+    for (const auto& pair : args[0].asArray()) {
+        if (!pair.isArray() || pair.asArray().size() != 2 || !pair.asArray()[0].isString()) {
+            throw std::runtime_error("writeMany expects an array of [path, data] pairs");
+        }
+        FileWriteRequest req;
+        req.path = pair.asArray()[0].asString();
+        req.data = std::string(bytesOf(pair.asArray()[1], "writeMany"));
+        requests.push_back(std::move(req));
+    }
+
+    std::vector<Value> out;
+    out.reserve(requests.size());
+    for (const auto& r : AsyncFileIO::instance().writeMany(requests)) {
+        if (!r.ok()) {
+            std::cerr << "Runtime Error: " << r.error << std::endl;
+            out.push_back(Value::nil());
+        } else {
+            out.push_back(Value(std::to_string(r.written)));
+        }
+    }
+    return Value(std::move(out));
+}
+
+static WalkOptions walkOptionsFromArgs(const std::vector<Value>& args) {
+    WalkOptions opts;
+    if (args.size() < 2) return opts;
+    const Value& o = args[1];
+    opts.includeDirs = optionBool(o, "includeDirs", false);
+    opts.followSymlinks = optionBool(o, "followSymlinks", false);
+    opts.maxDepth = static_cast<int>(optionInt(o, "maxDepth", -1));
+    long long threads = optionInt(o, "threads", 0);
+    opts.threads = threads > 0 ? static_cast<size_t>(threads) : 0;
+    opts.pattern = optionString(o, "pattern", "");
+    return opts;
+}
+
+// Runs `fn(path)` (or `fn(path, contents)` with {read: "true"}) for every
+// path the walker yields. Reads happen in parallel on a dedicated pool; the
+// interpreter is not thread-safe, so the calls themselves are serialized.
+// Returns the results in the order the paths were found.
+static Value dispatchEach(Interpreter& interp, DirWalker& walker, const Value& options) {
+    Value fn = *findOption(options, "each");
+    bool readContents = optionBool(options, "read", false);
+    long long threads = optionInt(options, "threads", 0);
+
+    std::mutex interpMutex;
+    ThreadPool pool(threads > 0 ? static_cast<size_t>(threads) : 0);
+    std::vector<std::future<Value>> pending;
+    std::string path;
+    while (walker.nextPath(path)) {
+        pending.push_back(pool.submit([&interp, &interpMutex, fn, readContents, p = std::move(path)]() {
+            std::vector<Value> callArgs{Value(p)};
+            if (readContents) callArgs.push_back(Value(readFile(p)));
+            std::lock_guard<std::mutex> lock(interpMutex);
+            return interp.callFunction(fn, callArgs);
+        }));
+    }
+
+    std::vector<Value> results;
+    results.reserve(pending.size());
+    for (auto& f : pending) results.push_back(f.get());
+    return Value(std::move(results));
+}
+
+// FileIO.walk(dir, options) -> lazy iterator of file paths under dir (use FileIO.next).
+// options: includeDirs, followSymlinks, maxDepth, threads, pattern (glob relative
+// to dir), each (function name run over every file; returns its results instead),
+// read (pass file contents to `each` as a second argument).
+Value dex_walk(Interpreter& interp, const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 2 || !args[0].isString()) {
+        std::cerr << "Runtime Error: walk expects a directory path and optional options." << std::endl;
+        throw std::runtime_error("walk expects a directory path and optional options");
+    }
+    auto walker = std::make_shared<DirWalker>(args[0].asString(), walkOptionsFromArgs(args));
+    if (args.size() == 2 && findOption(args[1], "each")) return dispatchEach(interp, *walker, args[1]);
+    return Value(walker);
+}
+
+// FileIO.glob(pattern, options) -> lazy iterator of matching paths.
+// Supports *, ?, [...] and ** (any number of directories). Same options as walk.
+Value dex_glob(Interpreter& interp, const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 2 || !args[0].isString()) {
+        std::cerr << "Runtime Error: glob expects a pattern string and optional options." << std::endl;
+        throw std::runtime_error("glob expects a pattern string and optional options");
+    }
+    auto [base, rest] = splitGlob(args[0].asString());
+    WalkOptions opts = walkOptionsFromArgs(args);
+    opts.pattern = rest;
+    if (rest.find("**") == std::string::npos) {
+        // Without "**" the pattern fixes the depth, so deeper directories are never scanned.
+        opts.maxDepth = static_cast<int>(std::count(rest.begin(), rest.end(), '/'));
+    }
+    auto walker = std::make_shared<DirWalker>(base, opts);
+    if (args.size() == 2 && findOption(args[1], "each")) return dispatchEach(interp, *walker, args[1]);
+    return Value(walker);
+}
+
+// FileIO.readJSON(path, options) -> parsed value. .gz/.zst files are decoded
+// and parsed as a stream (options.compression overrides the extension).
+// With the cache enabled, repeated reads of an unchanged file reuse the parsed value.
+Value dex_readJSON(Interpreter& interp, const std::vector<Value>& args) {
+    if (args.empty() || args.size() > 2 || !args[0].isString()) {
+        std::cerr << "Runtime Error: readJSON expects a path and optional options." << std::endl;
+        throw std::runtime_error("readJSON expects a path and optional options");
+    }
+    const std::string& path = args[0].asString();
+    Compression compression = compressionFor(args, 1, path);
+    auto parseStream = [&interp](ByteSource& source) {
+        SourceStreamBuf buf(source);
+        std::istream in(&buf);
+        return interp.jsonToDexValue(parseJSON(in));
+    };
+    auto parse = [&](const std::string& raw) {
+        if (compression == Compression::None) return interp.jsonToDexValue(parseJSON(raw.data(), raw.size()));
+        auto source = decompress(std::make_unique<MemorySource>(raw.data(), raw.size()), compression);
+        return parseStream(*source);
+    };
+    if (FileCache::instance().enabled()) return *FileCache::instance().readParsed(path, parse);
+    if (compression != Compression::None) return parseStream(*openSource(path, compression));
+    return parse(readFile(path));
+}
+
+// FileIO.enableCache(options): cache readFile/readJSON results.
+// options: maxBytes (default 64 MiB), watch (invalidate via inotify instead of stat per hit).
+Value dex_enableCache(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+
+    if (args.size() > 1) {
+        std::cerr << "Runtime Error: enableCache expects optional options." << std::endl;
+        throw std::runtime_error("enableCache expects optional options");
+    }
+    Value options = args.empty() ? Value::nil() : args[0];
+    long long maxBytes = optionInt(options, "maxBytes", 64LL * 1024 * 1024);
+    FileCache::instance().enable(maxBytes > 0 ? static_cast<size_t>(maxBytes) : 0,
+                                 optionBool(options, "watch", false));
+    return Value::nil();
+}
+
+Value dex_disableCache(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    (void)args;
+
+    FileCache::instance().disable();
+    return Value::nil();
+}
+
+// FileIO.cacheStats() -> {hits, misses, invalidations, evictions, entries, bytes, maxBytes, watching}
+Value dex_cacheStats(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    (void)args;
+
+    FileCacheStats s = FileCache::instance().stats();
+    std::unordered_map<std::string, Value> out;
+    out["hits"] = Value(std::to_string(s.hits));
+    out["misses"] = Value(std::to_string(s.misses));
+    out["invalidations"] = Value(std::to_string(s.invalidations));
+    out["evictions"] = Value(std::to_string(s.evictions));
+    out["entries"] = Value(std::to_string(s.entries));
+    out["bytes"] = Value(std::to_string(s.bytes));
+    out["maxBytes"] = Value(std::to_string(s.maxBytes));
+    out["watching"] = Value(s.watching ? "true" : "false");
+    return Value(std::move(out));
+}
+
+void registerFileIOBindings(Interpreter& interp) {
+    interp.registerFunction("FileIO.readFile", dex_readFile);
+    interp.registerFunction("FileIO.writeFile", dex_writeFile);
+    interp.registerFunction("FileIO.parseJSON", dex_parseJSON);
+    interp.registerFunction("FileIO.toJSON", dex_toJSON);
+    interp.registerFunction("FileIO.parseCSV", dex_parseCSV);
+    interp.registerFunction("FileIO.toCSV", dex_toCSV);
+    interp.registerFunction("FileIO.openCSV", dex_openCSV);
+    interp.registerFunction("FileIO.next", dex_next);
+    interp.registerFunction("FileIO.closeCSV", dex_closeCSV);
+    interp.registerFunction("FileIO.loadTable", dex_loadTable);
+    interp.registerFunction("FileIO.openValues", dex_openValues);
+    interp.registerFunction("FileIO.writeCSV", dex_writeCSV);
+    interp.registerFunction("FileIO.slice", dex_slice);
+    interp.registerFunction("FileIO.size", dex_size);
+    interp.registerFunction("FileIO.find", dex_find);
+    interp.registerFunction("FileIO.toString", dex_bufferToString);
+    interp.registerFunction("FileIO.open", dex_open);
+    interp.registerFunction("FileIO.readLine", dex_readLine);
+    interp.registerFunction("FileIO.readChunk", dex_readChunk);
+    interp.registerFunction("FileIO.write", dex_write);
+    interp.registerFunction("FileIO.flush", dex_flush);
+    interp.registerFunction("FileIO.seek", dex_seek);
+    interp.registerFunction("FileIO.close", dex_close);
+    interp.registerFunction("FileIO.readFileAsync", dex_readFileAsync);
+    interp.registerFunction("FileIO.writeFileAsync", dex_writeFileAsync);
+    interp.registerFunction("FileIO.await", dex_await);
+    interp.registerFunction("FileIO.readMany", dex_readMany);
+    interp.registerFunction("FileIO.writeMany", dex_writeMany);
+    interp.registerFunction("FileIO.walk", dex_walk);
+    interp.registerFunction("FileIO.glob", dex_glob);
+    interp.registerFunction("FileIO.readJSON", dex_readJSON);
+    interp.registerFunction("FileIO.enableCache", dex_enableCache);
+    interp.registerFunction("FileIO.disableCache", dex_disableCache);
+    interp.registerFunction("FileIO.cacheStats", dex_cacheStats);
+}
+
+} // namespace dex
@@ -0,0 +1,198 @@
+// src/runtime/http_parser.cpp
+#include "http_parser.h"
+#include <cstring>
+
+namespace dex {
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        unsigned char x = static_cast<unsigned char>(a[i]);
+        unsigned char y = static_cast<unsigned char>(b[i]);
+        if (x >= 'A' && x <= 'Z') x += 'a' - 'A';
+        if (y >= 'A' && y <= 'Z') y += 'a' - 'A';
+        if (x != y) return false;
+    }
+    return true;
+}
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (size_t i = 0; i < headerCount; ++i) {
+        if (equalsIgnoreCase(headers[i].name, name)) return headers[i].value;
+    }
+    return {};
+}
+
+namespace {
+
+// RFC 9110 token characters.
+bool isTokenChar(unsigned char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) return true;
+    return c != 0 && std::strchr("!#$%&'*+-.^_`|~", c) != nullptr;
+}
+
+bool isToken(std::string_view s) {
+    if (s.empty()) return false;
+    for (char c : s) {
+        if (!isTokenChar(static_cast<unsigned char>(c))) return false;
+    }
+    return true;
+}
+
+std::string_view trimSpaces(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+// One past the blank line that ends the head, or nullptr if it hasn't
+// arrived. Bare LF line endings are accepted alongside CRLF.
+const char* findHeadEnd(const char* p, const char* end) {
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        if (!nl) return nullptr;
+        p = nl + 1;
+        if (p < end && *p == '\n') return p + 1;
+        if (p + 1 < end && p[0] == '\r' && p[1] == '\n') return p + 2;
+    }
+    return nullptr;
+}
+
+// Next line of the head without its line ending; advances `p` past it.
+std::string_view nextLine(const char*& p, const char* end) {
+    const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    std::string_view line(p, nl - p);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    p = nl + 1;
+    return line;
+}
+
+// Calls fn on each comma-separated element of a header value.
+template <typename Fn>
+void forEachListItem(std::string_view value, Fn&& fn) {
+    while (!value.empty()) {
+        size_t comma = value.find(',');
+        fn(trimSpaces(value.substr(0, comma)));
+        if (comma == std::string_view::npos) break;
+        value.remove_prefix(comma + 1);
+    }
+}
+
+bool parseContentLength(std::string_view s, size_t& out) {
+    if (s.empty() || s.size() > 18) return false; // keeps the arithmetic below from overflowing
+    size_t n = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        n = n * 10 + static_cast<size_t>(c - '0');
+    }
+    out = n;
+    return true;
+}
+
+void splitTarget(HttpRequest& request) {
+    std::string_view t = request.target;
+    // absolute-form ("http://host/path?q"), used when talking to proxies
+    if (!t.empty() && t.front() != '/' && t.front() != '*') {
+        size_t scheme = t.find("://");
+        if (scheme != std::string_view::npos) {
+            size_t slash = t.find('/', scheme + 3);
+            t = slash == std::string_view::npos ? std::string_view("/") : t.substr(slash);
+        }
+    }
+    size_t q = t.find('?');
+    request.path = t.substr(0, q);
+    request.query = q == std::string_view::npos ? std::string_view() : t.substr(q + 1);
+}
+
+HttpParseResult fail(int status) {
+    HttpParseResult r;
+    r.status = HttpParseStatus::Error;
+    r.errorStatus = status;
+    return r;
+}
+
+} // namespace
+
+HttpParseResult parseHttpRequest(const char* data, size_t size, HttpRequest& request, const HttpLimits& limits) {
+    const char* p = data;
+    const char* end = data + size;
+    // Empty lines before the request line are ignored (RFC 9112 section 2.2).
+    while (p < end && (*p == '\r' || *p == '\n')) ++p;
+
+    const char* headEnd = findHeadEnd(p, end);
+    if (!headEnd) {
+        if (static_cast<size_t>(end - p) > limits.maxHeadBytes) return fail(431);
+        return HttpParseResult();
+    }
+    if (static_cast<size_t>(headEnd - p) > limits.maxHeadBytes) return fail(431);
+
+    request.headerCount = 0;
+    request.params.count = 0;
+    request.body = {};
+    request.expectContinue = false;
+
+    // Request line: method SP target SP HTTP-version
+    std::string_view line = nextLine(p, headEnd);
+    size_t sp1 = line.find(' ');
+    if (sp1 == std::string_view::npos) return fail(400);
+    size_t sp2 = line.find(' ', sp1 + 1);
+    if (sp2 == std::string_view::npos) return fail(400);
+    request.method = line.substr(0, sp1);
+    request.target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string_view version = line.substr(sp2 + 1);
+    if (!isToken(request.method) || request.target.empty()) return fail(400);
+    for (char c : request.target) {
+        if (static_cast<unsigned char>(c) <= 0x20 || c == 0x7f) return fail(400);
+    }
+    if (version.size() != 8 || version.compare(0, 5, "HTTP/") != 0) return fail(400);
+    if (version[5] != '1' || version[6] != '.' || version[7] < '0' || version[7] > '9') return fail(505);
+    request.minorVersion = version[7] - '0';
+    request.keepAlive = request.minorVersion >= 1;
+    splitTarget(request);
+
+    size_t contentLength = 0;
+    bool haveLength = false;
+    for (;;) {
+        line = nextLine(p, headEnd);
+        if (line.empty()) break;
+        if (line.front() == ' ' || line.front() == '\t') return fail(400); // obsolete line folding
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) return fail(400);
+        std::string_view name = line.substr(0, colon);
+        std::string_view value = trimSpaces(line.substr(colon + 1));
+        if (!isToken(name)) return fail(400);
+        for (char c : value) {
+            unsigned char u = static_cast<unsigned char>(c);
+            if ((u < 0x20 && c != '\t') || u == 0x7f) return fail(400);
+        }
+        if (request.headerCount == HttpRequest::maxHeaders) return fail(431);
+        request.headers[request.headerCount++] = {name, value};
+
+        if (equalsIgnoreCase(name, "content-length")) {
+            size_t n;
+            if (!parseContentLength(value, n) || (haveLength && n != contentLength)) return fail(400);
+            contentLength = n;
+            haveLength = true;
+        } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+            return fail(501);
+        } else if (equalsIgnoreCase(name, "connection")) {
+            forEachListItem(value, [&](std::string_view option) {
+                if (equalsIgnoreCase(option, "close")) request.keepAlive = false;
+                else if (equalsIgnoreCase(option, "keep-alive")) request.keepAlive = true;
+            });
+        } else if (equalsIgnoreCase(name, "expect")) {
+            request.expectContinue = equalsIgnoreCase(value, "100-continue");
+        }
+    }
+
+    if (contentLength > limits.maxBodyBytes) return fail(413);
+    HttpParseResult r;
+    r.headBytes = static_cast<size_t>(headEnd - data);
+    if (size - r.headBytes < contentLength) return r; // body still arriving
+    request.body = std::string_view(headEnd, contentLength);
+    r.status = HttpParseStatus::Complete;
+    r.consumed = r.headBytes + contentLength;
+    return r;
+}
+
+} // namespace dex
@@ -0,0 +1,66 @@
+// src/runtime/http_parser.h
+#ifndef DEX_HTTP_PARSER_H
+#define DEX_HTTP_PARSER_H
+
+#include "router.h"
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace dex {
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+// One HTTP/1.x request, parsed in place: every view points into the buffer
+// handed to parseHttpRequest, so parsing allocates nothing and the request
+// is only valid while that buffer is left untouched.
+struct HttpRequest {
+    static constexpr size_t maxHeaders = 64;
+
+    std::string_view method;
+    std::string_view target; // as sent: path plus query
+    std::string_view path;   // not percent-decoded
+    std::string_view query;  // after '?', without it
+    std::string_view body;
+    int minorVersion = 1;    // HTTP/1.<minorVersion>
+    std::array<HttpHeader, maxHeaders> headers;
+    size_t headerCount = 0;
+    bool keepAlive = true;   // from the version and the Connection header
+    bool expectContinue = false;
+    RouteParams params;      // set by routing, not by the parser
+
+    // Value of the first header called `name` (case-insensitive), or empty.
+    std::string_view header(std::string_view name) const;
+    // Value of the route parameter `name`, or empty.
+    std::string_view param(std::string_view name) const { return params.get(name); }
+};
+
+struct HttpLimits {
+    size_t maxHeadBytes = 16 * 1024; // request line plus headers
+    size_t maxBodyBytes = 1 << 20;
+};
+
+enum class HttpParseStatus { Complete, Incomplete, Error };
+
+struct HttpParseResult {
+    HttpParseStatus status = HttpParseStatus::Incomplete;
+    size_t consumed = 0;  // bytes of the whole request, once Complete
+    size_t headBytes = 0; // set as soon as the head is complete, even if the body is not
+    int errorStatus = 0;  // status to answer an Error with: 400, 413, 431, 501 or 505
+};
+
+// Parses the request at the start of data[0, size). Pipelined requests
+// after it are left alone; call again at data + consumed. Bodies must be
+// framed by Content-Length; chunked request bodies are answered with 501.
+HttpParseResult parseHttpRequest(const char* data, size_t size, HttpRequest& request,
+                                 const HttpLimits& limits = HttpLimits());
+
+// ASCII case-insensitive comparison, as header names and tokens need.
+bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+} // namespace dex
+
+#endif // DEX_HTTP_PARSER_H
@@ -0,0 +1,558 @@
+// src/runtime/instrumented_database.cpp
+#include "instrumented_database.h"
+#include "../interpreter/interpreter.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace dex {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+    const size_t n = std::char_traits<char>::length(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+bool isWordChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$'; }
+
+// Index just past the literal or quoted identifier opening at `i` (a
+// doubled closing character escapes it); the end of `sql` if unterminated.
+size_t skipQuoted(const std::string& sql, size_t i) {
+    const char close = sql[i] == '[' ? ']' : sql[i];
+    for (size_t j = i + 1; j < sql.size(); ++j) {
+        if (sql[j] != close) continue;
+        if (close != ']' && j + 1 < sql.size() && sql[j + 1] == close) {
+            ++j;
+            continue;
+        }
+        return j + 1;
+    }
+    return sql.size();
+}
+
+uint64_t paramBytes(const SqlParams& params) {
+    uint64_t n = 0;
+    for (const auto& p : params) {
+        n += std::holds_alternative<std::string>(p) ? std::get<std::string>(p).size() : 8;
+    }
+    return n;
+}
+
+std::string formatParams(const SqlParams& params) {
+    constexpr size_t maxText = 200;
+    std::string out = "[";
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (i) out += ", ";
+        const SqlValue& p = params[i];
+        if (std::holds_alternative<std::nullptr_t>(p)) {
+            out += "NULL";
+        } else if (std::holds_alternative<int64_t>(p)) {
+            out += std::to_string(std::get<int64_t>(p));
+        } else if (std::holds_alternative<double>(p)) {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%.17g", std::get<double>(p));
+            out += buf;
+        } else {
+            const std::string& s = std::get<std::string>(p);
+            out += '\'';
+            out.append(s, 0, std::min(s.size(), maxText));
+            out += s.size() > maxText ? "...'" : "'";
+        }
+    }
+    return out + "]";
+}
+
+std::string truncated(const std::string& s, size_t n) {
+    return s.size() <= n ? s : s.substr(0, n - 3) + "...";
+}
+
+class InstrumentedStatement : public PreparedStatement {
+public:
+    InstrumentedStatement(DatabaseStats& statsRegistry, std::shared_ptr<PreparedStatement> stmt)
+        : stats(statsRegistry), inner(std::move(stmt)), entry(stats.entry(statementFingerprint(inner->sql()))) {}
+
+    bool execute(const SqlParams& params) override {
+        auto start = Clock::now();
+        bool ok = inner->execute(params);
+        stats.record(entry, secondsSince(start), 0, 0, ok, inner->sql(), &params);
+        return ok;
+    }
+    QueryResult query(const SqlParams& params) override {
+        auto start = Clock::now();
+        QueryResult result = inner->query(params);
+        stats.record(entry, secondsSince(start), result.rowCount, resultPayloadBytes(result), true, inner->sql(),
+                     &params);
+        return result;
+    }
+    const std::string& sql() const override { return inner->sql(); }
+
+private:
+    DatabaseStats& stats;
+    std::shared_ptr<PreparedStatement> inner;
+    DatabaseStats::Entry& entry; // fingerprinted once, at prepare time
+};
+
+// Counts the time spent opening and fetching, not the time the caller
+// spends between fetches; recorded once, when the cursor goes away.
+class InstrumentedCursor : public Cursor {
+public:
+    InstrumentedCursor(DatabaseStats& statsRegistry, DatabaseStats::Entry& statsEntry, std::unique_ptr<Cursor> cursor,
+                       std::string sqlText, SqlParams bound, double openSeconds)
+        : stats(statsRegistry), entry(statsEntry), inner(std::move(cursor)), sql(std::move(sqlText)),
+          params(std::move(bound)), seconds(openSeconds) {}
+
+    ~InstrumentedCursor() override { stats.record(entry, seconds, rows, bytes, !inner->failed(), sql, &params); }
+
+    QueryResult fetch(size_t maxRows) override {
+        auto start = Clock::now();
+        QueryResult result = inner->fetch(maxRows);
+        seconds += secondsSince(start);
+        rows += result.rowCount;
+        bytes += resultPayloadBytes(result);
+        done = inner->exhausted();
+        error = inner->failed();
+        return result;
+    }
+
+private:
+    DatabaseStats& stats;
+    DatabaseStats::Entry& entry;
+    std::unique_ptr<Cursor> inner;
+    std::string sql;
+    SqlParams params;
+    double seconds;
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+};
+
+// Times an async query from issue until its result is collected.
+class InstrumentedFuture : public QueryFuture {
+public:
+    InstrumentedFuture(DatabaseStats& statsRegistry, DatabaseStats::Entry& statsEntry,
+                       std::unique_ptr<QueryFuture> pending, std::string sqlText, SqlParams bound,
+                       Clock::time_point issued)
+        : stats(statsRegistry), entry(statsEntry), inner(std::move(pending)), sql(std::move(sqlText)),
+          params(std::move(bound)), start(issued) {}
+
+    bool ready() override { return inner->ready(); }
+    QueryResult get() override {
+        QueryResult result = inner->get();
+        stats.record(entry, secondsSince(start), result.rowCount, resultPayloadBytes(result), true, sql, &params);
+        return result;
+    }
+
+private:
+    DatabaseStats& stats;
+    DatabaseStats::Entry& entry;
+    std::unique_ptr<QueryFuture> inner;
+    std::string sql;
+    SqlParams params;
+    Clock::time_point start;
+};
+
+template <typename F>
+bool timedControl(DatabaseStats& stats, const std::string& statement, F&& run) {
+    DatabaseStats::Entry& e = stats.entry(statement);
+    auto start = Clock::now();
+    bool ok = run();
+    stats.record(e, secondsSince(start), 0, 0, ok, statement);
+    return ok;
+}
+
+} // namespace
+
+std::string statementFingerprint(const std::string& sql) {
+    std::string out;
+    out.reserve(sql.size());
+    bool space = false;
+    auto emit = [&](const char* data, size_t n) {
+        if (space && !out.empty()) out += ' ';
+        space = false;
+        out.append(data, n);
+    };
+    auto placeholder = [&]() {
+        if (endsWith(out, "?, ...,")) {
+            out.pop_back(); // a longer run: already shortened
+        } else if (endsWith(out, "?,")) {
+            out += " ...";
+        } else {
+            emit("?", 1);
+        }
+        space = false;
+    };
+
+    size_t i = 0;
+    while (i < sql.size()) {
+        const char c = sql[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            space = true;
+            ++i;
+        } else if (sql.compare(i, 2, "--") == 0) {
+            size_t end = sql.find('\n', i);
+            i = end == std::string::npos ? sql.size() : end + 1;
+            space = true;
+        } else if (sql.compare(i, 2, "/*") == 0) {
+            size_t end = sql.find("*/", i + 2);
+            i = end == std::string::npos ? sql.size() : end + 2;
+            space = true;
+        } else if (c == '\'') {
+            i = skipQuoted(sql, i);
+            placeholder();
+        } else if (c == '"' || c == '`' || c == '[') {
+            size_t end = skipQuoted(sql, i);
+            emit(sql.data() + i, end - i);
+            i = end;
+        } else if (std::isdigit(static_cast<unsigned char>(c)) ||
+                   (c == '.' && i + 1 < sql.size() && std::isdigit(static_cast<unsigned char>(sql[i + 1])))) {
+            // Numbers, including 1.5e-3 and 0x1F
+            size_t end = i + 1;
+            while (end < sql.size() &&
+                   (isWordChar(sql[end]) || sql[end] == '.' ||
+                    ((sql[end] == '+' || sql[end] == '-') && (sql[end - 1] == 'e' || sql[end - 1] == 'E')))) {
+                ++end;
+            }
+            i = end;
+            placeholder();
+        } else if (isWordChar(c)) {
+            size_t end = i;
+            while (end < sql.size() && isWordChar(sql[end])) ++end;
+            emit(sql.data() + i, end - i);
+            i = end;
+        } else if (c == '?') {
+            ++i;
+            placeholder();
+        } else {
+            emit(&c, 1);
+            ++i;
+        }
+    }
+    while (!out.empty() && (out.back() == ';' || out.back() == ' ')) out.pop_back();
+    return out;
+}
+
+// Bucket i < 4 holds exactly i. Above that, each power of two [2^e, 2^(e+1))
+// is split into four equal sub-buckets.
+size_t Histogram::bucketOf(uint64_t v) {
+    if (v < 4) return static_cast<size_t>(v);
+    const unsigned e = 63 - static_cast<unsigned>(__builtin_clzll(v));
+    return (e - 1) * 4 + ((v >> (e - 2)) & 3);
+}
+
+uint64_t Histogram::bucketUpper(size_t i) {
+    if (i < 4) return i;
+    const unsigned e = static_cast<unsigned>(i / 4 + 1);
+    const uint64_t sub = i % 4;
+    return ((4 + sub) << (e - 2)) + ((uint64_t{1} << (e - 2)) - 1);
+}
+
+void Histogram::add(uint64_t v) {
+    buckets[bucketOf(v)].fetch_add(1, std::memory_order_relaxed);
+    n.fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(v, std::memory_order_relaxed);
+    uint64_t seen = largest.load(std::memory_order_relaxed);
+    while (v > seen && !largest.compare_exchange_weak(seen, v, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::reset() {
+    for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+    n.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    largest.store(0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::percentile(double p) const {
+    const uint64_t c = count();
+    if (c == 0) return 0;
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p / 100.0 * static_cast<double>(c))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucketUpper(i), max());
+    }
+    return max(); // adds racing with this read
+}
+
+uint64_t resultPayloadBytes(const QueryResult& result) {
+    uint64_t n = 0;
+    for (const auto& c : result.columns) {
+        n += c.bytes.size() + 8 * (c.ints.size() + c.reals.size());
+    }
+    return n;
+}
+
+DatabaseStats& DatabaseStats::instance() {
+    // Never destroyed: connections and cursors released during static
+    // destruction may still record into it.
+    static DatabaseStats* stats = new DatabaseStats();
+    return *stats;
+}
+
+DatabaseStats::DatabaseStats() {
+    if (const char* ms = std::getenv("DEX_SLOW_QUERY_MS")) setSlowThreshold(std::atof(ms));
+    if (const char* path = std::getenv("DEX_SLOW_QUERY_LOG"); path && *path && !setSlowLog(path)) {
+        std::cerr << "Database stats: cannot open slow query log " << path << ", using stderr\n";
+    }
+    if (const char* dump = std::getenv("DEX_DB_STATS"); dump && *dump) {
+        std::string target = dump;
+        if (target != "0" && target != "false") dumpAtExit(true, target == "1" || target == "true" ? "" : target);
+    }
+}
+
+DatabaseStats::Entry& DatabaseStats::entry(const std::string& fingerprint) {
+    static const std::string overflow = "(other statements)";
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = entries.find(fingerprint);
+    if (it != entries.end()) return *it->second;
+    const std::string& key = entries.size() < maxStatements ? fingerprint : overflow;
+    std::unique_ptr<Entry>& slot = entries[key];
+    if (!slot) {
+        slot = std::make_unique<Entry>();
+        slot->statement = key;
+    }
+    return *slot;
+}
+
+void DatabaseStats::record(Entry& e, double seconds, uint64_t rows, uint64_t bytes, bool ok, const std::string& sql,
+                           const SqlParams* params) {
+    e.latencyNanos.add(static_cast<uint64_t>(std::max(0.0, seconds) * 1e9));
+    e.rows.add(rows);
+    e.bytes.add(bytes);
+    if (!ok) e.errors.fetch_add(1, std::memory_order_relaxed);
+
+    const double threshold = slowMs.load(std::memory_order_relaxed);
+    const double ms = seconds * 1000.0;
+    if (threshold <= 0.0 || ms < threshold) return;
+
+    std::ostringstream line;
+    char took[32];
+    std::snprintf(took, sizeof(took), "%.3f", ms);
+    line << "[slow query] " << took << " ms";
+    if (int at = Interpreter::currentLine()) line << " at line " << at;
+    line << (ok ? "" : " (failed)") << ": " << sql;
+    if (params && !params->empty()) line << " params: " << formatParams(*params);
+    line << '\n';
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::ostream& out = slowLog ? *slowLog : std::cerr;
+    out << line.str();
+    out.flush();
+}
+
+void DatabaseStats::setSlowThreshold(double ms) {
+    slowMs.store(ms > 0.0 ? ms : 0.0, std::memory_order_relaxed);
+}
+
+bool DatabaseStats::setSlowLog(const std::string& path) {
+    std::unique_ptr<std::ostream> file;
+    if (!path.empty()) {
+        file = std::make_unique<std::ofstream>(path, std::ios::app);
+        if (!*file) return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    slowLog = std::move(file);
+    return true;
+}
+
+void DatabaseStats::dumpAtExit(bool enabled, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    dumpEnabled = enabled;
+    dumpPath = path;
+    if (enabled && !exitHookInstalled) {
+        std::atexit(dumpOnExit);
+        exitHookInstalled = true;
+    }
+}
+
+void DatabaseStats::dumpOnExit() {
+    DatabaseStats& stats = instance();
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        if (!stats.dumpEnabled) return;
+        path = stats.dumpPath;
+    }
+    if (path.empty()) {
+        stats.dump(std::cerr);
+        return;
+    }
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Database stats: cannot write " << path << "\n";
+        return;
+    }
+    stats.dump(out);
+}
+
+std::vector<StatementSummary> DatabaseStats::snapshot() const {
+    std::vector<StatementSummary> out;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [key, e] : entries) {
+        const Histogram& lat = e->latencyNanos;
+        if (lat.count() == 0) continue;
+        StatementSummary s;
+        s.statement = e->statement;
+        s.calls = lat.count();
+        s.errors = e->errors.load(std::memory_order_relaxed);
+        s.totalMs = static_cast<double>(lat.sum()) / 1e6;
+        s.meanMs = s.totalMs / static_cast<double>(s.calls);
+        s.p50Ms = static_cast<double>(lat.percentile(50)) / 1e6;
+        s.p95Ms = static_cast<double>(lat.percentile(95)) / 1e6;
+        s.p99Ms = static_cast<double>(lat.percentile(99)) / 1e6;
+        s.maxMs = static_cast<double>(lat.max()) / 1e6;
+        s.rows = e->rows.sum();
+        s.rowsP50 = e->rows.percentile(50);
+        s.rowsMax = e->rows.max();
+        s.bytes = e->bytes.sum();
+        s.bytesP50 = e->bytes.percentile(50);
+        s.bytesMax = e->bytes.max();
+        out.push_back(std::move(s));
+    }
+    std::sort(out.begin(), out.end(),
+              [](const StatementSummary& a, const StatementSummary& b) { return a.totalMs > b.totalMs; });
+    return out;
+}
+
+void DatabaseStats::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& [key, e] : entries) {
+        e->errors.store(0, std::memory_order_relaxed);
+        e->latencyNanos.reset();
+        e->rows.reset();
+        e->bytes.reset();
+    }
+}
+
+void DatabaseStats::dump(std::ostream& out) const {
+    std::vector<StatementSummary> all = snapshot();
+    if (all.empty()) return;
+    uint64_t calls = 0;
+    double totalMs = 0.0;
+    for (const auto& s : all) {
+        calls += s.calls;
+        totalMs += s.totalMs;
+    }
+    char line[512];
+    std::snprintf(line, sizeof(line), "Database statement stats: %zu statements, %llu calls, %.3f ms\n", all.size(),
+                  static_cast<unsigned long long>(calls), totalMs);
+    out << line;
+    std::snprintf(line, sizeof(line), "%10s %7s %12s %10s %10s %10s %10s %10s %12s %12s  %s\n", "calls", "errors",
+                  "total ms", "mean ms", "p50 ms", "p95 ms", "p99 ms", "max ms", "rows", "bytes", "statement");
+    out << line;
+    for (const auto& s : all) {
+        std::snprintf(line, sizeof(line), "%10llu %7llu %12.3f %10.3f %10.3f %10.3f %10.3f %10.3f %12llu %12llu  ",
+                      static_cast<unsigned long long>(s.calls), static_cast<unsigned long long>(s.errors), s.totalMs,
+                      s.meanMs, s.p50Ms, s.p95Ms, s.p99Ms, s.maxMs, static_cast<unsigned long long>(s.rows),
+                      static_cast<unsigned long long>(s.bytes));
+        out << line << truncated(s.statement, 120) << '\n';
+    }
+    out.flush();
+}
+
+InstrumentedDatabase::InstrumentedDatabase(std::unique_ptr<Database> db)
+    : inner(std::move(db)), stats(DatabaseStats::instance()) {}
+
+InstrumentedDatabase::~InstrumentedDatabase() {
+    clearStatementCache(); // our statements wrap the inner connection's; drop them first
+}
+
+bool InstrumentedDatabase::execute(const std::string& sql) {
+    DatabaseStats::Entry& e = stats.entry(statementFingerprint(sql));
+    auto start = Clock::now();
+    bool ok = inner->execute(sql);
+    stats.record(e, secondsSince(start), 0, 0, ok, sql);
+    return ok;
+}
+
+QueryResult InstrumentedDatabase::query(const std::string& sql) {
+    DatabaseStats::Entry& e = stats.entry(statementFingerprint(sql));
+    auto start = Clock::now();
+    QueryResult result = inner->query(sql);
+    stats.record(e, secondsSince(start), result.rowCount, resultPayloadBytes(result), true, sql);
+    return result;
+}
+
+void InstrumentedDatabase::close() {
+    clearStatementCache();
+    inner->close();
+}
+
+std::shared_ptr<PreparedStatement> InstrumentedDatabase::prepare(const std::string& sql) {
+    auto stmt = inner->prepare(sql);
+    if (!stmt) return nullptr;
+    return std::make_shared<InstrumentedStatement>(stats, std::move(stmt));
+}
+
+std::unique_ptr<Cursor> InstrumentedDatabase::cursor(const std::string& sql, const SqlParams& params) {
+    DatabaseStats::Entry& e = stats.entry(statementFingerprint(sql));
+    auto start = Clock::now();
+    auto cursor = inner->cursor(sql, params);
+    if (!cursor) {
+        stats.record(e, secondsSince(start), 0, 0, false, sql, &params);
+        return nullptr;
+    }
+    return std::make_unique<InstrumentedCursor>(stats, e, std::move(cursor), sql, params, secondsSince(start));
+}
+
+bool InstrumentedDatabase::executeBatch(const std::vector<BatchStatement>& statements) {
+    std::vector<DatabaseStats::Entry*> batchEntries;
+    batchEntries.reserve(statements.size());
+    for (const auto& s : statements) batchEntries.push_back(&stats.entry(statementFingerprint(s.sql)));
+    auto start = Clock::now();
+    bool ok = inner->executeBatch(statements);
+    const double each = statements.empty() ? 0.0 : secondsSince(start) / static_cast<double>(statements.size());
+    for (size_t i = 0; i < statements.size(); ++i) {
+        stats.record(*batchEntries[i], each, 0, 0, ok, statements[i].sql, &statements[i].params);
+    }
+    return ok;
+}
+
+std::unique_ptr<QueryFuture> InstrumentedDatabase::queryAsync(const std::string& sql, const SqlParams& params) {
+    DatabaseStats::Entry& e = stats.entry(statementFingerprint(sql));
+    auto start = Clock::now();
+    return std::make_unique<InstrumentedFuture>(stats, e, inner->queryAsync(sql, params), sql, params, start);
+}
+
+bool InstrumentedDatabase::beginTransaction() {
+    return timedControl(stats, "BEGIN", [&]() { return inner->begin(); });
+}
+
+bool InstrumentedDatabase::commitTransaction() {
+    return timedControl(stats, "COMMIT", [&]() { return inner->commit(); });
+}
+
+bool InstrumentedDatabase::rollbackTransaction() {
+    return timedControl(stats, "ROLLBACK", [&]() { return inner->rollback(); });
+}
+
+bool InstrumentedDatabase::insertRows(const std::string& table, const std::vector<std::string>& columns,
+                                      const std::vector<SqlParams>& rows) {
+    std::string statement = "BULK INSERT INTO " + table + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i) statement += ", ";
+        statement += columns[i];
+    }
+    statement += ")";
+    DatabaseStats::Entry& e = stats.entry(statement);
+    auto start = Clock::now();
+    bool ok = inner->bulkInsert(table, columns, rows).ok;
+    uint64_t bytes = 0;
+    for (const auto& row : rows) bytes += paramBytes(row);
+    stats.record(e, secondsSince(start), ok ? rows.size() : 0, bytes, ok, statement);
+    return ok;
+}
+
+} // namespace dex
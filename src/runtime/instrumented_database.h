@@ -0,0 +1,176 @@
+// src/runtime/instrumented_database.h
+#ifndef DEX_INSTRUMENTED_DATABASE_H
+#define DEX_INSTRUMENTED_DATABASE_H
+
+#include "database.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dex {
+
+// `sql` with comments dropped, whitespace collapsed, string and numeric
+// literals replaced by `?` and runs of `?, ?, ...` shortened to `?, ...`, so
+// statements that differ only in their constants (or IN-list lengths) share
+// one set of stats. Identifiers and keyword case are kept.
+std::string statementFingerprint(const std::string& sql);
+
+// Log-linear histogram of non-negative integers: four sub-buckets per power
+// of two, so a reported percentile is within 25% of the true value. Lock
+// free; concurrent add() calls only contend on cache lines.
+class Histogram {
+public:
+    void add(uint64_t v);
+    void reset();
+
+    uint64_t count() const { return n.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return largest.load(std::memory_order_relaxed); }
+    // Upper bound of the bucket holding the p-th percentile (0-100), capped at max().
+    uint64_t percentile(double p) const;
+
+private:
+    static constexpr size_t bucketCount = 64 * 4;
+    std::array<std::atomic<uint64_t>, bucketCount> buckets{};
+    std::atomic<uint64_t> n{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> largest{0};
+
+    static size_t bucketOf(uint64_t v);
+    static uint64_t bucketUpper(size_t i);
+};
+
+// Snapshot of one statement shape, latencies in milliseconds.
+struct StatementSummary {
+    std::string statement;
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    double totalMs = 0.0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    uint64_t rows = 0;   // total rows returned (queries) or loaded (bulk inserts)
+    uint64_t rowsP50 = 0;
+    uint64_t rowsMax = 0;
+    uint64_t bytes = 0;  // total cell data returned (queries) or sent (bulk inserts)
+    uint64_t bytesP50 = 0;
+    uint64_t bytesMax = 0;
+};
+
+// Process-wide per-statement stats fed by every InstrumentedDatabase, and
+// the slow-query log. Configured from the environment on first use:
+//   DEX_SLOW_QUERY_MS   threshold for the slow-query log (off when unset or <= 0)
+//   DEX_SLOW_QUERY_LOG  file the slow-query log is appended to (default stderr)
+//   DEX_DB_STATS        "1"/"true" dumps the stats to stderr at exit; any other
+//                       value is a file to write them to
+class DatabaseStats {
+public:
+    struct Entry {
+        std::string statement;
+        std::atomic<uint64_t> errors{0};
+        Histogram latencyNanos;
+        Histogram rows;
+        Histogram bytes;
+    };
+
+    static DatabaseStats& instance();
+
+    // Stats of `fingerprint`; the reference stays valid for the process
+    // lifetime (reset() zeroes entries rather than freeing them). Past
+    // maxStatements distinct shapes, new ones share one overflow entry.
+    Entry& entry(const std::string& fingerprint);
+
+    // Records one statement. Logs it when it took at least the slow-query
+    // threshold, with `sql`, `params` (if any) and the script line.
+    void record(Entry& e, double seconds, uint64_t rows, uint64_t bytes, bool ok, const std::string& sql,
+                const SqlParams* params = nullptr);
+
+    // Slow-query threshold in milliseconds; <= 0 turns the log off.
+    void setSlowThreshold(double ms);
+    double slowThreshold() const { return slowMs.load(std::memory_order_relaxed); }
+    // Appends the slow-query log to `path` instead of stderr ("" for stderr).
+    // Returns false if the file can't be opened.
+    bool setSlowLog(const std::string& path);
+    // Dump the stats at exit to `path` ("" for stderr), or not at all.
+    void dumpAtExit(bool enabled, const std::string& path = "");
+
+    // Every statement shape that has run, slowest total time first.
+    std::vector<StatementSummary> snapshot() const;
+    void reset();
+    // Human-readable table of snapshot().
+    void dump(std::ostream& out) const;
+
+    static constexpr size_t maxStatements = 2000;
+
+private:
+    DatabaseStats();
+
+    mutable std::mutex mutex; // guards entries and the log/dump settings
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries;
+    std::atomic<double> slowMs{0.0};
+    std::unique_ptr<std::ostream> slowLog; // null: stderr
+    bool dumpEnabled = false;
+    std::string dumpPath;
+    bool exitHookInstalled = false;
+
+    static void dumpOnExit();
+};
+
+// Database decorator that times every statement run through it and feeds
+// DatabaseStats: plain and prepared statements, cursors (from open until
+// the cursor is destroyed, with the rows and bytes fetched), async queries
+// (from issue until the result is collected), batches (the batch's time
+// split evenly over its statements), bulk inserts and transaction control.
+// Errors are counted where the backend reports them (execute, batches,
+// bulk inserts, cursors); a failed query is indistinguishable from an
+// empty result and counts as a call.
+class InstrumentedDatabase : public Database {
+public:
+    explicit InstrumentedDatabase(std::unique_ptr<Database> inner);
+    ~InstrumentedDatabase() override;
+
+    using Database::execute;
+    using Database::query;
+
+    bool connect(const std::string& connStr) override { return inner->connect(connStr); }
+    bool execute(const std::string& sql) override;
+    QueryResult query(const std::string& sql) override;
+    void close() override;
+    bool ping() override { return inner->ping(); }
+    char statementHandle() const override { return inner->statementHandle(); }
+    std::shared_ptr<PreparedStatement> prepare(const std::string& sql) override;
+    std::unique_ptr<Cursor> cursor(const std::string& sql, const SqlParams& params) override;
+    bool executeBatch(const std::vector<BatchStatement>& statements) override;
+    std::unique_ptr<QueryFuture> queryAsync(const std::string& sql, const SqlParams& params) override;
+    bool registerTable(const std::string& name, std::shared_ptr<const Table> table) override {
+        return inner->registerTable(name, std::move(table));
+    }
+
+    Database& wrapped() const { return *inner; }
+
+protected:
+    bool beginTransaction() override;
+    bool commitTransaction() override;
+    bool rollbackTransaction() override;
+    bool insertRows(const std::string& table, const std::vector<std::string>& columns,
+                    const std::vector<SqlParams>& rows) override;
+
+private:
+    std::unique_ptr<Database> inner;
+    DatabaseStats& stats;
+};
+
+// Result payload size used for the bytes stats: cell data, not bookkeeping.
+uint64_t resultPayloadBytes(const QueryResult& result);
+
+} // namespace dex
+
+#endif // DEX_INSTRUMENTED_DATABASE_H
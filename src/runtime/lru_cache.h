@@ -0,0 +1,122 @@
+// src/runtime/lru_cache.h
+#ifndef DEX_LRU_CACHE_H
+#define DEX_LRU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace dex {
+
+// Least-recently-used map bounded by a total cost (entry count when every
+// cost is 1, bytes when callers pass sizes). Not thread-safe: owners guard
+// it with their own mutex. The eviction callback runs for entries pushed out
+// by capacity, not for explicit erase()/clear().
+template <typename K, typename V, typename Hash = std::hash<K>>
+class LruCache {
+public:
+    using EvictFn = std::function<void(const K&, V&)>;
+
+    explicit LruCache(size_t capacity = 0) : capacity_(capacity) {}
+
+    // Returns the value and marks it most recently used, or nullptr.
+    V* get(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) return nullptr;
+        order.splice(order.begin(), order, it->second);
+        return &it->second->value;
+    }
+
+    // Looks up without touching recency.
+    V* peek(const K& key) {
+        auto it = index.find(key);
+        return it == index.end() ? nullptr : &it->second->value;
+    }
+
+    // Inserts or replaces. An entry costing more than the whole capacity is
+    // not stored (returns false).
+    bool put(const K& key, V value, size_t cost = 1) {
+        erase(key);
+        if (cost > capacity_) return false;
+        order.push_front(Node{key, std::move(value), cost});
+        index.emplace(key, order.begin());
+        total += cost;
+        trim();
+        return true;
+    }
+
+    bool erase(const K& key) {
+        auto it = index.find(key);
+        if (it == index.end()) return false;
+        total -= it->second->cost;
+        order.erase(it->second);
+        index.erase(it);
+        return true;
+    }
+
+    // Erases every entry for which pred(key, value) is true.
+    template <typename Pred>
+    size_t eraseIf(Pred pred) {
+        size_t n = 0;
+        for (auto it = order.begin(); it != order.end();) {
+            if (pred(it->key, it->value)) {
+                total -= it->cost;
+                index.erase(it->key);
+                it = order.erase(it);
+                ++n;
+            } else {
+                ++it;
+            }
+        }
+        return n;
+    }
+
+    void clear() {
+        order.clear();
+        index.clear();
+        total = 0;
+    }
+
+    void setCapacity(size_t capacity) {
+        capacity_ = capacity;
+        trim();
+    }
+    void onEvict(EvictFn fn) { evictFn = std::move(fn); }
+
+    size_t size() const { return index.size(); }
+    size_t cost() const { return total; }
+    size_t capacity() const { return capacity_; }
+    uint64_t evictions() const { return evicted; }
+
+private:
+    struct Node {
+        K key;
+        V value;
+        size_t cost;
+    };
+
+    std::list<Node> order; // front = most recently used
+    std::unordered_map<K, typename std::list<Node>::iterator, Hash> index;
+    size_t capacity_;
+    size_t total = 0;
+    uint64_t evicted = 0;
+    EvictFn evictFn;
+
+    void trim() {
+        while (total > capacity_ && !order.empty()) {
+            Node& victim = order.back();
+            if (evictFn) evictFn(victim.key, victim.value);
+            total -= victim.cost;
+            index.erase(victim.key);
+            order.pop_back();
+            ++evicted;
+        }
+    }
+};
+
+} // namespace dex
+
+#endif // DEX_LRU_CACHE_H
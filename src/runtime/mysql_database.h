@@ -1,31 +1,66 @@
-// src/runtime/mysql_database.h
-#ifndef DEX_MYSQL_DATABASE_H
-#define DEX_MYSQL_DATABASE_H
-
-#include "database.h"
-#include <memory>
-#include <mysql_driver.h>
-#include <mysql_connection.h>
-#include <cppconn/statement.h>
-#include <cppconn/resultset.h>
-
-namespace dex {
-
-class MySQLDatabase : public Database {
-public:
-    MySQLDatabase();
-    ~MySQLDatabase() override;
-
-    bool connect(const std::string& connStr) override;
-    bool execute(const std::string& query) override;
-    QueryResult query(const std::string& query) override;
-    void close() override;
-
-private:
-    sql::mysql::MySQL_Driver* driver = nullptr;
-    std::unique_ptr<sql::Connection> conn;
-};
-
-} // namespace dex
-
-#endif
+// src/runtime/mysql_database.h
+#ifndef DEX_MYSQL_DATABASE_H
+#define DEX_MYSQL_DATABASE_H
+
+#include "database.h"
+#include <memory>
+#include <mysql_driver.h>
+#include <mysql_connection.h>
+#include <cppconn/statement.h>
+#include <cppconn/resultset.h>
+#include <cppconn/prepared_statement.h>
+
+namespace dex {
+
+class MySQLDatabase : public Database {
+public:
+    MySQLDatabase();
+    ~MySQLDatabase() override;
+
+    using Database::execute;
+    using Database::query;
+
+    bool connect(const std::string& connStr) override;
+    bool execute(const std::string& query) override;
+    QueryResult query(const std::string& query) override;
+    void close() override;
+    std::shared_ptr<PreparedStatement> prepare(const std::string& sql) override;
+    std::unique_ptr<Cursor> cursor(const std::string& sql, const SqlParams& params) override;
+    bool ping() override;
+
+protected:
+    bool insertRows(const std::string& table, const std::vector<std::string>& columns,
+                    const std::vector<SqlParams>& rows) override;
+    // Transactions switch autocommit off and back on through the connector,
+    // so it knows a transaction is open (bulkInsert relies on that).
+    bool beginTransaction() override;
+    bool commitTransaction() override;
+    bool rollbackTransaction() override;
+
+private:
+    sql::mysql::MySQL_Driver* driver = nullptr;
+    std::unique_ptr<sql::Connection> conn;
+};
+
+class MySQLPreparedStatement : public PreparedStatement {
+public:
+    MySQLPreparedStatement(std::unique_ptr<sql::PreparedStatement> statement, std::string sqlText)
+        : stmt(std::move(statement)), text(std::move(sqlText)) {}
+
+    bool execute(const SqlParams& params) override;
+    QueryResult query(const SqlParams& params) override;
+    const std::string& sql() const override { return text; }
+
+private:
+    std::unique_ptr<sql::PreparedStatement> stmt;
+    std::string text;
+
+    void bind(const SqlParams& params);
+};
+
+// Drains a Connector/C++ result set into a typed QueryResult.
+QueryResult readResultSet(sql::ResultSet& res);
+
+} // namespace dex
+
+#endif
@@ -0,0 +1,615 @@
+// src/runtime/pipeline.cpp
+#include "pipeline.h"
+#include "csv_reader.h"
+#include "csv_writer.h"
+#include "spsc_queue.h"
+#include "table.h" // formatDouble
+#include "value_codec.h"
+#include "../../external/nlohmann/json_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace dex {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// State shared by the stages of one load.
+struct Run {
+    std::atomic<bool> stop{false};
+    std::mutex errorMutex;
+    std::string error;
+    // Set by the parser before it queues the first batch; the queues order
+    // that write before any read by later stages.
+    std::vector<std::string> columns;
+
+    void fail(const std::string& message) {
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (error.empty()) error = message;
+        }
+        stop.store(true);
+    }
+};
+
+// Wall time of a stage minus the time it spent blocked on its queues.
+struct StageTimer {
+    StageMetrics& metrics;
+    Clock::time_point start = Clock::now();
+
+    ~StageTimer() {
+        metrics.busySeconds =
+            std::max(0.0, secondsSince(start) - metrics.waitInSeconds - metrics.waitOutSeconds);
+    }
+};
+
+template <typename T>
+bool timedPop(SpscQueue<T>& q, T& out, Run& run, StageMetrics& m) {
+    auto start = Clock::now();
+    bool ok = q.pop(out, run.stop);
+    m.waitInSeconds += secondsSince(start);
+    return ok;
+}
+
+template <typename T>
+bool timedPush(SpscQueue<T>& q, T item, Run& run, StageMetrics& m) {
+    auto start = Clock::now();
+    bool ok = q.push(std::move(item), run.stop);
+    m.waitOutSeconds += secondsSince(start);
+    return ok;
+}
+
+// Text cell as a statement parameter: empty is NULL, canonical integers
+// ("42", "-7") are int64, anything else stays text.
+SqlValue typedCell(const std::string& s) {
+    if (s.empty()) return nullptr;
+    char* end = nullptr;
+    errno = 0;
+    long long n = std::strtoll(s.c_str(), &end, 10);
+    if (errno == 0 && *end == '\0' && std::to_string(n) == s) return static_cast<int64_t>(n);
+    return s;
+}
+
+SqlValue jsonCell(const json& j) {
+    switch (j.type()) {
+    case json::value_t::null: return nullptr;
+    case json::value_t::boolean: return static_cast<int64_t>(j.get<bool>() ? 1 : 0);
+    case json::value_t::number_integer: return j.get<int64_t>();
+    case json::value_t::number_unsigned: {
+        uint64_t u = j.get<uint64_t>();
+        if (u <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) return static_cast<int64_t>(u);
+        return std::to_string(u);
+    }
+    case json::value_t::number_float: return j.get<double>();
+    case json::value_t::string: return j.get<std::string>();
+    default: return j.dump();
+    }
+}
+
+// The reader's chunks as a ByteSource for the parser. Time blocked on the
+// queue is charged to the parser's waitIn.
+class QueueSource : public ByteSource {
+public:
+    QueueSource(SpscQueue<std::string>& chunks, Run& run, StageMetrics& metrics)
+        : chunks(chunks), run(run), metrics(metrics) {}
+
+    size_t read(char* buf, size_t n) override {
+        while (pos == chunk.size()) {
+            if (!timedPop(chunks, chunk, run, metrics)) return 0; // end of input, or stopped
+            pos = 0;
+            metrics.bytes += chunk.size();
+        }
+        size_t k = std::min(n, chunk.size() - pos);
+        std::memcpy(buf, chunk.data() + pos, k);
+        pos += k;
+        return k;
+    }
+
+private:
+    SpscQueue<std::string>& chunks;
+    Run& run;
+    StageMetrics& metrics;
+    std::string chunk;
+    size_t pos = 0;
+};
+
+void readStage(const std::string& path, const LoadOptions& options, SpscQueue<std::string>& out, Run& run,
+               StageMetrics& m) {
+    StageTimer timer{m};
+    try {
+        auto source = openSource(path, options.compression);
+        for (;;) {
+            std::string chunk(options.chunkBytes, '\0');
+            size_t n = source->read(&chunk[0], chunk.size());
+            if (n == 0) break;
+            chunk.resize(n);
+            ++m.items;
+            m.bytes += n;
+            if (!timedPush(out, std::move(chunk), run, m)) break;
+        }
+    } catch (const std::exception& e) {
+        run.fail(std::string("read: ") + e.what());
+    }
+    out.close();
+}
+
+// Queues `batch` once it holds batchRows rows (or unconditionally with
+// `flush`). False when the load was stopped.
+bool emit(RowBatch& batch, bool flush, const LoadOptions& options, SpscQueue<RowBatch>& out, Run& run,
+          StageMetrics& m) {
+    if (batch.rows.empty() || (!flush && batch.rows.size() < options.batchRows)) return true;
+    ++m.items;
+    m.rows += batch.rows.size();
+    RowBatch full;
+    full.rows.reserve(options.batchRows);
+    std::swap(full, batch);
+    return timedPush(out, std::move(full), run, m);
+}
+
+void parseCSV(std::unique_ptr<ByteSource> input, const LoadOptions& options, SpscQueue<RowBatch>& out, Run& run,
+              StageMetrics& m) {
+    CSVOptions csv;
+    csv.delimiter = options.delimiter;
+    csv.quote = options.quote;
+    csv.header = options.header;
+    csv.bufferSize = options.chunkBytes;
+    csv.compression = Compression::None; // the reader stage already decoded it
+    CSVReader reader(std::move(input), csv);
+
+    // Source position of each target column
+    std::vector<size_t> fields;
+    if (!options.columns.empty()) {
+        run.columns = options.columns;
+        for (size_t i = 0; i < options.columns.size(); ++i) {
+            if (!options.header) {
+                fields.push_back(i);
+                continue;
+            }
+            auto it = std::find(reader.header().begin(), reader.header().end(), options.columns[i]);
+            if (it == reader.header().end()) {
+                throw std::runtime_error("column '" + options.columns[i] + "' is not in the header");
+            }
+            fields.push_back(static_cast<size_t>(it - reader.header().begin()));
+        }
+    } else if (options.header && !reader.header().empty()) {
+        run.columns = reader.header();
+        for (size_t i = 0; i < run.columns.size(); ++i) fields.push_back(i);
+    } else if (!options.header) {
+        throw std::runtime_error("the columns option is required for a CSV file without a header");
+    }
+
+    RowBatch batch;
+    batch.rows.reserve(options.batchRows);
+    std::vector<std::string> row;
+    while (reader.readRow(row)) {
+        SqlParams params;
+        params.reserve(fields.size());
+        for (size_t f : fields) params.push_back(f < row.size() ? typedCell(row[f]) : SqlValue(nullptr));
+        batch.rows.push_back(std::move(params));
+        if (!emit(batch, false, options, out, run, m)) return;
+    }
+    emit(batch, true, options, out, run, m);
+}
+
+void parseJSONL(ByteSource& input, const LoadOptions& options, SpscQueue<RowBatch>& out, Run& run, StageMetrics& m) {
+    RowBatch batch;
+    batch.rows.reserve(options.batchRows);
+    bool haveColumns = !options.columns.empty();
+    if (haveColumns) run.columns = options.columns;
+
+    std::string pending; // bytes after the last complete line
+    std::vector<char> buf(std::max<size_t>(options.chunkBytes, 4096));
+    size_t lineNo = 0;
+    auto parseLine = [&](const char* p, size_t n) {
+        ++lineNo;
+        while (n && (p[n - 1] == '\r' || p[n - 1] == ' ' || p[n - 1] == '\t')) --n;
+        if (n == 0) return;
+        json j;
+        try {
+            j = parseJSON(p, n);
+        } catch (const std::exception& e) {
+            throw std::runtime_error("line " + std::to_string(lineNo) + ": " + e.what());
+        }
+        if (!j.is_object()) throw std::runtime_error("line " + std::to_string(lineNo) + " is not a JSON object");
+        if (!haveColumns) {
+            for (const auto& item : j.items()) run.columns.push_back(item.key());
+            haveColumns = true;
+        }
+        SqlParams params;
+        params.reserve(run.columns.size());
+        for (const auto& name : run.columns) {
+            auto it = j.find(name);
+            params.push_back(it == j.end() ? SqlValue(nullptr) : jsonCell(*it));
+        }
+        batch.rows.push_back(std::move(params));
+    };
+
+    for (;;) {
+        size_t n = input.read(buf.data(), buf.size());
+        if (n == 0) break;
+        const char* p = buf.data();
+        const char* end = p + n;
+        while (const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)))) {
+            if (pending.empty()) {
+                parseLine(p, static_cast<size_t>(nl - p));
+            } else {
+                pending.append(p, nl);
+                parseLine(pending.data(), pending.size());
+                pending.clear();
+            }
+            p = nl + 1;
+            if (!emit(batch, false, options, out, run, m)) return;
+        }
+        pending.append(p, end);
+    }
+    if (!pending.empty()) parseLine(pending.data(), pending.size());
+    emit(batch, true, options, out, run, m);
+}
+
+void parseStage(const LoadOptions& options, SpscQueue<std::string>& in, SpscQueue<RowBatch>& out, Run& run,
+                StageMetrics& m) {
+    StageTimer timer{m};
+    try {
+        auto input = std::make_unique<QueueSource>(in, run, m);
+        if (options.format == SourceFormat::CSV) {
+            parseCSV(std::move(input), options, out, run, m);
+        } else {
+            parseJSONL(*input, options, out, run, m);
+        }
+    } catch (const std::exception& e) {
+        run.fail(std::string("parse: ") + e.what());
+    }
+    out.close();
+}
+
+void writeStage(Database& db, const std::string& table, const LoadOptions& options, SpscQueue<RowBatch>& in,
+                Run& run, StageMetrics& m) {
+    StageTimer timer{m};
+    bool began = false;
+    try {
+        if (options.atomic && !db.inTransaction()) {
+            began = db.begin();
+            if (!began) run.fail("write: could not begin a transaction");
+        }
+        RowBatch batch;
+        while (!run.stop.load() && timedPop(in, batch, run, m)) {
+            if (batch.rows.empty()) continue;
+            BulkInsertResult r = db.bulkInsert(table, run.columns, batch.rows);
+            if (!r.ok) {
+                run.fail("write: bulk insert into " + table + " failed");
+                break;
+            }
+            ++m.items;
+            m.rows += r.rows;
+        }
+    } catch (const std::exception& e) {
+        run.fail(std::string("write: ") + e.what());
+    }
+    if (began) {
+        if (run.stop.load()) {
+            db.rollback();
+        } else if (!db.commit()) {
+            run.fail("write: commit failed");
+        }
+    }
+}
+
+// `path` without a trailing compression suffix.
+std::string withoutCompressionSuffix(const std::string& path) {
+    for (const char* ext : {".gz", ".gzip", ".zst", ".zstd"}) {
+        if (endsWith(path, ext)) return path.substr(0, path.size() - std::strlen(ext));
+    }
+    return path;
+}
+
+// Passes writes through to the file (or compressor), counting the bytes.
+class CountingSink : public ByteSink {
+public:
+    explicit CountingSink(ByteSink& target) : target(target) {}
+
+    void write(const char* data, size_t n) override {
+        bytes += n;
+        target.write(data, n);
+    }
+    void finish() override { target.finish(); }
+
+    uint64_t bytes = 0;
+
+private:
+    ByteSink& target;
+};
+
+std::string_view intText(char (&buf)[24], int64_t v) {
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    return std::string_view(buf, static_cast<size_t>(res.ptr - buf));
+}
+
+void appendJSONString(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    out.push_back('"');
+    size_t run = 0; // start of the pending run of bytes that need no escaping
+    for (size_t i = 0; i < s.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.append(s.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            out += "\\u00";
+            out.push_back(hex[c >> 4]);
+            out.push_back(hex[c & 15]);
+        }
+    }
+    out.append(s.data() + run, s.size() - run);
+    out.push_back('"');
+}
+
+// Serializes fetched batches to `sink`. The text formats buffer up to
+// bufferSize bytes between writes; CSV goes through CSVWriter's buffer.
+class RowSerializer {
+public:
+    RowSerializer(ByteSink& sink, const ExportOptions& options) : sink(sink), options(options) {
+        if (options.format == ExportFormat::CSV) {
+            csv = std::make_unique<CSVWriter>(sink, options.bufferSize, options.delimiter);
+        } else {
+            buf.reserve(options.bufferSize + 4096);
+        }
+        if (options.format == ExportFormat::Binary) valuecodec::writeHeader(buf);
+    }
+
+    // Called with the first batch, which carries the column names even when
+    // empty. They are the schema every later batch must match.
+    void begin(const QueryResult& result) {
+        for (const auto& c : result.columns) names.push_back(c.name);
+        switch (options.format) {
+        case ExportFormat::CSV:
+            if (options.header) {
+                for (const auto& name : names) csv->writeField(name);
+                csv->endRow();
+            }
+            break;
+        case ExportFormat::JSONL:
+            for (size_t i = 0; i < names.size(); ++i) {
+                std::string key = i ? "," : "{";
+                appendJSONString(key, names[i]);
+                key.push_back(':');
+                keys.push_back(std::move(key));
+            }
+            break;
+        case ExportFormat::Binary:
+            valuecodec::writeArrayHeader(buf, names.size());
+            for (const auto& name : names) valuecodec::writeText(buf, name);
+            break;
+        }
+    }
+
+    // Throws std::runtime_error if `result` has rows but not the columns
+    // begin() saw.
+    void write(const QueryResult& result) {
+        if (result.rowCount == 0) return;
+        if (result.columns.size() != names.size()) {
+            throw std::runtime_error("a batch has " + std::to_string(result.columns.size()) +
+                                     " columns, the first had " + std::to_string(names.size()));
+        }
+        char num[24];
+        for (size_t r = 0; r < result.rowCount; ++r) {
+            switch (options.format) {
+            case ExportFormat::CSV:
+                for (const auto& c : result.columns) {
+                    if (c.isNull(r)) {
+                        csv->writeRawField("");
+                    } else if (c.type == SqlType::Integer) {
+                        csv->writeRawField(intText(num, c.ints[r]));
+                    } else if (c.type == SqlType::Real) {
+                        csv->writeRawField(formatDouble(c.reals[r]));
+                    } else if (c.text(r).empty()) {
+                        csv->writeRawField("\"\""); // unlike NULL's bare empty field
+                    } else {
+                        csv->writeField(c.text(r));
+                    }
+                }
+                csv->endRow();
+                break;
+            case ExportFormat::JSONL:
+                if (keys.empty()) buf.push_back('{');
+                for (size_t i = 0; i < result.columns.size(); ++i) {
+                    const ResultColumn& c = result.columns[i];
+                    buf += keys[i];
+                    if (c.isNull(r) || (c.type == SqlType::Real && !std::isfinite(c.reals[r]))) {
+                        buf += "null";
+                    } else if (c.type == SqlType::Integer) {
+                        buf += intText(num, c.ints[r]);
+                    } else if (c.type == SqlType::Real) {
+                        buf += formatDouble(c.reals[r]);
+                    } else {
+                        appendJSONString(buf, c.text(r));
+                    }
+                }
+                buf += "}\n";
+                break;
+            case ExportFormat::Binary:
+                valuecodec::writeArrayHeader(buf, result.columns.size());
+                for (const auto& c : result.columns) {
+                    if (c.isNull(r)) {
+                        valuecodec::writeNull(buf);
+                    } else if (c.type == SqlType::Integer) {
+                        valuecodec::writeInteger(buf, c.ints[r]);
+                    } else if (c.type == SqlType::Real) {
+                        valuecodec::writeReal(buf, c.reals[r]);
+                    } else {
+                        valuecodec::writeText(buf, c.text(r));
+                    }
+                }
+                break;
+            }
+            if (buf.size() >= options.bufferSize) drain();
+        }
+    }
+
+    void finish() {
+        if (csv) csv->flush();
+        drain();
+        sink.finish();
+    }
+
+private:
+    ByteSink& sink;
+    const ExportOptions& options;
+    std::unique_ptr<CSVWriter> csv;
+    std::string buf;
+    std::vector<std::string> names; // from the first batch
+    std::vector<std::string> keys;  // JSONL: `{"name":` / `,"name":` per column
+
+    void drain() {
+        if (buf.empty()) return;
+        sink.write(buf.data(), buf.size());
+        buf.clear();
+    }
+};
+
+} // namespace
+
+SourceFormat sourceFormatFor(const std::string& path) {
+    std::string base = withoutCompressionSuffix(path);
+    return endsWith(base, ".jsonl") || endsWith(base, ".ndjson") ? SourceFormat::JSONL : SourceFormat::CSV;
+}
+
+ExportFormat exportFormatFor(const std::string& path) {
+    std::string base = withoutCompressionSuffix(path);
+    if (endsWith(base, ".dexv")) return ExportFormat::Binary;
+    return endsWith(base, ".jsonl") || endsWith(base, ".ndjson") ? ExportFormat::JSONL : ExportFormat::CSV;
+}
+
+LoadReport loadFile(const std::string& path, Database& db, const std::string& table, const LoadOptions& opts,
+                    const BatchTransform& transform) {
+    LoadOptions options = opts;
+    options.batchRows = std::max<size_t>(options.batchRows, 1);
+    options.chunkBytes = std::max<size_t>(options.chunkBytes, 4096);
+
+    const auto start = Clock::now();
+    Run run;
+    LoadReport report;
+    report.stages.resize(4);
+    StageMetrics& readM = report.stages[0];
+    StageMetrics& parseM = report.stages[1];
+    StageMetrics& transformM = report.stages[2];
+    StageMetrics& writeM = report.stages[3];
+    readM.name = "read";
+    parseM.name = "parse";
+    transformM.name = "transform";
+    writeM.name = "write";
+
+    SpscQueue<std::string> chunks(options.queueDepth);
+    SpscQueue<RowBatch> parsed(options.queueDepth);
+    SpscQueue<RowBatch> ready(options.queueDepth);
+
+    std::thread reader([&] { readStage(path, options, chunks, run, readM); });
+    std::thread parser([&] { parseStage(options, chunks, parsed, run, parseM); });
+    std::thread writer([&] { writeStage(db, table, options, ready, run, writeM); });
+
+    // Transform stage: here, so the callback runs on the interpreter's thread
+    std::exception_ptr thrown;
+    {
+        StageTimer timer{transformM};
+        RowBatch batch;
+        while (timedPop(parsed, batch, run, transformM)) {
+            std::string error;
+            try {
+                if (transform && !transform(run.columns, batch, error)) {
+                    run.fail("transform: " + error);
+                    break;
+                }
+            } catch (...) {
+                thrown = std::current_exception();
+                run.fail("transform: callback failed");
+                break;
+            }
+            ++transformM.items;
+            transformM.rows += batch.rows.size();
+            if (!timedPush(ready, std::move(batch), run, transformM)) break;
+        }
+        ready.close();
+    }
+
+    reader.join();
+    parser.join();
+    writer.join();
+    if (thrown) std::rethrow_exception(thrown);
+
+    report.seconds = secondsSince(start);
+    report.rows = writeM.rows;
+    report.error = run.error;
+    report.ok = run.error.empty();
+    return report;
+}
+
+ExportReport exportQuery(Database& db, const std::string& sql, const SqlParams& params, const std::string& path,
+                         const ExportOptions& opts) {
+    ExportOptions options = opts;
+    options.batchRows = std::max<size_t>(options.batchRows, 1);
+    options.bufferSize = std::max<size_t>(options.bufferSize, 4096);
+
+    ExportReport report;
+    auto start = Clock::now();
+    const std::string partial = path + ".part";
+    try {
+        std::unique_ptr<Cursor> cursor = db.cursor(sql, params);
+        if (!cursor) throw std::runtime_error("could not run the query");
+        // Compression follows the final name, not the temporary one
+        auto file = openSink(partial, resolveCompression(options.compression, path));
+        CountingSink counted(*file);
+        RowSerializer out(counted, options);
+        bool first = true;
+        do {
+            QueryResult batch = cursor->fetch(options.batchRows);
+            if (cursor->failed()) throw std::runtime_error("the query failed while reading rows");
+            if (first && !batch.columns.empty()) {
+                out.begin(batch);
+                first = false;
+            }
+            out.write(batch);
+            report.rows += batch.rowCount;
+        } while (!cursor->exhausted());
+        out.finish();
+        report.bytes = counted.bytes;
+        if (std::rename(partial.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("cannot rename " + partial + " to " + path + ": " + std::strerror(errno));
+        }
+        report.ok = true;
+    } catch (const std::exception& e) {
+        std::remove(partial.c_str());
+        report.error = e.what();
+        report.rows = 0;
+    }
+    report.seconds = secondsSince(start);
+    return report;
+}
+
+} // namespace dex
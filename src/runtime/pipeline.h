@@ -0,0 +1,119 @@
+// src/runtime/pipeline.h
+#ifndef DEX_PIPELINE_H
+#define DEX_PIPELINE_H
+
+#include "compression.h"
+#include "database.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dex {
+
+enum class SourceFormat { CSV, JSONL };
+
+// JSONL for .jsonl/.ndjson (before any .gz/.zst suffix), CSV otherwise.
+SourceFormat sourceFormatFor(const std::string& path);
+
+struct LoadOptions {
+    SourceFormat format = SourceFormat::CSV;
+    Compression compression = Compression::Auto;
+    char delimiter = ',';           // CSV only
+    char quote = '"';               // CSV only
+    bool header = true;             // CSV only: first row names the columns
+    // Target columns. CSV: picked from the header by name (or named in
+    // order when there is no header); JSONL: keys read from each object.
+    // Defaults to the header / the first object's keys.
+    std::vector<std::string> columns;
+    size_t batchRows = 5000;        // rows per bulk insert
+    size_t queueDepth = 8;          // chunks / batches buffered between two stages
+    size_t chunkBytes = 1 << 20;    // read size
+    bool atomic = true;             // one transaction around the whole load
+};
+
+// Rows travelling between stages, already typed for Database::bulkInsert.
+struct RowBatch {
+    std::vector<SqlParams> rows;
+};
+
+struct StageMetrics {
+    std::string name;
+    uint64_t items = 0;          // chunks (read) or batches (other stages)
+    uint64_t rows = 0;
+    uint64_t bytes = 0;
+    double busySeconds = 0.0;    // time spent working
+    double waitInSeconds = 0.0;  // starved, waiting for the previous stage
+    double waitOutSeconds = 0.0; // backpressure, waiting for the next stage
+};
+
+struct LoadReport {
+    bool ok = false;
+    std::string error;
+    size_t rows = 0;
+    double seconds = 0.0;
+    std::vector<StageMetrics> stages; // read, parse, transform, write
+
+    double rowsPerSecond() const { return seconds > 0.0 ? static_cast<double>(rows) / seconds : 0.0; }
+};
+
+// Rewrites one batch in place; every row must keep one value per column.
+// Return false with `error` set to abort the load.
+using BatchTransform =
+    std::function<bool(const std::vector<std::string>& columns, RowBatch& batch, std::string& error)>;
+
+// Streams the CSV or JSONL file at `path` into `table`. Reading (with
+// decompression), parsing and bulk writing each run on their own thread,
+// joined by bounded SPSC queues so a slow stage holds the others back
+// instead of buffering the file. `transform` runs on the calling thread, so
+// it may call into the interpreter. CSV cells and transformed values bind
+// as int64 when they are canonical integers, NULL when empty, text
+// otherwise; JSON values keep their type (booleans load as 1/0, nested
+// values as JSON text). `db` is used only by the writer thread until this
+// returns. With options.atomic the load is all or nothing, unless `db`
+// already has a transaction open, which the load then joins.
+// A throwing transform stops the load (rolling it back) and is rethrown.
+LoadReport loadFile(const std::string& path, Database& db, const std::string& table, const LoadOptions& options,
+                    const BatchTransform& transform = nullptr);
+
+enum class ExportFormat { CSV, JSONL, Binary };
+
+// Binary for .dexv, JSONL for .jsonl/.ndjson (before any .gz/.zst suffix), CSV otherwise.
+ExportFormat exportFormatFor(const std::string& path);
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::CSV;
+    Compression compression = Compression::Auto;
+    char delimiter = ',';           // CSV only
+    bool header = true;             // CSV only: first row names the columns
+    size_t batchRows = 1024;        // rows per cursor fetch
+    size_t bufferSize = 1 << 20;    // serialized bytes buffered per write
+};
+
+struct ExportReport {
+    bool ok = false;
+    std::string error;
+    size_t rows = 0;
+    uint64_t bytes = 0; // serialized, before compression
+    double seconds = 0.0;
+};
+
+// Streams the rows of `sql` from a cursor into the file at `path`, one
+// fetch of options.batchRows at a time, so memory stays flat however many
+// rows the query returns. Cells are serialized straight from the typed
+// result columns:
+//   CSV     header row of column names, NULL as an empty field and the
+//           empty string as "" (the convention of PostgreSQL's COPY CSV);
+//   JSONL   one object per row keyed by column name, numbers and NULL as
+//           JSON numbers and null (non-finite reals as null);
+//   Binary  the binary Value format (value_codec.h): an array of column
+//           names, then one array per row with integer, real, text or null cells.
+// Every batch must have the columns of the first; the export fails otherwise.
+// The file is written under a temporary name and renamed into place once
+// complete, so a failed export leaves nothing behind at `path`.
+ExportReport exportQuery(Database& db, const std::string& sql, const SqlParams& params, const std::string& path,
+                         const ExportOptions& options);
+
+} // namespace dex
+
+#endif // DEX_PIPELINE_H
@@ -1,27 +1,125 @@
-// src/runtime/postgres_database.h
-#ifndef DEX_POSTGRES_DATABASE_H
-#define DEX_POSTGRES_DATABASE_H
-
-#include "database.h"
-#include <memory>
-#include <pqxx/pqxx>
-
-namespace dex {
-
-class PostgresDatabase : public Database {
-public:
-    PostgresDatabase();
-    ~PostgresDatabase() override;
-
-    bool connect(const std::string& connStr) override;
-    bool execute(const std::string& query) override;
-    QueryResult query(const std::string& query) override;
-    void close() override;
-
-private:
-    std::unique_ptr<pqxx::connection> conn;
-};
-
-} // namespace dex
-
-#endif
+// src/runtime/postgres_database.h
+#ifndef DEX_POSTGRES_DATABASE_H
+#define DEX_POSTGRES_DATABASE_H
+
+#include "database.h"
+#include <functional>
+#include <memory>
+#include <pqxx/pqxx>
+#include <unordered_map>
+
+namespace dex {
+
+class PostgresDatabase : public Database {
+public:
+    PostgresDatabase();
+    ~PostgresDatabase() override;
+
+    using Database::execute;
+    using Database::query;
+
+    bool connect(const std::string& connStr) override;
+    bool execute(const std::string& query) override;
+    QueryResult query(const std::string& query) override;
+    void close() override;
+    std::shared_ptr<PreparedStatement> prepare(const std::string& sql) override;
+    std::unique_ptr<Cursor> cursor(const std::string& sql, const SqlParams& params) override;
+    bool executeBatch(const std::vector<BatchStatement>& statements) override;
+    // Queues the query on the connection's pipeline (pqxx::pipeline), which
+    // sends queued queries together and keeps them in flight while the
+    // script goes on. The first synchronous statement drains the pipeline.
+    std::unique_ptr<QueryFuture> queryAsync(const std::string& sql, const SqlParams& params) override;
+
+    // Reads every outstanding pipelined result (kept for its future) and
+    // closes the pipeline, so the connection can run other statements.
+    void finishPipeline();
+
+    // Runs `fn` inside the explicit transaction if one is open; otherwise in
+    // a transaction of its own that commits when `fn` returns, or, for
+    // `readOnly` work, in autocommit mode to save the BEGIN/COMMIT round trips.
+    // Exceptions from `fn` propagate.
+    void withTransaction(const std::function<void(pqxx::transaction_base&)>& fn, bool readOnly = false);
+    pqxx::connection& connection() { return *conn; }
+
+    // Rewrites `?` placeholders as $1, $2, ... so scripts can use the same
+    // SQL on every backend. Quoted literals and identifiers, E'' strings
+    // (with backslash escapes), $tag$ dollar quotes and -- and nested /* */
+    // comments are left alone. The jsonb ?| and ?& operators pass through;
+    // the jsonb ? operator is written `??`, since a lone `?` is a placeholder.
+    static std::string numberPlaceholders(const std::string& sql);
+    // Same scan, replacing the n-th placeholder (1-based) with replace(n).
+    static std::string replacePlaceholders(const std::string& sql, const std::function<std::string(int)>& replace);
+    // `sql` with its placeholders replaced by quoted literals, for
+    // statements that can't be sent with separate parameters.
+    static std::string inlineParams(const std::string& sql, const SqlParams& params, pqxx::transaction_base& tx);
+
+protected:
+    bool insertRows(const std::string& table, const std::vector<std::string>& columns,
+                    const std::vector<SqlParams>& rows) override;
+    bool beginTransaction() override;
+    bool commitTransaction() override;
+    bool rollbackTransaction() override;
+
+private:
+    friend class PostgresQueryFuture;
+
+    std::unique_ptr<pqxx::connection> conn;
+    std::shared_ptr<pqxx::work> txn; // open explicit transaction, if any; cursors in it hold weak_ptrs
+
+    // Async queries: the pipeline runs on the explicit transaction, or on
+    // asyncTx (autocommit) outside one.
+    std::unique_ptr<pqxx::nontransaction> asyncTx;
+    std::unique_ptr<pqxx::pipeline> pipe;
+    // Futures hold a ticket (unique per connection; pipeline query ids
+    // restart with each pipeline).
+    std::unordered_map<pqxx::pipeline::query_id, unsigned long> inFlight; // current pipeline's uncollected queries
+    std::unordered_map<unsigned long, QueryResult> drained;              // read by finishPipeline, not yet collected
+    unsigned long nextTicket = 0;
+
+    // Ticket's query id in the current pipeline, if it is still there.
+    bool pipelined(unsigned long ticket, pqxx::pipeline::query_id id) const;
+    unsigned long nextStatementId = 0;
+    unsigned long nextCursorId = 0;
+};
+
+class PostgresQueryFuture : public QueryFuture {
+public:
+    PostgresQueryFuture(PostgresDatabase& owner, unsigned long queryTicket, pqxx::pipeline::query_id queryId)
+        : db(owner), ticket(queryTicket), id(queryId) {}
+    ~PostgresQueryFuture() override;
+
+    bool ready() override;
+    QueryResult get() override;
+
+private:
+    PostgresDatabase& db;
+    unsigned long ticket;
+    pqxx::pipeline::query_id id;
+    bool collected = false;
+};
+
+class PostgresPreparedStatement : public PreparedStatement {
+public:
+    PostgresPreparedStatement(PostgresDatabase& owner, std::string statementName, std::string sqlText)
+        : db(owner), name(std::move(statementName)), text(std::move(sqlText)) {}
+    ~PostgresPreparedStatement() override;
+
+    bool execute(const SqlParams& params) override;
+    QueryResult query(const SqlParams& params) override;
+    const std::string& sql() const override { return text; }
+
+private:
+    PostgresDatabase& db;
+    std::string name;
+    std::string text;
+};
+
+// Converts a text-protocol pqxx result into a typed QueryResult.
+QueryResult readResult(const pqxx::result& res);
+
+// Converts positional parameters for pqxx::exec_prepared.
+pqxx::params toPqxxParams(const SqlParams& params);
+
+} // namespace dex
+
+#endif
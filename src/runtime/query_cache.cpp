@@ -0,0 +1,595 @@
+// src/runtime/query_cache.cpp
+#include "query_cache.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <unordered_set>
+
+namespace dex {
+
+namespace {
+
+// Rough per-entry bookkeeping (list node, hash slot, table list) so that
+// many tiny results still count against the budget.
+constexpr size_t kEntryOverhead = 256;
+
+// Pseudo-table read by entries that any write may change (they read a view).
+const std::string kAnyTable;
+
+struct Token {
+    enum Kind { Word, Quoted, Literal, Symbol } kind;
+    std::string text; // words lowercased, quoted identifiers unquoted
+};
+
+// Index just past the literal or quoted identifier opening at `i`
+// (a doubled closing character escapes it), or npos if it is unterminated.
+size_t skipQuoted(const std::string& sql, size_t i) {
+    const char close = sql[i] == '[' ? ']' : sql[i];
+    for (size_t j = i + 1; j < sql.size(); ++j) {
+        if (sql[j] != close) continue;
+        if (close != ']' && j + 1 < sql.size() && sql[j + 1] == close) {
+            ++j;
+            continue;
+        }
+        return j + 1;
+    }
+    return std::string::npos;
+}
+
+// Index just past the comment opening at `i`, or `i` if none opens there.
+size_t skipComment(const std::string& sql, size_t i) {
+    if (sql.compare(i, 2, "--") == 0) {
+        size_t end = sql.find('\n', i);
+        return end == std::string::npos ? sql.size() : end + 1;
+    }
+    if (sql.compare(i, 2, "/*") == 0) {
+        size_t end = sql.find("*/", i + 2);
+        return end == std::string::npos ? sql.size() : end + 2;
+    }
+    return i;
+}
+
+bool isQuote(char c) { return c == '\'' || c == '"' || c == '`' || c == '['; }
+bool isWordChar(char c) { return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$'; }
+
+// Splits SQL into tokens, dropping whitespace and comments. `complete` is
+// false if a literal or quoted identifier never closes.
+std::vector<Token> tokenize(const std::string& sql, bool& complete) {
+    std::vector<Token> out;
+    complete = true;
+    size_t i = 0;
+    while (i < sql.size()) {
+        const char c = sql[i];
+        size_t next = skipComment(sql, i);
+        if (next != i) {
+            i = next;
+        } else if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        } else if (isQuote(c)) {
+            size_t end = skipQuoted(sql, i);
+            if (end == std::string::npos) {
+                complete = false;
+                return out;
+            }
+            Token::Kind kind = c == '\'' ? Token::Literal : Token::Quoted;
+            std::string text = sql.substr(i + 1, end - i - 2);
+            for (auto& ch : text) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+            out.push_back(Token{kind, std::move(text)});
+            i = end;
+        } else if (isWordChar(c)) {
+            size_t end = i;
+            while (end < sql.size() && isWordChar(sql[end])) ++end;
+            std::string word = sql.substr(i, end - i);
+            for (auto& ch : word) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+            out.push_back(Token{Token::Word, std::move(word)});
+            i = end;
+        } else {
+            out.push_back(Token{Token::Symbol, std::string(1, c)});
+            ++i;
+        }
+    }
+    return out;
+}
+
+// `sql` with comments removed, whitespace runs collapsed to one space and
+// trailing semicolons dropped; literals and identifier case are kept.
+std::string normalize(const std::string& sql) {
+    std::string out;
+    out.reserve(sql.size());
+    bool space = false;
+    size_t i = 0;
+    while (i < sql.size()) {
+        size_t next = skipComment(sql, i);
+        if (next != i || std::isspace(static_cast<unsigned char>(sql[i]))) {
+            space = true;
+            i = next != i ? next : i + 1;
+            continue;
+        }
+        if (space && !out.empty()) out += ' ';
+        space = false;
+        if (isQuote(sql[i])) {
+            size_t end = skipQuoted(sql, i);
+            if (end == std::string::npos) end = sql.size();
+            out.append(sql, i, end - i);
+            i = end;
+        } else {
+            out += sql[i++];
+        }
+    }
+    while (!out.empty() && (out.back() == ';' || out.back() == ' ')) out.pop_back();
+    return out;
+}
+
+bool isOneOf(const std::string& word, std::initializer_list<const char*> words) {
+    for (const char* w : words) {
+        if (word == w) return true;
+    }
+    return false;
+}
+
+// Words that end a table reference instead of naming its alias.
+bool endsTableReference(const std::string& word) {
+    return isOneOf(word, {"where", "join", "inner", "left", "right", "full", "outer", "cross", "natural", "on",
+                          "using", "group", "order", "limit", "offset", "union", "intersect", "except", "having",
+                          "window", "set", "values", "returning", "select", "fetch", "for", "default", "as",
+                          "straight_join", "partition", "tablesample", "with"});
+}
+
+// Table names after FROM, JOIN, INTO, UPDATE, TABLE and TRUNCATE, lowercased
+// with any schema prefix dropped. Over-reports (e.g. `extract(year FROM ts)`
+// yields "ts"), which only makes invalidation more eager.
+std::vector<std::string> referencedTables(const std::vector<Token>& t) {
+    std::vector<std::string> tables;
+    for (size_t i = 0; i < t.size(); ++i) {
+        if (t[i].kind != Token::Word ||
+            !isOneOf(t[i].text, {"from", "join", "into", "update", "table", "truncate"})) {
+            continue;
+        }
+        const bool list = t[i].text == "from";
+        size_t j = i + 1;
+        while (j < t.size() && t[j].kind == Token::Word &&
+               isOneOf(t[j].text, {"table", "if", "not", "exists", "only", "ignore", "or"})) {
+            ++j;
+        }
+        while (j < t.size() && (t[j].kind == Token::Word || t[j].kind == Token::Quoted)) {
+            std::string name = t[j].text;
+            while (j + 2 < t.size() && t[j + 1].kind == Token::Symbol && t[j + 1].text == "." &&
+                   (t[j + 2].kind == Token::Word || t[j + 2].kind == Token::Quoted)) {
+                j += 2;
+                name = t[j].text;
+            }
+            tables.push_back(std::move(name));
+            ++j;
+            if (j < t.size() && t[j].kind == Token::Word && t[j].text == "as") ++j;
+            if (j < t.size() && (t[j].kind == Token::Quoted ||
+                                 (t[j].kind == Token::Word && !endsTableReference(t[j].text)))) {
+                ++j; // alias
+            }
+            if (!list || j >= t.size() || t[j].kind != Token::Symbol || t[j].text != ",") break;
+            ++j;
+        }
+        i = j > i ? j - 1 : i;
+    }
+    std::sort(tables.begin(), tables.end());
+    tables.erase(std::unique(tables.begin(), tables.end()), tables.end());
+    return tables;
+}
+
+// Date/time literals that mean the moment the statement runs (lowercased).
+bool isVolatileLiteral(const std::string& text) {
+    return isOneOf(text, {"now", "today", "tomorrow", "yesterday"});
+}
+
+// Last part of the possibly schema-qualified name starting at t[j], or ""
+// if none starts there. Leaves `j` just past it.
+std::string qualifiedName(const std::vector<Token>& t, size_t& j) {
+    std::string name;
+    while (j < t.size() && (t[j].kind == Token::Word || t[j].kind == Token::Quoted)) {
+        name = t[j++].text;
+        if (j + 1 >= t.size() || t[j].kind != Token::Symbol || t[j].text != ".") break;
+        ++j;
+    }
+    return name;
+}
+
+struct Analysis {
+    bool read = false;      // SELECT-like: writes nothing
+    bool control = false;   // transaction control or session statement: touches no rows
+    bool cacheable = false; // read whose result only depends on table contents
+    std::vector<std::string> tables; // read, or written (empty write = unknown, clear everything)
+    std::string view;         // CREATE VIEW: its name
+    std::string triggerTable; // CREATE TRIGGER: the table it is on
+};
+
+// Fills in a.view or a.triggerTable for CREATE VIEW / CREATE TRIGGER.
+void analyzeCreate(const std::vector<Token>& t, Analysis& a) {
+    for (size_t i = 1; i < t.size() && t[i].kind == Token::Word; ++i) {
+        if (t[i].text == "view") {
+            size_t j = i + 1;
+            while (j < t.size() && t[j].kind == Token::Word && isOneOf(t[j].text, {"if", "not", "exists"})) ++j;
+            a.view = qualifiedName(t, j);
+            return;
+        }
+        if (t[i].text == "trigger") {
+            for (size_t j = i + 1; j < t.size(); ++j) {
+                if (t[j].kind == Token::Word && t[j].text == "on") {
+                    ++j;
+                    a.triggerTable = qualifiedName(t, j);
+                    return;
+                }
+            }
+            return;
+        }
+        if (!isOneOf(t[i].text, {"or", "replace", "temp", "temporary", "materialized", "recursive", "constraint",
+                                 "definer", "algorithm", "sql", "security"})) {
+            return;
+        }
+    }
+}
+
+Analysis analyze(const std::string& sql) {
+    Analysis a;
+    bool complete;
+    std::vector<Token> t = tokenize(sql, complete);
+    if (t.empty() || t[0].kind != Token::Word) return a;
+
+    const std::string& verb = t[0].text;
+    if (isOneOf(verb, {"begin", "start", "commit", "end", "rollback", "savepoint", "release", "set", "pragma",
+                       "show", "explain", "describe", "desc", "vacuum", "analyze", "checkpoint"})) {
+        a.control = true;
+        return a;
+    }
+    if (!complete) return a;
+    if (verb == "create") {
+        analyzeCreate(t, a);
+        return a; // DDL: everything is invalidated
+    }
+
+    const bool readVerb = isOneOf(verb, {"select", "with", "values", "table"});
+    if (!readVerb && !isOneOf(verb, {"insert", "update", "delete", "replace", "truncate", "merge", "upsert"})) {
+        return a; // DDL and anything unrecognised: no table list, so everything is invalidated
+    }
+
+    bool writes = !readVerb;
+    bool isVolatile = false;
+    for (size_t i = 0; i < t.size(); ++i) {
+        if (t[i].kind != Token::Word) continue;
+        const bool call = i + 1 < t.size() && t[i + 1].kind == Token::Symbol && t[i + 1].text == "(";
+        const std::string& w = t[i].text;
+        if (!call && isOneOf(w, {"insert", "update", "delete", "into", "merge"})) writes = true;
+        if (isOneOf(w, {"random", "rand", "now", "current_timestamp", "current_date", "current_time",
+                        "localtime", "localtimestamp", "sysdate", "uuid", "gen_random_uuid", "nextval",
+                        "currval", "last_insert_rowid", "last_insert_id", "changes", "total_changes",
+                        "clock_timestamp", "statement_timestamp", "sleep", "pg_sleep", "randomblob"})) {
+            isVolatile = true;
+        }
+        if (w == "for" && i + 1 < t.size() && isOneOf(t[i + 1].text, {"update", "share", "no"})) {
+            isVolatile = true; // locking read
+        }
+    }
+    for (const auto& token : t) {
+        // datetime('now'), 'today'::date and friends
+        if (token.kind == Token::Literal && isVolatileLiteral(token.text)) isVolatile = true;
+    }
+    a.tables = referencedTables(t);
+    a.read = !writes;
+    a.cacheable = a.read && !isVolatile && !a.tables.empty();
+    return a;
+}
+
+std::string tableKey(const std::string& name) {
+    std::string key = name.substr(name.rfind('.') == std::string::npos ? 0 : name.rfind('.') + 1);
+    for (auto& ch : key) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    return key;
+}
+
+size_t resultBytes(const QueryResult& r) {
+    size_t n = sizeof(QueryResult);
+    for (const auto& c : r.columns) {
+        n += sizeof(ResultColumn) + c.name.size() + c.bytes.size();
+        n += (c.ints.size() + c.reals.size() + c.offsets.size() + c.validity.size()) * 8;
+    }
+    return n;
+}
+
+// Forwards to the wrapped connection's statement, going through the cache.
+class CachingStatement : public PreparedStatement {
+public:
+    CachingStatement(CachingDatabase& owner, std::shared_ptr<PreparedStatement> stmt)
+        : db(owner), inner(std::move(stmt)) {}
+
+    bool execute(const SqlParams& params) override {
+        bool ok = inner->execute(params);
+        db.wrote(inner->sql());
+        return ok;
+    }
+    QueryResult query(const SqlParams& params) override {
+        return db.cachedQuery(inner->sql(), params, [&]() { return inner->query(params); });
+    }
+    const std::string& sql() const override { return inner->sql(); }
+
+private:
+    CachingDatabase& db;
+    std::shared_ptr<PreparedStatement> inner;
+};
+
+// Stores the result of a missed async query when it is collected.
+class CachingFuture : public QueryFuture {
+public:
+    CachingFuture(std::unique_ptr<QueryFuture> pending, std::shared_ptr<QueryCache> resultCache, std::string cacheKey,
+                  std::string sqlText, uint64_t startGeneration)
+        : inner(std::move(pending)), cache(std::move(resultCache)), key(std::move(cacheKey)), sql(std::move(sqlText)),
+          generation(startGeneration) {}
+
+    bool ready() override { return inner->ready(); }
+    QueryResult get() override {
+        QueryResult result = inner->get();
+        cache->put(key, sql, result, generation);
+        return result;
+    }
+
+private:
+    std::unique_ptr<QueryFuture> inner;
+    std::shared_ptr<QueryCache> cache;
+    std::string key;
+    std::string sql;
+    uint64_t generation;
+};
+
+} // namespace
+
+QueryCache::QueryCache(size_t bytes, std::chrono::milliseconds timeToLive)
+    : maxBytes(bytes), ttl(timeToLive), entries(bytes) {
+    entries.onEvict([this](const std::string&, Entry& e) { forget(e); });
+}
+
+std::string QueryCache::keyFor(const std::string& sql, const SqlParams& params) {
+    if (!analyze(sql).cacheable) return "";
+    for (const auto& p : params) {
+        if (p.index() != 3) continue;
+        std::string text = std::get<std::string>(p);
+        for (auto& ch : text) ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+        if (isVolatileLiteral(text)) return ""; // datetime(?) bound to 'now'
+    }
+    std::string key = normalize(sql);
+    for (const auto& p : params) {
+        key += '\x1f';
+        switch (p.index()) {
+        case 0: key += 'n'; break;
+        case 1: key += 'i' + std::to_string(std::get<int64_t>(p)); break;
+        case 2: {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "r%.17g", std::get<double>(p));
+            key += buf;
+            break;
+        }
+        default: key += 's' + std::get<std::string>(p); break;
+        }
+    }
+    return key;
+}
+
+std::shared_ptr<const QueryResult> QueryCache::get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry* e = entries.get(key);
+    if (e && std::chrono::steady_clock::now() >= e->expires) {
+        forget(*e);
+        entries.erase(key);
+        ++counters.expired;
+        e = nullptr;
+    }
+    if (!e) {
+        ++counters.misses;
+        return nullptr;
+    }
+    ++counters.hits;
+    return e->result;
+}
+
+uint64_t QueryCache::generation() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return gen;
+}
+
+void QueryCache::put(const std::string& key, const std::string& sql, const QueryResult& result,
+                     uint64_t startGeneration) {
+    if (key.empty() || result.columns.empty()) return; // no columns: the query failed
+
+    Entry e;
+    e.tables = analyze(sql).tables;
+    const size_t cost = resultBytes(result) + key.size() + kEntryOverhead;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (cost > maxBytes / 4 || clearedAt > startGeneration) return;
+    for (const auto& table : e.tables) {
+        auto it = writtenAt.find(table);
+        if (it != writtenAt.end() && it->second > startGeneration) return; // written while the query ran
+    }
+    for (const auto& table : e.tables) {
+        if (!views.count(table)) continue;
+        // We can't tell which tables the view reads: any write invalidates it
+        if (gen > startGeneration) return;
+        e.tables.push_back(kAnyTable);
+        break;
+    }
+    if (Entry* old = entries.peek(key)) {
+        forget(*old);
+        entries.erase(key);
+    }
+    e.result = std::make_shared<const QueryResult>(result);
+    e.expires = std::chrono::steady_clock::now() + ttl;
+    for (const auto& table : e.tables) ++tableRefs[table];
+    if (entries.put(key, std::move(e), cost)) ++counters.stores;
+}
+
+void QueryCache::invalidate(const std::string& sql) {
+    Analysis a = analyze(sql);
+    if (a.read || a.control) return;
+    if (!a.view.empty() || !a.triggerTable.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!a.view.empty()) views.insert(tableKey(a.view));
+        if (!a.triggerTable.empty()) triggered.insert(tableKey(a.triggerTable));
+    }
+    if (a.tables.empty()) {
+        clear();
+    } else {
+        invalidateTables(a.tables);
+    }
+}
+
+void QueryCache::invalidateTables(const std::vector<std::string>& tables) {
+    std::vector<std::string> keys;
+    keys.reserve(tables.size());
+    for (const auto& table : tables) keys.push_back(tableKey(table));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& table : keys) {
+        // Its triggers may write to any table
+        if (triggered.count(table)) return clearLocked();
+    }
+    ++gen;
+    bool referenced = tableRefs.count(kAnyTable) > 0;
+    for (const auto& table : keys) {
+        writtenAt[table] = gen;
+        referenced = referenced || tableRefs.count(table);
+    }
+    if (!referenced) return;
+
+    counters.invalidations += entries.eraseIf([&](const std::string&, const Entry& e) {
+        for (const auto& table : e.tables) {
+            if (table != kAnyTable && std::find(keys.begin(), keys.end(), table) == keys.end()) continue;
+            forget(e);
+            return true;
+        }
+        return false;
+    });
+}
+
+void QueryCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    clearLocked();
+}
+
+void QueryCache::clearLocked() {
+    counters.invalidations += entries.size();
+    entries.clear();
+    tableRefs.clear();
+    clearedAt = ++gen;
+}
+
+QueryCacheStats QueryCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    QueryCacheStats s = counters;
+    s.evictions = entries.evictions();
+    s.entries = entries.size();
+    s.bytes = entries.cost();
+    s.maxBytes = maxBytes;
+    return s;
+}
+
+void QueryCache::forget(const Entry& e) {
+    for (const auto& table : e.tables) {
+        auto it = tableRefs.find(table);
+        if (it != tableRefs.end() && --it->second == 0) tableRefs.erase(it);
+    }
+}
+
+CachingDatabase::CachingDatabase(std::unique_ptr<Database> db, std::shared_ptr<QueryCache> resultCache)
+    : inner(std::move(db)), cache(std::move(resultCache)) {}
+
+CachingDatabase::~CachingDatabase() {
+    clearStatementCache(); // our statements wrap the inner connection's; drop them first
+}
+
+bool CachingDatabase::execute(const std::string& sql) {
+    bool ok = inner->execute(sql);
+    wrote(sql); // even on failure: a script may have run partway
+    return ok;
+}
+
+QueryResult CachingDatabase::query(const std::string& sql) {
+    return cachedQuery(sql, SqlParams(), [&]() { return inner->query(sql); });
+}
+
+void CachingDatabase::close() {
+    clearStatementCache();
+    inner->close();
+}
+
+std::shared_ptr<PreparedStatement> CachingDatabase::prepare(const std::string& sql) {
+    auto stmt = inner->prepare(sql);
+    if (!stmt) return nullptr;
+    return std::make_shared<CachingStatement>(*this, std::move(stmt));
+}
+
+bool CachingDatabase::executeBatch(const std::vector<BatchStatement>& statements) {
+    bool ok = inner->executeBatch(statements);
+    for (const auto& s : statements) wrote(s.sql);
+    return ok;
+}
+
+QueryResult CachingDatabase::cachedQuery(const std::string& sql, const SqlParams& params,
+                                         const std::function<QueryResult()>& run) {
+    std::string key = inTransaction() ? std::string() : QueryCache::keyFor(sql, params);
+    if (key.empty()) {
+        QueryResult result = run();
+        wrote(sql); // INSERT ... RETURNING and friends arrive here too
+        return result;
+    }
+    if (auto hit = cache->get(key)) return *hit;
+
+    const uint64_t generation = cache->generation();
+    QueryResult result = run();
+    cache->put(key, sql, result, generation);
+    return result;
+}
+
+std::unique_ptr<QueryFuture> CachingDatabase::queryAsync(const std::string& sql, const SqlParams& params) {
+    std::string key = inTransaction() ? std::string() : QueryCache::keyFor(sql, params);
+    if (key.empty()) {
+        auto future = inner->queryAsync(sql, params);
+        wrote(sql);
+        return future;
+    }
+    if (auto hit = cache->get(key)) return std::make_unique<ReadyQueryFuture>(*hit);
+
+    const uint64_t generation = cache->generation();
+    return std::make_unique<CachingFuture>(inner->queryAsync(sql, params), cache, std::move(key), sql, generation);
+}
+
+void CachingDatabase::wrote(const std::string& sql) {
+    cache->invalidate(sql);
+    if (inTransaction()) writtenInTransaction.insert(sql);
+}
+
+bool CachingDatabase::beginTransaction() {
+    return inner->begin();
+}
+
+bool CachingDatabase::commitTransaction() {
+    bool ok = inner->commit();
+    // Other connections may have cached the pre-transaction rows meanwhile
+    for (const auto& sql : writtenInTransaction) cache->invalidate(sql);
+    if (!tablesInTransaction.empty()) {
+        cache->invalidateTables(std::vector<std::string>(tablesInTransaction.begin(), tablesInTransaction.end()));
+    }
+    writtenInTransaction.clear();
+    tablesInTransaction.clear();
+    return ok;
+}
+
+bool CachingDatabase::rollbackTransaction() {
+    writtenInTransaction.clear();
+    tablesInTransaction.clear();
+    return inner->rollback();
+}
+
+bool CachingDatabase::insertRows(const std::string& table, const std::vector<std::string>& columns,
+                                 const std::vector<SqlParams>& rows) {
+    bool ok = inner->bulkInsert(table, columns, rows).ok;
+    cache->invalidateTables({table});
+    if (inTransaction()) tablesInTransaction.insert(table);
+    return ok;
+}
+
+} // namespace dex
@@ -0,0 +1,150 @@
+// src/runtime/query_cache.h
+#ifndef DEX_QUERY_CACHE_H
+#define DEX_QUERY_CACHE_H
+
+#include "database.h"
+#include "lru_cache.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace dex {
+
+struct QueryCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t invalidations = 0; // entries dropped because a statement wrote to their tables
+    uint64_t expired = 0;       // entries dropped for outliving the TTL
+    uint64_t evictions = 0;     // entries dropped to stay under maxBytes
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t maxBytes = 0;
+
+    double hitRate() const {
+        return hits + misses ? static_cast<double>(hits) / static_cast<double>(hits + misses) : 0.0;
+    }
+};
+
+// Size-bounded cache of read-only query results, shared by every connection
+// of a pool. Entries are keyed by normalized SQL (whitespace and comments
+// collapsed, case kept) plus the bound parameters, live for at most `ttl`,
+// and are dropped as soon as a statement through the pool writes to a table
+// they read. Writes the cache can't attribute to tables (DDL, unparseable
+// statements) clear it; writes from other processes are only caught by the TTL.
+// Views and triggers created through the pool are remembered from their
+// CREATE statements: results read from a view are dropped by any write, and
+// a write to a table with a trigger clears the whole cache. Ones that already
+// existed, or were created by another process, are unknown to the cache, so
+// results read through them can be stale for up to the TTL.
+class QueryCache {
+public:
+    QueryCache(size_t maxBytes, std::chrono::milliseconds ttl);
+
+    // Cache key for `sql` run with `params`, or "" if its result must not be
+    // cached (writes, volatile functions like random() or now(), 'now' and
+    // 'today' date literals or parameters, locking reads).
+    static std::string keyFor(const std::string& sql, const SqlParams& params);
+
+    // Cached result for `key`, or nullptr on a miss.
+    std::shared_ptr<const QueryResult> get(const std::string& key);
+
+    // Generation to pass to put(): a put whose query started before an
+    // invalidation is dropped, so a slow read can't re-insert stale rows.
+    uint64_t generation() const;
+    void put(const std::string& key, const std::string& sql, const QueryResult& result, uint64_t generation);
+
+    // Called after `sql` ran: drops entries reading the tables it may have written.
+    void invalidate(const std::string& sql);
+    void invalidateTables(const std::vector<std::string>& tables);
+    void clear();
+
+    QueryCacheStats stats() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const QueryResult> result;
+        std::vector<std::string> tables;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    mutable std::mutex mutex;
+    size_t maxBytes;
+    std::chrono::milliseconds ttl;
+    LruCache<std::string, Entry> entries;
+    std::unordered_map<std::string, size_t> tableRefs;   // table -> entries reading it
+    std::unordered_map<std::string, uint64_t> writtenAt; // table -> generation of its last write
+    uint64_t gen = 0;       // bumped by every invalidation
+    uint64_t clearedAt = 0; // generation of the last clear()
+    std::unordered_set<std::string> views;     // created through the pool
+    std::unordered_set<std::string> triggered; // tables given a trigger through the pool
+    QueryCacheStats counters;
+
+    void forget(const Entry& e);
+    void clearLocked();
+};
+
+// Database decorator that answers cacheable queries from a QueryCache and
+// invalidates it on writes. Inside a transaction it neither reads nor fills
+// the cache (the transaction may see its own uncommitted rows); tables it
+// writes are invalidated again on commit, when other connections see the change.
+// Cursors stream straight from the wrapped connection.
+class CachingDatabase : public Database {
+public:
+    CachingDatabase(std::unique_ptr<Database> inner, std::shared_ptr<QueryCache> cache);
+    ~CachingDatabase() override;
+
+    using Database::execute;
+    using Database::query;
+
+    bool connect(const std::string& connStr) override { return inner->connect(connStr); }
+    bool execute(const std::string& sql) override;
+    QueryResult query(const std::string& sql) override;
+    void close() override;
+    bool ping() override { return inner->ping(); }
+    char statementHandle() const override { return inner->statementHandle(); }
+    std::shared_ptr<PreparedStatement> prepare(const std::string& sql) override;
+    std::unique_ptr<Cursor> cursor(const std::string& sql, const SqlParams& params) override {
+        return inner->cursor(sql, params);
+    }
+    bool executeBatch(const std::vector<BatchStatement>& statements) override;
+    // Hits come back ready; misses go to the wrapped connection's pipeline
+    // and fill the cache when collected.
+    std::unique_ptr<QueryFuture> queryAsync(const std::string& sql, const SqlParams& params) override;
+    bool registerTable(const std::string& name, std::shared_ptr<const Table> table) override {
+        return inner->registerTable(name, std::move(table));
+    }
+
+    Database& wrapped() const { return *inner; }
+
+    // Cache-aware read used by query() and by prepared statements: `run` is
+    // only called on a miss.
+    QueryResult cachedQuery(const std::string& sql, const SqlParams& params,
+                            const std::function<QueryResult()>& run);
+    // Records that `sql` ran successfully on this connection.
+    void wrote(const std::string& sql);
+
+protected:
+    bool beginTransaction() override;
+    bool commitTransaction() override;
+    bool rollbackTransaction() override;
+    bool insertRows(const std::string& table, const std::vector<std::string>& columns,
+                    const std::vector<SqlParams>& rows) override;
+
+private:
+    std::unique_ptr<Database> inner;
+    std::shared_ptr<QueryCache> cache;
+    // Invalidated again on commit
+    std::unordered_set<std::string> writtenInTransaction; // statements
+    std::unordered_set<std::string> tablesInTransaction;  // bulk insert targets
+};
+
+} // namespace dex
+
+#endif // DEX_QUERY_CACHE_H
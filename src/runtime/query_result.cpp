@@ -0,0 +1,259 @@
+// src/runtime/query_result.cpp
+#include "query_result.h"
+#include "table.h"
+#include <algorithm>
+
+namespace dex {
+
+const char* sqlTypeName(SqlType type) {
+    switch (type) {
+    case SqlType::Null: return "null";
+    case SqlType::Integer: return "integer";
+    case SqlType::Real: return "real";
+    case SqlType::Text: return "text";
+    case SqlType::Blob: return "blob";
+    }
+    return "unknown";
+}
+
+std::string ResultColumn::cellString(size_t row) const {
+    if (isNull(row)) return "";
+    switch (type) {
+    case SqlType::Integer: return std::to_string(ints[row]);
+    case SqlType::Real: return formatDouble(reals[row]);
+    case SqlType::Text:
+    case SqlType::Blob: return std::string(text(row));
+    case SqlType::Null: break;
+    }
+    return "";
+}
+
+Value ResultColumn::cellToDexValue(size_t row) const {
+    if (isNull(row)) return Value();
+    return Value(cellString(row));
+}
+
+const ResultColumn* QueryResult::column(const std::string& name) const {
+    for (const auto& c : columns) {
+        if (c.name == name) return &c;
+    }
+    return nullptr;
+}
+
+Value QueryResult::rowToDexValue(size_t row) const {
+    std::vector<Value> cells;
+    cells.reserve(columns.size());
+    for (const auto& c : columns) {
+        cells.push_back(c.cellToDexValue(row));
+    }
+    return Value(std::move(cells));
+}
+
+Value QueryResult::toDexValue() const {
+    std::vector<Value> rows;
+    rows.reserve(rowCount);
+    for (size_t r = 0; r < rowCount; ++r) {
+        rows.push_back(rowToDexValue(r));
+    }
+    return Value(std::move(rows));
+}
+
+Value QueryResult::columnToDexValue(size_t col) const {
+    const ResultColumn& c = columns[col];
+    std::vector<Value> cells;
+    cells.reserve(rowCount);
+    for (size_t r = 0; r < rowCount; ++r) {
+        cells.push_back(c.cellToDexValue(r));
+    }
+    return Value(std::move(cells));
+}
+
+QueryResult QueryResult::slice(size_t begin, size_t end) const {
+    end = std::min(end, rowCount);
+    begin = std::min(begin, end);
+    QueryResult out;
+    out.rowCount = end - begin;
+    out.columns.reserve(columns.size());
+    for (const auto& c : columns) {
+        ResultColumn s;
+        s.name = c.name;
+        s.type = c.type;
+        if (c.type == SqlType::Integer) s.ints.assign(c.ints.begin() + begin, c.ints.begin() + end);
+        if (c.type == SqlType::Real) s.reals.assign(c.reals.begin() + begin, c.reals.begin() + end);
+        if (c.type == SqlType::Text || c.type == SqlType::Blob) {
+            const uint64_t base = c.offsets[begin];
+            s.bytes.assign(c.bytes, base, c.offsets[end] - base);
+            s.offsets.resize(out.rowCount + 1);
+            for (size_t r = 0; r <= out.rowCount; ++r) s.offsets[r] = c.offsets[begin + r] - base;
+        }
+        s.validity.assign((out.rowCount + 63) / 64, 0);
+        for (size_t r = 0; r < out.rowCount; ++r) {
+            if (!c.isNull(begin + r)) s.validity[r >> 6] |= uint64_t(1) << (r & 63);
+        }
+        out.columns.push_back(std::move(s));
+    }
+    return out;
+}
+
+std::shared_ptr<Table> QueryResult::toTable() const {
+    std::vector<std::string> names;
+    names.reserve(columns.size());
+    for (const auto& c : columns) names.push_back(c.name);
+
+    TableBuilder builder(names);
+    for (size_t r = 0; r < rowCount; ++r) {
+        for (size_t i = 0; i < columns.size(); ++i) {
+            const ResultColumn& c = columns[i];
+            if (c.isNull(r)) {
+                builder.appendNull(i);
+                continue;
+            }
+            switch (c.type) {
+            case SqlType::Integer: builder.appendInt(i, c.ints[r]); break;
+            case SqlType::Real: builder.appendDouble(i, c.reals[r]); break;
+            case SqlType::Text:
+            case SqlType::Blob: builder.appendString(i, c.text(r)); break;
+            case SqlType::Null: builder.appendNull(i); break;
+            }
+        }
+        builder.endRow();
+    }
+    return builder.finish();
+}
+
+QueryResultBuilder::QueryResultBuilder(std::vector<std::string> columnNames) {
+    result.columns.resize(columnNames.size());
+    for (size_t i = 0; i < columnNames.size(); ++i) {
+        result.columns[i].name = std::move(columnNames[i]);
+    }
+    lengths.assign(columnNames.size(), 0);
+}
+
+void QueryResultBuilder::declareType(size_t col, SqlType type) {
+    ResultColumn& c = result.columns[col];
+    if (c.type == SqlType::Null) convert(c, type, lengths[col]);
+}
+
+void QueryResultBuilder::setValid(ResultColumn& c, size_t row, bool valid) {
+    if ((row >> 6) >= c.validity.size()) c.validity.resize((row >> 6) + 1, 0);
+    if (valid) c.validity[row >> 6] |= uint64_t(1) << (row & 63);
+}
+
+// Re-stores the `n` cells a column already holds under type `to`.
+void QueryResultBuilder::convert(ResultColumn& c, SqlType to, size_t n) {
+    const SqlType from = c.type;
+    if (from == to) return;
+
+    if (from == SqlType::Null) {
+        // Only nulls so far: give them zero/empty slots in the new storage.
+        if (to == SqlType::Integer) c.ints.assign(n, 0);
+        else if (to == SqlType::Real) c.reals.assign(n, 0.0);
+        else if (to != SqlType::Null) c.offsets.assign(n + 1, 0);
+    } else if (from == SqlType::Integer && to == SqlType::Real) {
+        c.reals.assign(c.ints.begin(), c.ints.end());
+        std::vector<int64_t>().swap(c.ints);
+    } else if ((from == SqlType::Text && to == SqlType::Blob) || (from == SqlType::Blob && to == SqlType::Text)) {
+        // same byte storage
+    } else {
+        // Numbers to text: render the cells already stored.
+        std::string bytes;
+        std::vector<uint64_t> offsets{0};
+        offsets.reserve(n + 1);
+        for (size_t r = 0; r < n; ++r) {
+            if (!c.isNull(r)) bytes += c.cellString(r);
+            offsets.push_back(bytes.size());
+        }
+        std::vector<int64_t>().swap(c.ints);
+        std::vector<double>().swap(c.reals);
+        c.bytes = std::move(bytes);
+        c.offsets = std::move(offsets);
+    }
+    c.type = to;
+}
+
+void QueryResultBuilder::pushSlot(ResultColumn& c) {
+    switch (c.type) {
+    case SqlType::Integer: c.ints.push_back(0); break;
+    case SqlType::Real: c.reals.push_back(0.0); break;
+    case SqlType::Text:
+    case SqlType::Blob: c.offsets.push_back(c.bytes.size()); break;
+    case SqlType::Null: break;
+    }
+}
+
+ResultColumn& QueryResultBuilder::begin(size_t col, SqlType type) {
+    ResultColumn& c = result.columns[col];
+    const size_t stored = lengths[col]++;
+    setValid(c, stored, type != SqlType::Null);
+    if (type == SqlType::Null || c.type == type) return c;
+
+    switch (c.type) {
+    case SqlType::Null:
+    case SqlType::Integer:
+        convert(c, type, stored);
+        break;
+    case SqlType::Real:
+        if (type != SqlType::Integer) convert(c, type, stored);
+        break;
+    case SqlType::Text:
+        if (type == SqlType::Blob) convert(c, SqlType::Blob, stored);
+        break;
+    case SqlType::Blob:
+        break;
+    }
+    return c;
+}
+
+void QueryResultBuilder::appendNull(size_t col) {
+    pushSlot(begin(col, SqlType::Null));
+}
+
+void QueryResultBuilder::appendInt(size_t col, int64_t v) {
+    ResultColumn& c = begin(col, SqlType::Integer);
+    switch (c.type) {
+    case SqlType::Integer: c.ints.push_back(v); break;
+    case SqlType::Real: c.reals.push_back(static_cast<double>(v)); break;
+    default:
+        c.bytes += std::to_string(v);
+        c.offsets.push_back(c.bytes.size());
+        break;
+    }
+}
+
+void QueryResultBuilder::appendDouble(size_t col, double v) {
+    ResultColumn& c = begin(col, SqlType::Real);
+    if (c.type == SqlType::Real) {
+        c.reals.push_back(v);
+    } else {
+        c.bytes += formatDouble(v);
+        c.offsets.push_back(c.bytes.size());
+    }
+}
+
+void QueryResultBuilder::appendText(size_t col, std::string_view v) {
+    ResultColumn& c = begin(col, SqlType::Text);
+    c.bytes.append(v.data(), v.size());
+    c.offsets.push_back(c.bytes.size());
+}
+
+void QueryResultBuilder::appendBlob(size_t col, std::string_view v) {
+    ResultColumn& c = begin(col, SqlType::Blob);
+    c.bytes.append(v.data(), v.size());
+    c.offsets.push_back(c.bytes.size());
+}
+
+void QueryResultBuilder::endRow() {
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        if (lengths[i] == result.rowCount) appendNull(i);
+    }
+    ++result.rowCount;
+}
+
+QueryResult QueryResultBuilder::finish() {
+    for (auto& c : result.columns) {
+        c.validity.resize((result.rowCount + 63) / 64, 0);
+    }
+    return std::move(result);
+}
+
+} // namespace dex
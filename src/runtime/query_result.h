@@ -0,0 +1,114 @@
+// src/runtime/query_result.h
+#ifndef DEX_QUERY_RESULT_H
+#define DEX_QUERY_RESULT_H
+
+#include "../interpreter/interpreter.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dex {
+
+class Table;
+
+// Storage class of a result column. Null means the column has only held
+// nulls, so its type is unknown.
+enum class SqlType { Null, Integer, Real, Text, Blob };
+
+const char* sqlTypeName(SqlType type);
+
+// One result column, stored natively. Integer cells live in `ints`, Real in
+// `reals`, Text/Blob cells are bytes[offsets[row], offsets[row + 1]).
+// Bit i of `validity` is set when row i is non-null.
+struct ResultColumn {
+    std::string name;
+    SqlType type = SqlType::Null;
+
+    std::vector<int64_t> ints;
+    std::vector<double> reals;
+    std::vector<uint64_t> offsets{0};
+    std::string bytes;
+    std::vector<uint64_t> validity;
+
+    bool isNull(size_t row) const { return !((validity[row >> 6] >> (row & 63)) & 1); }
+    std::string_view text(size_t row) const {
+        return std::string_view(bytes).substr(offsets[row], offsets[row + 1] - offsets[row]);
+    }
+    // Text form of a cell; empty string for null.
+    std::string cellString(size_t row) const;
+    // Dex form of a cell: null stays null, numbers become their text.
+    Value cellToDexValue(size_t row) const;
+};
+
+// Typed, column-wise result of a query. Cells keep the type the backend
+// returned; conversion to Dex values only happens for the rows, columns or
+// cells a script actually reads. Wrapped in a shared_ptr it is the Dex
+// "ResultSet" handle, immutable once built.
+class QueryResult : public NativeObject {
+public:
+    std::vector<ResultColumn> columns;
+    size_t rowCount = 0;
+
+    std::string typeName() const override { return "ResultSet"; }
+
+    bool empty() const { return rowCount == 0; }
+    size_t size() const { return rowCount; }
+
+    // Returns nullptr if there is no column called `name`.
+    const ResultColumn* column(const std::string& name) const;
+
+    // Row `row` as a Dex array in column order.
+    Value rowToDexValue(size_t row) const;
+    // Every row, as an array of row arrays.
+    Value toDexValue() const;
+    // Column `col` as a Dex array.
+    Value columnToDexValue(size_t col) const;
+
+    // Copy of rows [begin, end).
+    QueryResult slice(size_t begin, size_t end) const;
+
+    // Copies into a Table so Table.sum/filter/groupBy run on native values.
+    std::shared_ptr<Table> toTable() const;
+};
+
+// Builds a QueryResult row by row from a backend cursor. Columns take the
+// type of their first non-null cell; a column that later receives a
+// different type widens Integer -> Real, Text -> Blob, and otherwise falls
+// back to Text (SQLite does not enforce one type per column).
+class QueryResultBuilder {
+public:
+    explicit QueryResultBuilder(std::vector<std::string> columnNames);
+
+    size_t columnCount() const { return result.columns.size(); }
+
+    // Sets the type of a column that has no values yet, so empty and
+    // all-null results still report the backend's declared type.
+    void declareType(size_t col, SqlType type);
+
+    void appendNull(size_t col);
+    void appendInt(size_t col, int64_t v);
+    void appendDouble(size_t col, double v);
+    void appendText(size_t col, std::string_view v);
+    void appendBlob(size_t col, std::string_view v);
+
+    // Closes the current row, padding columns that received no value with null.
+    void endRow();
+
+    // Hands over the result; the builder is spent afterwards.
+    QueryResult finish();
+
+private:
+    QueryResult result;
+    std::vector<size_t> lengths;
+
+    void setValid(ResultColumn& c, size_t row, bool valid);
+    void convert(ResultColumn& c, SqlType to, size_t n);
+    void pushSlot(ResultColumn& c);
+    ResultColumn& begin(size_t col, SqlType type);
+};
+
+} // namespace dex
+
+#endif // DEX_QUERY_RESULT_H
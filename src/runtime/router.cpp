@@ -0,0 +1,175 @@
+// src/runtime/router.cpp
+#include "router.h"
+#include <stdexcept>
+
+namespace dex {
+
+std::string_view RouteParams::get(std::string_view name) const {
+    for (size_t i = 0; i < count; ++i) {
+        if (items[i].name == name) return items[i].value;
+    }
+    return {};
+}
+
+struct Router::Node {
+    std::string prefix;                          // literal text, empty on param/wildcard nodes
+    std::string firstBytes;                      // first byte of each literal child, in order
+    std::vector<std::unique_ptr<Node>> children; // literal children
+    std::unique_ptr<Node> param;                 // `:name` child
+    std::unique_ptr<Node> wildcard;              // `*name` child, always a leaf
+    std::string name;                            // parameter name, on param/wildcard nodes
+    size_t id = npos;
+};
+
+Router::Router() = default;
+Router::~Router() = default;
+
+// Node reached by following literal `text` down from `n`, splitting an
+// edge where `text` ends or diverges inside it.
+Router::Node* Router::insertLiteral(Node* n, std::string_view text) {
+    while (!text.empty()) {
+        size_t i = n->firstBytes.find(text[0]);
+        if (i == std::string::npos) {
+            auto child = std::make_unique<Node>();
+            child->prefix = std::string(text);
+            n->firstBytes.push_back(text[0]);
+            n->children.push_back(std::move(child));
+            return n->children.back().get();
+        }
+        Node* c = n->children[i].get();
+        size_t common = 0;
+        while (common < c->prefix.size() && common < text.size() && c->prefix[common] == text[common]) ++common;
+        if (common < c->prefix.size()) {
+            auto mid = std::make_unique<Node>();
+            mid->prefix = c->prefix.substr(0, common);
+            c->prefix.erase(0, common);
+            mid->firstBytes.push_back(c->prefix[0]);
+            mid->children.push_back(std::move(n->children[i]));
+            n->children[i] = std::move(mid);
+            c = n->children[i].get();
+        }
+        n = c;
+        text.remove_prefix(common);
+    }
+    return n;
+}
+
+// Child for a parameter named `name`, created if needed.
+Router::Node* Router::parameterChild(std::unique_ptr<Node>& slot, std::string_view name, std::string_view pattern) {
+    if (!slot) {
+        slot = std::make_unique<Node>();
+        slot->name = std::string(name);
+    } else if (slot->name != name) {
+        throw std::runtime_error("Route " + std::string(pattern) + " names parameter '" + std::string(name) +
+                                 "' where another route has '" + slot->name + "'");
+    }
+    return slot.get();
+}
+
+size_t Router::insert(std::string_view method, std::string_view pattern, size_t id) {
+    if (pattern.empty() || pattern[0] != '/') {
+        throw std::runtime_error("Route path must start with '/': " + std::string(pattern));
+    }
+    Node* n = nullptr;
+    for (auto& [m, root] : trees) {
+        if (m == method) n = root.get();
+    }
+    if (!n) {
+        trees.emplace_back(std::string(method), std::make_unique<Node>());
+        n = trees.back().second.get();
+    }
+
+    size_t params = 0;
+    size_t i = 0;
+    while (i < pattern.size()) {
+        // Literal text up to the next segment starting with ':' or '*'.
+        size_t j = i;
+        while (j < pattern.size() && !((pattern[j] == ':' || pattern[j] == '*') && pattern[j - 1] == '/')) ++j;
+        n = insertLiteral(n, pattern.substr(i, j - i));
+        if (j == pattern.size()) break;
+        if (++params > RouteParams::maxParams) {
+            throw std::runtime_error("Route " + std::string(pattern) + " has more than " +
+                                     std::to_string(RouteParams::maxParams) + " parameters");
+        }
+        if (pattern[j] == ':') {
+            size_t end = pattern.find('/', j);
+            if (end == std::string_view::npos) end = pattern.size();
+            std::string_view name = pattern.substr(j + 1, end - j - 1);
+            if (name.empty()) throw std::runtime_error("Route " + std::string(pattern) + " has an unnamed parameter");
+            n = parameterChild(n->param, name, pattern);
+            i = end;
+        } else {
+            if (pattern.find('/', j) != std::string_view::npos) {
+                throw std::runtime_error("Route " + std::string(pattern) + ": '*' must be the last segment");
+            }
+            std::string_view name = pattern.substr(j + 1);
+            n = parameterChild(n->wildcard, name.empty() ? std::string_view("wildcard") : name, pattern);
+            i = pattern.size();
+        }
+    }
+    if (n->id == npos) {
+        n->id = id;
+        ++routeCount;
+    }
+    return n->id;
+}
+
+// Matches `path`, the part left after `n`'s own text, below `n`.
+bool Router::matchBelow(const Node* n, std::string_view path, RouteParams& params, size_t& id) {
+    if (path.empty() && n->id != npos) {
+        id = n->id;
+        return true;
+    }
+    if (!path.empty()) {
+        size_t i = n->firstBytes.find(path[0]);
+        if (i != std::string::npos) {
+            const Node* c = n->children[i].get();
+            if (path.compare(0, c->prefix.size(), c->prefix) == 0 &&
+                matchBelow(c, path.substr(c->prefix.size()), params, id)) {
+                return true;
+            }
+        }
+        if (n->param) {
+            std::string_view segment = path.substr(0, path.find('/'));
+            if (!segment.empty()) {
+                size_t saved = params.count;
+                params.items[params.count++] = {n->param->name, segment};
+                if (matchBelow(n->param.get(), path.substr(segment.size()), params, id)) return true;
+                params.count = saved;
+            }
+        }
+    }
+    if (n->wildcard) {
+        params.items[params.count++] = {n->wildcard->name, path};
+        id = n->wildcard->id;
+        return true;
+    }
+    return false;
+}
+
+const Router::Node* Router::tree(std::string_view method) const {
+    for (const auto& [m, root] : trees) {
+        if (m == method) return root.get();
+    }
+    return nullptr;
+}
+
+size_t Router::match(std::string_view method, std::string_view path, RouteParams& params) const {
+    params.count = 0;
+    const Node* root = tree(method);
+    size_t id = npos;
+    if (!root || !matchBelow(root, path, params, id)) {
+        params.count = 0;
+        return npos;
+    }
+    return id;
+}
+
+std::vector<std::string_view> Router::methods() const {
+    std::vector<std::string_view> out;
+    out.reserve(trees.size());
+    for (const auto& tree : trees) out.push_back(tree.first);
+    return out;
+}
+
+} // namespace dex
@@ -0,0 +1,78 @@
+// src/runtime/router.h
+#ifndef DEX_ROUTER_H
+#define DEX_ROUTER_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dex {
+
+struct RouteParam {
+    std::string_view name;  // points into the router's pattern
+    std::string_view value; // points into the matched path
+};
+
+// Parameters a match captured, in pattern order. Fixed capacity, so
+// matching never allocates.
+struct RouteParams {
+    static constexpr size_t maxParams = 16;
+
+    std::array<RouteParam, maxParams> items;
+    size_t count = 0;
+
+    // Value of parameter `name`, or empty.
+    std::string_view get(std::string_view name) const;
+};
+
+// Compressed radix tree of path patterns, one tree per method. A pattern
+// segment may be a literal, `:name` (one non-empty segment) or, as the last
+// segment, `*name` (the rest of the path, possibly empty; `*` alone is
+// named "wildcard"). Where several routes could match, literal segments win
+// over parameters and parameters over wildcards, backtracking as needed:
+// with /users/new and /users/:id/edit, /users/new/edit matches the latter.
+//
+// Routes map to caller-chosen ids. Lookups don't allocate.
+class Router {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    Router();
+    ~Router();
+
+    Router(const Router&) = delete;
+    Router& operator=(const Router&) = delete;
+
+    // Routes `method` requests matching `pattern` to `id` and returns `id`;
+    // if that pattern is already routed, returns the existing id instead.
+    // Throws std::runtime_error for a malformed pattern, or a parameter
+    // whose name differs from the one already at that position.
+    size_t insert(std::string_view method, std::string_view pattern, size_t id);
+
+    // Id of the route matching `path`, or npos. `params` receives the
+    // parameters; its views stay valid while `path` and the router do.
+    size_t match(std::string_view method, std::string_view path, RouteParams& params) const;
+
+    // Methods with at least one route, in insertion order.
+    std::vector<std::string_view> methods() const;
+
+    size_t size() const { return routeCount; }
+
+private:
+    struct Node;
+
+    std::vector<std::pair<std::string, std::unique_ptr<Node>>> trees; // by method
+    size_t routeCount = 0;
+
+    const Node* tree(std::string_view method) const;
+    static Node* insertLiteral(Node* n, std::string_view text);
+    static Node* parameterChild(std::unique_ptr<Node>& slot, std::string_view name, std::string_view pattern);
+    static bool matchBelow(const Node* n, std::string_view path, RouteParams& params, size_t& id);
+};
+
+} // namespace dex
+
+#endif // DEX_ROUTER_H
@@ -0,0 +1,102 @@
+// src/runtime/spsc_queue.h
+#ifndef DEX_SPSC_QUEUE_H
+#define DEX_SPSC_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace dex {
+
+// Bounded single-producer/single-consumer ring buffer. One thread pushes,
+// one thread pops; neither takes a lock. A full queue makes the producer
+// wait (backpressure), an empty one makes the consumer wait, both with a
+// short spin before backing off to sleeps.
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        slots.resize(n);
+        mask = n - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    size_t capacity() const { return slots.size(); }
+
+    // Producer side. Moves from `item` only on success.
+    bool tryPush(T& item) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - headCache == slots.size()) {
+            headCache = head.load(std::memory_order_acquire);
+            if (t - headCache == slots.size()) return false;
+        }
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Waits for room. False (item not queued) once `stop` is set.
+    bool push(T item, const std::atomic<bool>& stop) {
+        for (unsigned spins = 0; !tryPush(item); ++spins) {
+            if (stop.load(std::memory_order_relaxed)) return false;
+            backoff(spins);
+        }
+        return true;
+    }
+
+    // Producer side: no more items will be pushed.
+    void close() { closed.store(true, std::memory_order_release); }
+
+    // Consumer side.
+    bool tryPop(T& out) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tailCache) {
+            tailCache = tail.load(std::memory_order_acquire);
+            if (h == tailCache) return false;
+        }
+        out = std::move(slots[h & mask]);
+        slots[h & mask] = T(); // release the item's memory now, not when the slot is reused
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Waits for an item. False once the queue is closed and drained, or `stop` is set.
+    bool pop(T& out, const std::atomic<bool>& stop) {
+        for (unsigned spins = 0;; ++spins) {
+            // Check closed before the last tryPop: items pushed before close() are never lost
+            bool done = closed.load(std::memory_order_acquire);
+            if (tryPop(out)) return true;
+            if (done || stop.load(std::memory_order_relaxed)) return false;
+            backoff(spins);
+        }
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask = 0;
+    // Each index is written by one side only; they sit on separate cache
+    // lines, next to that side's cached copy of the other index.
+    alignas(64) std::atomic<size_t> head{0}; // next slot to pop
+    size_t tailCache = 0;                    // consumer's last view of tail
+    alignas(64) std::atomic<size_t> tail{0}; // next slot to push
+    size_t headCache = 0;                    // producer's last view of head
+    alignas(64) std::atomic<bool> closed{false};
+
+    static void backoff(unsigned spins) {
+        if (spins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(spins < 256 ? 20 : 200));
+        }
+    }
+};
+
+} // namespace dex
+
+#endif // DEX_SPSC_QUEUE_H
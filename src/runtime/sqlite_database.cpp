@@ -1,66 +1,463 @@
-// src/runtime/sqlite_database.cpp
-#include "sqlite_database.h"
-#include <iostream>
-#include <cstring>
-
-namespace dex {
-
-SQLiteDatabase::SQLiteDatabase() : db(nullptr) {}
-
-SQLiteDatabase::~SQLiteDatabase() {
-    close();
-}
-
-bool SQLiteDatabase::connect(const std::string& connStr) {
-    // connStr format: "sqlite://path/to/file.db"
-    std::string filename = connStr.substr(strlen("sqlite://"));
-    int rc = sqlite3_open(filename.c_str(), &db);
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQLite open error: " << sqlite3_errmsg(db) << "\n";
-        return false;
-    }
-    return true;
-}
-
-bool SQLiteDatabase::execute(const std::string& query) {
-    char* errMsg = nullptr;
-    int rc = sqlite3_exec(db, query.c_str(), nullptr, nullptr, &errMsg);
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQLite execute error: " << errMsg << "\n";
-        sqlite3_free(errMsg);
-        return false;
-    }
-    return true;
-}
-
-QueryResult SQLiteDatabase::query(const std::string& query) {
-    QueryResult results;
-    sqlite3_stmt* stmt = nullptr;
-
-    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        std::cerr << "SQLite prepare failed\n";
-        return results;
-    }
-
-    int cols = sqlite3_column_count(stmt);
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        std::vector<std::string> row;
-        for (int i = 0; i < cols; ++i) {
-            const unsigned char* text = sqlite3_column_text(stmt, i);
-            row.emplace_back(text ? reinterpret_cast<const char*>(text) : "");
-        }
-        results.push_back(row);
-    }
-
-    sqlite3_finalize(stmt);
-    return results;
-}
-
-void SQLiteDatabase::close() {
-    if (db) {
-        sqlite3_close(db);
-        db = nullptr;
-    }
-}
-
-} // namespace dex
+// src/runtime/sqlite_database.cpp
+#include "sqlite_database.h"
+#include <chrono>
+#include <iostream>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+namespace dex {
+
+namespace {
+
+constexpr int kBusyTimeoutMs = 5000;
+constexpr long long kDefaultMmapSize = 256LL << 20;
+
+// Runs SQL without results on `db`, printing errors under `what`.
+bool execRaw(sqlite3* db, const std::string& sql, const char* what) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << what << ": " << (errMsg ? errMsg : sqlite3_errmsg(db)) << "\n";
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+bool openHandle(const std::string& filename, int flags, sqlite3** out) {
+    if (sqlite3_open_v2(filename.c_str(), out, flags, nullptr) != SQLITE_OK) {
+        std::cerr << "SQLite open error: " << sqlite3_errmsg(*out) << "\n";
+        sqlite3_close(*out);
+        *out = nullptr;
+        return false;
+    }
+    // Pooled connections to the same file contend for its lock; wait for it
+    // instead of failing immediately with SQLITE_BUSY.
+    sqlite3_busy_timeout(*out, kBusyTimeoutMs);
+    return true;
+}
+
+// BEGIN/COMMIT/... run as statements: in WAL mode they would land on the
+// reader (sqlite3_stmt_readonly is true for them) and split the transaction.
+bool isTransactionControl(const std::string& sql) {
+    size_t i = sql.find_first_not_of(" \t\r\n");
+    if (i == std::string::npos) return false;
+    size_t end = i;
+    while (end < sql.size() && std::isalpha(static_cast<unsigned char>(sql[end]))) ++end;
+    std::string word = sql.substr(i, end - i);
+    for (auto& ch : word) ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    return word == "BEGIN" || word == "COMMIT" || word == "END" || word == "ROLLBACK" || word == "SAVEPOINT" ||
+           word == "RELEASE";
+}
+
+} // namespace
+
+SQLiteWriter::~SQLiteWriter() {
+    sqlite3_close_v2(db);
+}
+
+std::shared_ptr<SQLiteWriter> SQLiteWriter::forFile(const std::string& path, long long mmapSize) {
+    static std::mutex registryMutex;
+    static std::unordered_map<std::string, std::weak_ptr<SQLiteWriter>> registry;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (auto existing = registry[path].lock()) return existing;
+
+    auto writer = std::make_shared<SQLiteWriter>();
+    if (!openHandle(path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, &writer->db)) return nullptr;
+    // WAL lets readers run while the writer commits; NORMAL sync is durable
+    // against application crashes and skips the fsync per transaction.
+    if (!execRaw(writer->db, "PRAGMA journal_mode=WAL", "SQLite WAL error") ||
+        !execRaw(writer->db, "PRAGMA synchronous=NORMAL", "SQLite WAL error") ||
+        !execRaw(writer->db, "PRAGMA mmap_size=" + std::to_string(mmapSize), "SQLite WAL error")) {
+        return nullptr;
+    }
+    registry[path] = writer;
+    return writer;
+}
+
+SQLiteDatabase::SQLiteDatabase() : db(nullptr) {}
+
+SQLiteDatabase::~SQLiteDatabase() {
+    close();
+}
+
+bool SQLiteDatabase::connect(const std::string& connStr) {
+    // connStr format: "sqlite://path/to/file.db[?wal=1&mmap=<bytes>]"
+    std::string filename = connStr.substr(strlen("sqlite://"));
+    bool wal = false;
+    long long mmapSize = kDefaultMmapSize;
+    size_t q = filename.find('?');
+    if (q != std::string::npos && filename.rfind("file:", 0) != 0) { // file: URIs keep their own query
+        std::string options = filename.substr(q + 1);
+        filename.erase(q);
+        for (size_t pos = 0; pos <= options.size();) {
+            size_t amp = options.find('&', pos);
+            if (amp == std::string::npos) amp = options.size();
+            std::string opt = options.substr(pos, amp - pos);
+            if (opt == "wal=1" || opt == "wal=true" || opt == "mode=wal") wal = true;
+            else if (opt.rfind("mmap=", 0) == 0) mmapSize = std::atoll(opt.c_str() + 5);
+            else if (!opt.empty()) std::cerr << "SQLite: ignoring unknown connection option '" << opt << "'\n";
+            pos = amp + 1;
+        }
+    }
+    if (wal && (filename == ":memory:" || filename.empty())) {
+        std::cerr << "SQLite: WAL mode needs a database file; using the default mode\n";
+        wal = false;
+    }
+
+    if (!wal) return openHandle(filename, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, &db);
+
+    writer = SQLiteWriter::forFile(filename, mmapSize); // creates the file, so the reader can open it
+    if (!writer || !openHandle(filename, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, &db)) {
+        writer.reset();
+        return false;
+    }
+    execRaw(db, "PRAGMA mmap_size=" + std::to_string(mmapSize), "SQLite WAL error");
+    return true;
+}
+
+std::unique_lock<std::timed_mutex> SQLiteDatabase::lockWriter() {
+    if (!writer || writeLock.owns_lock()) return std::unique_lock<std::timed_mutex>();
+    std::unique_lock<std::timed_mutex> lock(writer->mutex, std::chrono::milliseconds(kBusyTimeoutMs));
+    if (!lock.owns_lock()) std::cerr << "SQLite error: timed out waiting for the writer connection\n";
+    return lock;
+}
+
+bool SQLiteDatabase::execute(const std::string& query) {
+    // Single statements go through the statement cache; multi-statement
+    // scripts can't be prepared as one unit and run via sqlite3_exec.
+    if (auto stmt = cachedStatement(query)) return stmt->execute({});
+    if (!lastPrepareWasScript) return false;
+
+    if (!writer) return execRaw(db, query, "SQLite execute error");
+    // Scripts may write, so they run on the writer
+    std::unique_lock<std::timed_mutex> lock = lockWriter();
+    if (!lock.owns_lock() && !holdsWriter()) return false;
+    return execRaw(writer->db, query, "SQLite execute error");
+}
+
+QueryResult SQLiteDatabase::query(const std::string& query) {
+    return Database::query(query, SqlParams{});
+}
+
+// Prepares exactly one statement. Sets `script` (and returns nullptr) when
+// `sql` holds several statements, or none.
+static sqlite3_stmt* prepareOne(sqlite3* db, const std::string& sql, bool& script) {
+    script = false;
+    sqlite3_stmt* stmt = nullptr;
+    const char* tail = nullptr;
+    if (sqlite3_prepare_v3(db, sql.c_str(), static_cast<int>(sql.size()) + 1, SQLITE_PREPARE_PERSISTENT,
+                           &stmt, &tail) != SQLITE_OK) {
+        std::cerr << "SQLite prepare failed: " << sqlite3_errmsg(db) << "\n";
+        return nullptr;
+    }
+    while (tail && *tail && std::strchr(" \t\r\n;", *tail)) ++tail;
+    if ((tail && *tail) || !stmt) {
+        // More than one statement (or none, e.g. only comments): leave it to sqlite3_exec
+        sqlite3_finalize(stmt);
+        script = true;
+        return nullptr;
+    }
+    return stmt;
+}
+
+std::shared_ptr<PreparedStatement> SQLiteDatabase::prepare(const std::string& sql) {
+    if (!writer) {
+        sqlite3_stmt* stmt = prepareOne(db, sql, lastPrepareWasScript);
+        if (!stmt) return nullptr;
+        return std::make_shared<SQLitePreparedStatement>(db, stmt, sql);
+    }
+
+    if (isTransactionControl(sql)) {
+        lastPrepareWasScript = false;
+        std::cerr << "SQLite WAL mode: use begin/commit/rollback instead of running " << sql << "\n";
+        return nullptr;
+    }
+    // Inside a transaction everything runs on the writer, to see its own
+    // uncommitted rows. Otherwise reads stay on this connection's reader.
+    if (!holdsWriter()) {
+        sqlite3_stmt* stmt = prepareOne(db, sql, lastPrepareWasScript);
+        if (!stmt) return nullptr;
+        if (sqlite3_stmt_readonly(stmt)) return std::make_shared<SQLitePreparedStatement>(db, stmt, sql);
+        sqlite3_finalize(stmt);
+    }
+    sqlite3_stmt* stmt = prepareOne(writer->db, sql, lastPrepareWasScript);
+    if (!stmt) return nullptr;
+    return std::make_shared<SQLitePreparedStatement>(writer->db, stmt, sql, this, writer);
+}
+
+namespace {
+
+// Steps its own statement batch by batch rather than borrowing the cached
+// one, so the same SQL can still be run normally while the cursor is open.
+class SQLiteCursor : public Cursor {
+public:
+    SQLiteCursor(std::shared_ptr<SQLitePreparedStatement> statement, const SqlParams& bound)
+        : stmt(std::move(statement)), params(bound) {}
+
+    // Bindings reference `params`, which therefore lives as long as the cursor.
+    bool open() { return stmt->bind(params); }
+
+    QueryResult fetch(size_t maxRows) override {
+        QueryResultBuilder builder = stmt->resultBuilder();
+        for (size_t n = 0; n < maxRows && !done; ++n) {
+            int rc = sqlite3_step(stmt->get());
+            if (rc == SQLITE_ROW) {
+                stmt->appendRow(builder);
+                continue;
+            }
+            if (rc != SQLITE_DONE) {
+                std::cerr << "SQLite cursor error: " << sqlite3_errmsg(sqlite3_db_handle(stmt->get())) << "\n";
+                error = true;
+            }
+            stmt->reset();
+            done = true;
+        }
+        return builder.finish();
+    }
+
+private:
+    std::shared_ptr<SQLitePreparedStatement> stmt;
+    SqlParams params;
+};
+
+} // namespace
+
+std::unique_ptr<Cursor> SQLiteDatabase::cursor(const std::string& sql, const SqlParams& params) {
+    auto stmt = std::static_pointer_cast<SQLitePreparedStatement>(prepare(sql));
+    if (!stmt) {
+        if (lastPrepareWasScript) std::cerr << "SQLite cursor error: expected exactly one statement\n";
+        return nullptr;
+    }
+    if (stmt->onWriter() && !holdsWriter()) {
+        // Stepping would hold the shared writer for as long as the cursor lives
+        std::cerr << "SQLite cursor error: in WAL mode a cursor over a writing statement needs a transaction\n";
+        return nullptr;
+    }
+    auto cursor = std::make_unique<SQLiteCursor>(std::move(stmt), params);
+    if (!cursor->open()) return nullptr;
+    return cursor;
+}
+
+bool SQLiteDatabase::insertRows(const std::string& table, const std::vector<std::string>& columns,
+                                const std::vector<SqlParams>& rows) {
+    std::string sql = "INSERT INTO " + quoteIdentifier(table) + " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i) sql += ", ";
+        sql += quoteIdentifier(columns[i]);
+    }
+    sql += ") VALUES (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        sql += i ? ", ?" : "?";
+    }
+    sql += ")";
+
+    // In WAL mode the whole load runs on the writer, holding it throughout
+    std::unique_lock<std::timed_mutex> lock = lockWriter();
+    if (writer && !lock.owns_lock() && !holdsWriter()) return false;
+    sqlite3* target = writer ? writer->db : db;
+
+    bool script;
+    sqlite3_stmt* raw = prepareOne(target, sql, script);
+    if (!raw) return false;
+    SQLitePreparedStatement stmt(target, raw, sql);
+
+    // One transaction instead of one autocommit (and journal sync) per row.
+    // A savepoint also nests inside a transaction the caller already opened.
+    if (!execRaw(target, "SAVEPOINT dex_bulk_insert", "SQLite bulk insert error")) return false;
+    for (const auto& row : rows) {
+        if (!stmt.execute(row)) {
+            execRaw(target, "ROLLBACK TO dex_bulk_insert", "SQLite bulk insert error");
+            execRaw(target, "RELEASE dex_bulk_insert", "SQLite bulk insert error");
+            return false;
+        }
+    }
+    return execRaw(target, "RELEASE dex_bulk_insert", "SQLite bulk insert error");
+}
+
+bool SQLiteDatabase::beginTransaction() {
+    if (!writer) return Database::beginTransaction();
+
+    std::unique_lock<std::timed_mutex> lock = lockWriter();
+    if (!lock.owns_lock() || !execRaw(writer->db, "BEGIN", "SQLite begin error")) return false;
+    writeLock = std::move(lock);
+    return true;
+}
+
+bool SQLiteDatabase::commitTransaction() {
+    sqlite3* target = writer ? writer->db : db;
+    bool ok = writer ? execRaw(target, "COMMIT", "SQLite commit error") : execute("COMMIT");
+    // COMMIT can fail with the transaction still open (e.g. SQLITE_BUSY);
+    // roll it back so the connection isn't left mid-transaction.
+    if (!ok && target && !sqlite3_get_autocommit(target)) execRaw(target, "ROLLBACK", "SQLite rollback error");
+    if (writer) writeLock = std::unique_lock<std::timed_mutex>();
+    return ok;
+}
+
+bool SQLiteDatabase::rollbackTransaction() {
+    if (!writer) return Database::rollbackTransaction();
+
+    bool ok = execRaw(writer->db, "ROLLBACK", "SQLite rollback error");
+    writeLock = std::unique_lock<std::timed_mutex>();
+    return ok;
+}
+
+void SQLiteDatabase::close() {
+    clearStatementCache();
+    if (writeLock.owns_lock()) {
+        execRaw(writer->db, "ROLLBACK", "SQLite rollback error");
+        writeLock = std::unique_lock<std::timed_mutex>();
+    }
+    writer.reset();
+    if (db) {
+        // close_v2 defers the close until statements still held elsewhere are finalized
+        sqlite3_close_v2(db);
+        db = nullptr;
+    }
+    virtualTables.clear();
+}
+
+bool SQLiteDatabase::registerTable(const std::string& name, std::shared_ptr<const Table> table) {
+    if (!virtualTables.attach(db, name, table)) return false;
+    if (!writer) return true;
+
+    auto lock = lockWriter();
+    if (!lock.owns_lock() && !holdsWriter()) return false;
+    return writer->tables.attach(writer->db, name, std::move(table));
+}
+
+SQLitePreparedStatement::SQLitePreparedStatement(sqlite3* database, sqlite3_stmt* statement, std::string sql,
+                                                 SQLiteDatabase* writerOwner, std::shared_ptr<SQLiteWriter> sharedWriter)
+    : db(database), stmt(statement), text(std::move(sql)), owner(writerOwner), writer(std::move(sharedWriter)) {}
+
+SQLitePreparedStatement::~SQLitePreparedStatement() {
+    sqlite3_finalize(stmt);
+}
+
+void SQLitePreparedStatement::reset() {
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+bool SQLitePreparedStatement::bind(const SqlParams& params) {
+    reset();
+    if (static_cast<int>(params.size()) != sqlite3_bind_parameter_count(stmt)) {
+        std::cerr << "SQLite bind error: statement expects " << sqlite3_bind_parameter_count(stmt)
+                  << " parameter(s), got " << params.size() << "\n";
+        return false;
+    }
+    for (size_t i = 0; i < params.size(); ++i) {
+        int idx = static_cast<int>(i) + 1;
+        int rc;
+        if (auto* n = std::get_if<int64_t>(&params[i])) {
+            rc = sqlite3_bind_int64(stmt, idx, *n);
+        } else if (auto* d = std::get_if<double>(&params[i])) {
+            rc = sqlite3_bind_double(stmt, idx, *d);
+        } else if (auto* s = std::get_if<std::string>(&params[i])) {
+            // STATIC: params outlive the step loop, and reset() drops the binding afterwards
+            rc = sqlite3_bind_text(stmt, idx, s->data(), static_cast<int>(s->size()), SQLITE_STATIC);
+        } else {
+            rc = sqlite3_bind_null(stmt, idx);
+        }
+        if (rc != SQLITE_OK) {
+            std::cerr << "SQLite bind error: " << sqlite3_errmsg(db) << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SQLitePreparedStatement::execute(const SqlParams& params) {
+    std::unique_lock<std::timed_mutex> lock;
+    if (owner) {
+        lock = owner->lockWriter();
+        if (!lock.owns_lock() && !owner->holdsWriter()) return false;
+    }
+    if (!bind(params)) return false;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {}
+    bool ok = rc == SQLITE_DONE;
+    if (!ok) std::cerr << "SQLite execute error: " << sqlite3_errmsg(db) << "\n";
+    reset();
+    return ok;
+}
+
+// Column type from a declared type name, following SQLite's affinity rules.
+// NUMERIC affinity and undeclared (expression) columns stay unknown until a
+// value arrives.
+static SqlType declaredType(const char* decl) {
+    if (!decl) return SqlType::Null;
+    std::string t(decl);
+    for (auto& ch : t) ch = static_cast<char>(std::toupper(static_cast<unsigned char>(ch)));
+    if (t.find("INT") != std::string::npos) return SqlType::Integer;
+    if (t.find("CHAR") != std::string::npos || t.find("CLOB") != std::string::npos ||
+        t.find("TEXT") != std::string::npos) return SqlType::Text;
+    if (t.find("BLOB") != std::string::npos) return SqlType::Blob;
+    if (t.find("REAL") != std::string::npos || t.find("FLOA") != std::string::npos ||
+        t.find("DOUB") != std::string::npos) return SqlType::Real;
+    return SqlType::Null;
+}
+
+QueryResultBuilder SQLitePreparedStatement::resultBuilder() const {
+    int cols = sqlite3_column_count(stmt);
+    std::vector<std::string> names;
+    names.reserve(cols);
+    for (int i = 0; i < cols; ++i) {
+        names.emplace_back(sqlite3_column_name(stmt, i));
+    }
+    QueryResultBuilder builder(std::move(names));
+    for (int i = 0; i < cols; ++i) {
+        builder.declareType(i, declaredType(sqlite3_column_decltype(stmt, i)));
+    }
+    return builder;
+}
+
+void SQLitePreparedStatement::appendRow(QueryResultBuilder& builder) const {
+    const int cols = static_cast<int>(builder.columnCount());
+    for (int i = 0; i < cols; ++i) {
+        switch (sqlite3_column_type(stmt, i)) {
+        case SQLITE_INTEGER:
+            builder.appendInt(i, sqlite3_column_int64(stmt, i));
+            break;
+        case SQLITE_FLOAT:
+            builder.appendDouble(i, sqlite3_column_double(stmt, i));
+            break;
+        case SQLITE_BLOB: {
+            const void* blob = sqlite3_column_blob(stmt, i);
+            builder.appendBlob(i, std::string_view(static_cast<const char*>(blob), sqlite3_column_bytes(stmt, i)));
+            break;
+        }
+        case SQLITE_NULL:
+            builder.appendNull(i);
+            break;
+        default: {
+            const unsigned char* text = sqlite3_column_text(stmt, i);
+            builder.appendText(i, std::string_view(reinterpret_cast<const char*>(text), sqlite3_column_bytes(stmt, i)));
+            break;
+        }
+        }
+    }
+    builder.endRow();
+}
+
+QueryResult SQLitePreparedStatement::query(const SqlParams& params) {
+    std::unique_lock<std::timed_mutex> lock;
+    if (owner) { // e.g. INSERT ... RETURNING in WAL mode
+        lock = owner->lockWriter();
+        if (!lock.owns_lock() && !owner->holdsWriter()) return QueryResult();
+    }
+    if (!bind(params)) return QueryResult();
+
+    QueryResultBuilder builder = resultBuilder();
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        appendRow(builder);
+    }
+    if (rc != SQLITE_DONE) std::cerr << "SQLite query error: " << sqlite3_errmsg(db) << "\n";
+    reset();
+    return builder.finish();
+}
+
+} // namespace dex
@@ -1,26 +1,118 @@
-// src/runtime/sqlite_database.h
-#ifndef DEX_SQLITE_DATABASE_H
-#define DEX_SQLITE_DATABASE_H
-
-#include "database.h"
-#include <sqlite3.h>
-
-namespace dex {
-
-class SQLiteDatabase : public Database {
-public:
-    SQLiteDatabase();
-    ~SQLiteDatabase() override;
-
-    bool connect(const std::string& connStr) override;
-    bool execute(const std::string& query) override;
-    QueryResult query(const std::string& query) override;
-    void close() override;
-
-private:
-    sqlite3* db = nullptr;
-};
-
-} // namespace dex
-
-#endif
+// src/runtime/sqlite_database.h
+#ifndef DEX_SQLITE_DATABASE_H
+#define DEX_SQLITE_DATABASE_H
+
+#include "database.h"
+#include "sqlite_vtab.h"
+#include <memory>
+#include <mutex>
+#include <sqlite3.h>
+
+namespace dex {
+
+// Writer connection shared by every WAL-mode SQLiteDatabase on one file.
+// SQLite admits one writer at a time anyway; sending all writes through one
+// handle queues them on `mutex` instead of busy-waiting on the file lock.
+// The mutex is held for one write statement, or for a whole transaction.
+struct SQLiteWriter {
+    sqlite3* db = nullptr;
+    std::timed_mutex mutex;
+    VirtualTables tables; // registered by the connections sharing the writer
+
+    ~SQLiteWriter();
+
+    // Shared writer for `path`, opened (and switched to WAL) on first use.
+    static std::shared_ptr<SQLiteWriter> forFile(const std::string& path, long long mmapSize);
+};
+
+// Connection strings: "sqlite://path/to/file.db", optionally followed by
+// "?wal=1" (and "&mmap=<bytes>", default 256 MiB) for the multi-reader mode:
+// the connection then reads through its own read-only, memory-mapped handle
+// and routes statements that write (per sqlite3_stmt_readonly) and explicit
+// transactions to the file's shared SQLiteWriter. A pool of such connections
+// reads in parallel, one reader per pooled connection. In this mode use
+// begin/commit/rollback rather than BEGIN/COMMIT statements.
+class SQLiteDatabase : public Database {
+public:
+    SQLiteDatabase();
+    ~SQLiteDatabase() override;
+
+    using Database::execute;
+    using Database::query;
+
+    bool connect(const std::string& connStr) override;
+    bool execute(const std::string& query) override;
+    QueryResult query(const std::string& query) override;
+    void close() override;
+    std::shared_ptr<PreparedStatement> prepare(const std::string& sql) override;
+    std::unique_ptr<Cursor> cursor(const std::string& sql, const SqlParams& params) override;
+    bool ping() override { return db != nullptr; } // in-process, nothing to drop
+    // In WAL mode the table is registered on the shared writer as well, so
+    // writes and transactions can read it too.
+    bool registerTable(const std::string& name, std::shared_ptr<const Table> table) override;
+
+    // Raw handle for SQLite-specific features (typed column access, ...).
+    // In WAL mode this is the connection's read-only handle.
+    sqlite3* handle() const { return db; }
+    bool walMode() const { return writer != nullptr; }
+
+    // WAL mode: locks the shared writer for one write, waiting up to the
+    // busy timeout. Returns an unowned lock if this connection already holds
+    // it for a transaction, or (with the error printed) on timeout.
+    std::unique_lock<std::timed_mutex> lockWriter();
+    bool holdsWriter() const { return writeLock.owns_lock(); }
+    // Statements prepared in a WAL transaction run on the writer; outside one,
+    // reads go to this connection's reader.
+    char statementHandle() const override { return holdsWriter() ? 1 : 0; }
+
+protected:
+    bool insertRows(const std::string& table, const std::vector<std::string>& columns,
+                    const std::vector<SqlParams>& rows) override;
+    bool beginTransaction() override;
+    bool commitTransaction() override;
+    bool rollbackTransaction() override;
+
+private:
+    sqlite3* db = nullptr;
+    bool lastPrepareWasScript = false;
+    std::shared_ptr<SQLiteWriter> writer;       // WAL mode only
+    std::unique_lock<std::timed_mutex> writeLock; // held while a transaction is open in WAL mode
+    VirtualTables virtualTables;
+};
+
+class SQLitePreparedStatement : public PreparedStatement {
+public:
+    // `writerOwner` is set for statements on a shared WAL writer: running
+    // them takes the writer lock through that connection.
+    SQLitePreparedStatement(sqlite3* db, sqlite3_stmt* stmt, std::string sql, SQLiteDatabase* writerOwner = nullptr,
+                            std::shared_ptr<SQLiteWriter> writer = nullptr);
+    ~SQLitePreparedStatement() override;
+
+    bool execute(const SqlParams& params) override;
+    QueryResult query(const SqlParams& params) override;
+    const std::string& sql() const override { return text; }
+
+    // Binds `params` after resetting the statement; false (with the error
+    // printed) if a parameter can't be bound.
+    bool bind(const SqlParams& params);
+    // Resets the statement and drops bindings so no parameter memory is referenced.
+    void reset();
+    sqlite3_stmt* get() const { return stmt; }
+    bool onWriter() const { return owner != nullptr; }
+
+    // Builder named and typed after the statement's result columns.
+    QueryResultBuilder resultBuilder() const;
+    // Appends the row the statement is positioned on.
+    void appendRow(QueryResultBuilder& builder) const;
+
+private:
+    sqlite3* db;
+    sqlite3_stmt* stmt;
+    std::string text;
+    SQLiteDatabase* owner;
+    std::shared_ptr<SQLiteWriter> writer; // keeps the shared handle open while the statement lives
+};
+
+} // namespace dex
+
+#endif
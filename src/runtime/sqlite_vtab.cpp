@@ -0,0 +1,379 @@
+// src/runtime/sqlite_vtab.cpp
+#include "sqlite_vtab.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace dex {
+
+namespace {
+
+// Constraint operators, passed from xBestIndex to xFilter in idxStr: one
+// character per argv value. idxNum is the constrained column.
+constexpr char kEq = '=';
+constexpr char kGt = '>';
+constexpr char kGe = 'G';
+constexpr char kLt = '<';
+constexpr char kLe = 'L';
+
+struct TableVtab : sqlite3_vtab {
+    std::shared_ptr<const Table> table;
+    // Per column: the rows holding a value (not null, not NaN) in ascending
+    // order of that value, ties in row order. Built on first use.
+    std::vector<std::unique_ptr<std::vector<uint32_t>>> sorted;
+};
+
+struct TableCursor : sqlite3_vtab_cursor {
+    const std::vector<uint32_t>* rows = nullptr; // sorted index being scanned; null for a full scan
+    size_t pos = 0;
+    size_t end = 0;
+
+    size_t row() const { return rows ? (*rows)[pos] : pos; }
+};
+
+// Constraint value in a form comparable with a column's cells.
+struct Key {
+    int type = SQLITE_NULL; // SQLITE_INTEGER, SQLITE_FLOAT or SQLITE_TEXT
+    int64_t i = 0;
+    double d = 0.0;
+    const char* s = nullptr;
+    size_t n = 0;
+};
+
+bool hasValue(const Column& c, size_t row) {
+    return (c.nullCount == 0 || c.isValid(row)) && !(c.type == ColumnType::Double && std::isnan(c.doubles[row]));
+}
+
+// Numbers compare with numbers and text with text, as SQLite does between
+// values of the same storage class. Anything else is left to SQLite.
+bool keyFor(const Column& c, sqlite3_value* v, Key& key) {
+    key.type = sqlite3_value_type(v);
+    if (c.type == ColumnType::String) {
+        if (key.type != SQLITE_TEXT) return false;
+        key.s = reinterpret_cast<const char*>(sqlite3_value_text(v));
+        key.n = static_cast<size_t>(sqlite3_value_bytes(v));
+        return true;
+    }
+    if (key.type == SQLITE_INTEGER) {
+        key.i = sqlite3_value_int64(v);
+        return true;
+    }
+    if (key.type == SQLITE_FLOAT) {
+        key.d = sqlite3_value_double(v);
+        return true;
+    }
+    return false;
+}
+
+template <typename T>
+int compare3(T a, T b) {
+    return (a > b) - (a < b);
+}
+
+// Integers and reals compare exactly, like SQLite does, through long double.
+int compareCell(const Column& c, size_t row, const Key& key) {
+    switch (c.type) {
+    case ColumnType::Int64:
+        if (key.type == SQLITE_INTEGER) return compare3(c.ints[row], key.i);
+        return compare3<long double>(c.ints[row], key.d);
+    case ColumnType::Double:
+        return compare3<long double>(c.doubles[row], key.type == SQLITE_INTEGER ? static_cast<long double>(key.i)
+                                                                                 : static_cast<long double>(key.d));
+    case ColumnType::String: {
+        // BINARY collation: memcmp, then the shorter string first
+        const std::string& s = (*c.dictionary)[c.codes[row]];
+        int r = std::memcmp(s.data(), key.s, std::min(s.size(), key.n));
+        return r ? (r > 0) - (r < 0) : compare3(s.size(), key.n);
+    }
+    }
+    return 0;
+}
+
+const std::vector<uint32_t>& sortedRows(TableVtab& vt, int col) {
+    auto& slot = vt.sorted[col];
+    if (slot) return *slot;
+
+    const Column& c = vt.table->columns[col];
+    auto rows = std::make_unique<std::vector<uint32_t>>();
+    rows->reserve(c.length - c.nullCount);
+    for (size_t r = 0; r < c.length; ++r) {
+        if (hasValue(c, r)) rows->push_back(static_cast<uint32_t>(r));
+    }
+    if (c.type == ColumnType::Int64) {
+        std::stable_sort(rows->begin(), rows->end(), [&](uint32_t a, uint32_t b) { return c.ints[a] < c.ints[b]; });
+    } else if (c.type == ColumnType::Double) {
+        std::stable_sort(rows->begin(), rows->end(), [&](uint32_t a, uint32_t b) { return c.doubles[a] < c.doubles[b]; });
+    } else {
+        // Rank the dictionary once so the row sort compares integers
+        const auto& dict = *c.dictionary;
+        std::vector<uint32_t> order(dict.size());
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return dict[a] < dict[b]; });
+        std::vector<uint32_t> rank(dict.size());
+        for (size_t i = 0; i < order.size(); ++i) rank[order[i]] = static_cast<uint32_t>(i);
+        std::stable_sort(rows->begin(), rows->end(),
+                         [&](uint32_t a, uint32_t b) { return rank[c.codes[a]] < rank[c.codes[b]]; });
+    }
+    slot = std::move(rows);
+    return *slot;
+}
+
+char opCode(unsigned char op) {
+    switch (op) {
+    case SQLITE_INDEX_CONSTRAINT_EQ: return kEq;
+    case SQLITE_INDEX_CONSTRAINT_GT: return kGt;
+    case SQLITE_INDEX_CONSTRAINT_GE: return kGe;
+    case SQLITE_INDEX_CONSTRAINT_LT: return kLt;
+    case SQLITE_INDEX_CONSTRAINT_LE: return kLe;
+    default: return 0;
+    }
+}
+
+int bestIndex(sqlite3_vtab* base, sqlite3_index_info* info) {
+    auto& vt = *static_cast<TableVtab*>(base);
+    const double rows = static_cast<double>(std::max<size_t>(vt.table->rowCount, 1));
+    const bool indexable = vt.table->rowCount <= std::numeric_limits<uint32_t>::max();
+
+    // Operator of constraint i if xFilter can use it, else 0
+    auto usable = [&](int i) -> char {
+        const auto& c = info->aConstraint[i];
+        if (!indexable || !c.usable || c.iColumn < 0) return 0;
+        if (vt.table->columns[c.iColumn].type == ColumnType::String) {
+            const char* coll = sqlite3_vtab_collation(info, i);
+            if (coll && sqlite3_stricmp(coll, "BINARY") != 0) return 0;
+        }
+        return opCode(c.op);
+    };
+
+    // One column per scan: the first with an equality, else the first with a bound
+    int column = -1;
+    for (int i = 0; i < info->nConstraint && column < 0; ++i) {
+        if (usable(i) == kEq) column = info->aConstraint[i].iColumn;
+    }
+    for (int i = 0; i < info->nConstraint && column < 0; ++i) {
+        if (usable(i)) column = info->aConstraint[i].iColumn;
+    }
+    if (column < 0) {
+        info->estimatedCost = rows;
+        info->estimatedRows = static_cast<sqlite3_int64>(rows);
+        return SQLITE_OK;
+    }
+
+    int eq = -1, lower = -1, upper = -1;
+    for (int i = 0; i < info->nConstraint; ++i) {
+        if (info->aConstraint[i].iColumn != column) continue;
+        char op = usable(i);
+        if (op == kEq && eq < 0) eq = i;
+        if ((op == kGt || op == kGe) && lower < 0) lower = i;
+        if ((op == kLt || op == kLe) && upper < 0) upper = i;
+    }
+    std::string ops;
+    for (int i : eq >= 0 ? std::vector<int>{eq} : std::vector<int>{lower, upper}) {
+        if (i < 0) continue;
+        info->aConstraintUsage[i].argvIndex = static_cast<int>(ops.size()) + 1;
+        ops += usable(i);
+    }
+
+    // No statistics: guess like SQLite does for an index without ANALYZE
+    double matches = eq >= 0 ? 10.0 : rows / (lower >= 0 && upper >= 0 ? 64.0 : 4.0);
+    matches = std::min(std::max(matches, 1.0), rows);
+    info->idxNum = column;
+    info->idxStr = sqlite3_mprintf("%s", ops.c_str());
+    info->needToFreeIdxStr = 1;
+    info->estimatedRows = static_cast<sqlite3_int64>(matches);
+    info->estimatedCost = std::log2(rows + 1.0) + matches;
+    return SQLITE_OK;
+}
+
+int disconnect(sqlite3_vtab* base) {
+    delete static_cast<TableVtab*>(base);
+    return SQLITE_OK;
+}
+
+int open(sqlite3_vtab* base, sqlite3_vtab_cursor** out) {
+    (void)base;
+    *out = new TableCursor();
+    return SQLITE_OK;
+}
+
+int close(sqlite3_vtab_cursor* cur) {
+    delete static_cast<TableCursor*>(cur);
+    return SQLITE_OK;
+}
+
+int filter(sqlite3_vtab_cursor* base, int idxNum, const char* idxStr, int argc, sqlite3_value** argv) {
+    auto& cur = *static_cast<TableCursor*>(base);
+    auto& vt = *static_cast<TableVtab*>(base->pVtab);
+    cur.rows = nullptr;
+    cur.pos = 0;
+    cur.end = vt.table->rowCount;
+    if (argc == 0) return SQLITE_OK;
+
+    const Column& col = vt.table->columns[idxNum];
+    std::vector<std::pair<char, Key>> bounds;
+    for (int i = 0; i < argc; ++i) {
+        Key key;
+        if (keyFor(col, argv[i], key)) bounds.emplace_back(idxStr[i], key);
+    }
+    if (bounds.empty()) return SQLITE_OK; // SQLite filters the full scan itself
+
+    const auto& rows = sortedRows(vt, idxNum);
+    auto below = [&](uint32_t row, const Key& k) { return compareCell(col, row, k) < 0; };
+    auto above = [&](const Key& k, uint32_t row) { return compareCell(col, row, k) > 0; };
+    auto first = rows.begin(), last = rows.end();
+    for (const auto& [op, key] : bounds) {
+        switch (op) {
+        case kEq:
+            first = std::lower_bound(first, last, key, below);
+            last = std::upper_bound(first, last, key, above);
+            break;
+        case kGt: first = std::upper_bound(first, last, key, above); break;
+        case kGe: first = std::lower_bound(first, last, key, below); break;
+        case kLt: last = std::lower_bound(first, last, key, below); break;
+        case kLe: last = std::upper_bound(first, last, key, above); break;
+        }
+    }
+    cur.rows = &rows;
+    cur.pos = static_cast<size_t>(first - rows.begin());
+    cur.end = static_cast<size_t>(last - rows.begin());
+    return SQLITE_OK;
+}
+
+int next(sqlite3_vtab_cursor* cur) {
+    ++static_cast<TableCursor*>(cur)->pos;
+    return SQLITE_OK;
+}
+
+int eof(sqlite3_vtab_cursor* base) {
+    const auto& cur = *static_cast<TableCursor*>(base);
+    return cur.pos >= cur.end;
+}
+
+int column(sqlite3_vtab_cursor* base, sqlite3_context* ctx, int i) {
+    const auto& cur = *static_cast<TableCursor*>(base);
+    const Column& c = static_cast<TableVtab*>(base->pVtab)->table->columns[i];
+    const size_t row = cur.row();
+    if (c.nullCount && !c.isValid(row)) {
+        sqlite3_result_null(ctx);
+    } else if (c.type == ColumnType::Int64) {
+        sqlite3_result_int64(ctx, c.ints[row]);
+    } else if (c.type == ColumnType::Double) {
+        sqlite3_result_double(ctx, c.doubles[row]);
+    } else {
+        // The vtab holds the Table, so the dictionary outlives every statement reading it
+        const std::string& s = (*c.dictionary)[c.codes[row]];
+        sqlite3_result_text(ctx, s.data(), static_cast<int>(s.size()), SQLITE_STATIC);
+    }
+    return SQLITE_OK;
+}
+
+int rowid(sqlite3_vtab_cursor* base, sqlite3_int64* out) {
+    *out = static_cast<sqlite3_int64>(static_cast<TableCursor*>(base)->row());
+    return SQLITE_OK;
+}
+
+std::string quoteName(const std::string& name) {
+    std::string out = "\"";
+    for (char ch : name) {
+        if (ch == '"') out += '"';
+        out += ch;
+    }
+    return out + "\"";
+}
+
+bool exec(sqlite3* db, const std::string& sql) {
+    char* err = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &err) == SQLITE_OK) return true;
+    std::cerr << "SQLite virtual table error: " << (err ? err : sqlite3_errmsg(db)) << std::endl;
+    sqlite3_free(err);
+    return false;
+}
+
+} // namespace
+
+int VirtualTables::connect(sqlite3* db, void* aux, int argc, const char* const* argv, sqlite3_vtab** out,
+                           char** err) {
+    auto& self = *static_cast<VirtualTables*>(aux);
+    auto it = argc >= 3 ? self.tables.find(argv[2]) : self.tables.end();
+    if (it == self.tables.end()) {
+        *err = sqlite3_mprintf("dex_table: no table registered as %s", argc >= 3 ? argv[2] : "?");
+        return SQLITE_ERROR;
+    }
+
+    const Table& table = *it->second;
+    std::string schema = "CREATE TABLE x(";
+    for (size_t i = 0; i < table.columns.size(); ++i) {
+        const Column& c = table.columns[i];
+        schema += (i ? ", " : "") + quoteName(c.name);
+        schema += c.type == ColumnType::Int64 ? " INTEGER" : c.type == ColumnType::Double ? " REAL" : " TEXT";
+    }
+    schema += ")";
+    int rc = sqlite3_declare_vtab(db, schema.c_str());
+    if (rc != SQLITE_OK) {
+        *err = sqlite3_mprintf("%s", sqlite3_errmsg(db));
+        return rc;
+    }
+
+    auto* vt = new TableVtab();
+    vt->table = it->second;
+    vt->sorted.resize(table.columns.size());
+    *out = vt;
+    return SQLITE_OK;
+}
+
+bool VirtualTables::attach(sqlite3* db, const std::string& name, std::shared_ptr<const Table> table) {
+    // Read-only: no xUpdate, so INSERT/UPDATE/DELETE on these tables fail
+    static const sqlite3_module module = [] {
+        sqlite3_module m{};
+        m.xCreate = connect;
+        m.xConnect = connect;
+        m.xBestIndex = bestIndex;
+        m.xDisconnect = disconnect;
+        m.xDestroy = disconnect;
+        m.xOpen = open;
+        m.xClose = close;
+        m.xFilter = filter;
+        m.xNext = next;
+        m.xEof = eof;
+        m.xColumn = column;
+        m.xRowid = rowid;
+        return m;
+    }();
+
+    if (!db || !table || table->columns.empty()) {
+        std::cerr << "SQLite virtual table error: nothing to expose as " << name << std::endl;
+        return false;
+    }
+    if (moduleOn != db) {
+        tables.clear();
+        if (sqlite3_create_module(db, "dex_table", &module, this) != SQLITE_OK) {
+            std::cerr << "SQLite virtual table error: " << sqlite3_errmsg(db) << std::endl;
+            return false;
+        }
+        moduleOn = db;
+    }
+
+    auto it = tables.find(name);
+    if (it != tables.end() && it->second == table) return true;
+    const std::string target = "temp." + quoteName(name);
+    // Only ever drop a table this registry created
+    if (it != tables.end() && !exec(db, "DROP TABLE IF EXISTS " + target)) return false;
+    tables[name] = std::move(table);
+    if (!exec(db, "CREATE VIRTUAL TABLE " + target + " USING dex_table")) {
+        tables.erase(name);
+        return false;
+    }
+    return true;
+}
+
+void VirtualTables::clear() {
+    tables.clear();
+    moduleOn = nullptr;
+}
+
+} // namespace dex
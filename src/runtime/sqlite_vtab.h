@@ -0,0 +1,43 @@
+// src/runtime/sqlite_vtab.h
+#ifndef DEX_SQLITE_VTAB_H
+#define DEX_SQLITE_VTAB_H
+
+#include "table.h"
+#include <map>
+#include <memory>
+#include <sqlite3.h>
+#include <string>
+
+namespace dex {
+
+// Columnar Tables exposed to SQL on one sqlite3 handle through the
+// "dex_table" virtual table module. SQLite reads the cells straight out of
+// the Table; nothing is copied into the database. Int64, double and string
+// columns are declared INTEGER, REAL and TEXT.
+//
+// Equality and range constraints (=, <, <=, >, >=, and the probes of an IN
+// list or a join) are pushed down to xFilter, which answers them from a
+// sorted row index built the first time a column is constrained. SQLite
+// still checks every row it gets back, so constraints the index can't
+// answer exactly (mixed types, other collations) only cost a wider scan.
+class VirtualTables {
+public:
+    // Makes `table` readable as temp."name" on `db`, replacing a table
+    // registered earlier under that name. Registering the same Table again
+    // is a no-op. Returns false with the error printed, e.g. when a statement
+    // is still reading the table being replaced.
+    bool attach(sqlite3* db, const std::string& name, std::shared_ptr<const Table> table);
+
+    // Forgets every table; call when `db` is closed.
+    void clear();
+
+private:
+    sqlite3* moduleOn = nullptr; // handle the module is registered on
+    std::map<std::string, std::shared_ptr<const Table>> tables;
+
+    static int connect(sqlite3* db, void* aux, int argc, const char* const* argv, sqlite3_vtab** out, char** err);
+};
+
+} // namespace dex
+
+#endif // DEX_SQLITE_VTAB_H
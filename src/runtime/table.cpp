@@ -0,0 +1,640 @@
+// src/runtime/table.cpp
+#include "table.h"
+#include "csv_reader.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace dex {
+
+namespace {
+
+// GCC/Clang vector extensions: four lanes per operation, lowered to
+// whatever SIMD width the target has (two SSE2 registers on baseline x86-64).
+typedef uint64_t u64x4 __attribute__((vector_size(32)));
+typedef int64_t i64x4 __attribute__((vector_size(32)));
+typedef double f64x4 __attribute__((vector_size(32)));
+
+// Unaligned load; takes an out-parameter because returning 32-byte vectors
+// by value is ABI-sensitive on targets without AVX.
+template <typename V, typename T>
+inline void load4(V& v, const T* p) {
+    std::memcpy(&v, p, sizeof(V));
+}
+
+int64_t sumBlock(const int64_t* p, size_t n) {
+    u64x4 acc = {0, 0, 0, 0};
+    size_t i = 0;
+    const size_t whole = n & ~size_t(3);
+    for (; i < whole; i += 4) {
+        u64x4 v;
+        load4(v, p + i);
+        acc += v;
+    }
+    uint64_t s = acc[0] + acc[1] + acc[2] + acc[3];
+    for (; i < n; ++i) s += static_cast<uint64_t>(p[i]);
+    return static_cast<int64_t>(s); // wraps like the scalar loop would
+}
+
+double sumBlock(const double* p, size_t n) {
+    f64x4 acc = {0.0, 0.0, 0.0, 0.0};
+    size_t i = 0;
+    const size_t whole = n & ~size_t(3);
+    for (; i < whole; i += 4) {
+        f64x4 v;
+        load4(v, p + i);
+        acc += v;
+    }
+    double s = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+    for (; i < n; ++i) s += p[i];
+    return s;
+}
+
+template <typename V, typename T, bool IsMin>
+T extremeBlock(const T* p, size_t n, T seed) {
+    V m = {seed, seed, seed, seed};
+    size_t i = 0;
+    const size_t whole = n & ~size_t(3);
+    for (; i < whole; i += 4) {
+        V v;
+        load4(v, p + i);
+        m = IsMin ? (v < m ? v : m) : (v > m ? v : m);
+    }
+    T r = seed;
+    for (int lane = 0; lane < 4; ++lane) r = IsMin ? (m[lane] < r ? m[lane] : r) : (m[lane] > r ? m[lane] : r);
+    for (; i < n; ++i) r = IsMin ? (p[i] < r ? p[i] : r) : (p[i] > r ? p[i] : r);
+    return r;
+}
+
+// Calls block(ptr, n) for runs of 64 non-null rows and one(value) for the
+// valid rows of partially-null words. Columns without nulls are one block.
+template <typename T, typename Block, typename One>
+void forEachValid(const Column& c, const T* data, Block block, One one) {
+    if (c.nullCount == 0) {
+        if (c.length) block(data, c.length);
+        return;
+    }
+    for (size_t w = 0; w < c.validity.size(); ++w) {
+        uint64_t bits = c.validity[w];
+        size_t base = w * 64;
+        if (bits == ~0ULL && base + 64 <= c.length) {
+            block(data + base, 64);
+            continue;
+        }
+        while (bits) {
+            size_t row = base + static_cast<size_t>(__builtin_ctzll(bits));
+            one(data[row]);
+            bits &= bits - 1;
+        }
+    }
+}
+
+void requireNumeric(const Column& c, const char* kernel) {
+    if (c.type == ColumnType::String) {
+        throw std::runtime_error(std::string(kernel) + ": column '" + c.name + "' is not numeric");
+    }
+}
+
+template <bool IsMin>
+AggregateResult extreme(const Column& c, const char* kernel) {
+    requireNumeric(c, kernel);
+    AggregateResult r;
+    if (c.length == c.nullCount) return r;
+    r.found = true;
+    if (c.type == ColumnType::Int64) {
+        int64_t acc = IsMin ? std::numeric_limits<int64_t>::max() : std::numeric_limits<int64_t>::min();
+        forEachValid(c, c.ints.data(),
+            [&](const int64_t* p, size_t n) { acc = extremeBlock<i64x4, int64_t, IsMin>(p, n, acc); },
+            [&](int64_t v) { acc = IsMin ? (v < acc ? v : acc) : (v > acc ? v : acc); });
+        r.i = acc;
+    } else {
+        double acc = IsMin ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+        forEachValid(c, c.doubles.data(),
+            [&](const double* p, size_t n) { acc = extremeBlock<f64x4, double, IsMin>(p, n, acc); },
+            [&](double v) { acc = IsMin ? (v < acc ? v : acc) : (v > acc ? v : acc); });
+        r.isDouble = true;
+        r.d = acc;
+    }
+    return r;
+}
+
+// Skips a leading '+', which from_chars doesn't accept. Returns false for
+// a second sign after it ("+-5").
+bool skipPlus(const char*& b, const char* e) {
+    if (b == e || *b != '+') return true;
+    ++b;
+    return b == e || *b != '-';
+}
+
+bool parseInt(std::string_view s, int64_t& out) {
+    const char* b = s.data();
+    const char* e = b + s.size();
+    if (!skipPlus(b, e)) return false;
+    auto res = std::from_chars(b, e, out);
+    return res.ec == std::errc() && res.ptr == e && b != e;
+}
+
+// Finite numbers only: "inf" and "nan" stay text.
+bool parseDouble(std::string_view s, double& out) {
+    const char* b = s.data();
+    const char* e = b + s.size();
+    if (!skipPlus(b, e)) return false;
+    auto res = std::from_chars(b, e, out);
+    return res.ec == std::errc() && res.ptr == e && b != e && std::isfinite(out);
+}
+
+enum class CmpOp { Eq, Ne, Lt, Le, Gt, Ge };
+
+CmpOp parseOp(const std::string& op) {
+    if (op == "==" || op == "=") return CmpOp::Eq;
+    if (op == "!=") return CmpOp::Ne;
+    if (op == "<") return CmpOp::Lt;
+    if (op == "<=") return CmpOp::Le;
+    if (op == ">") return CmpOp::Gt;
+    if (op == ">=") return CmpOp::Ge;
+    throw std::runtime_error("filter: unknown operator '" + op + "'");
+}
+
+// Branch-free compare loops; each case is a plain loop the compiler vectorizes.
+template <typename T, typename L>
+void compareInto(const T* data, size_t n, L lit, CmpOp op, uint8_t* out) {
+    switch (op) {
+    case CmpOp::Eq: for (size_t i = 0; i < n; ++i) out[i] = data[i] == lit; break;
+    case CmpOp::Ne: for (size_t i = 0; i < n; ++i) out[i] = data[i] != lit; break;
+    case CmpOp::Lt: for (size_t i = 0; i < n; ++i) out[i] = data[i] < lit; break;
+    case CmpOp::Le: for (size_t i = 0; i < n; ++i) out[i] = data[i] <= lit; break;
+    case CmpOp::Gt: for (size_t i = 0; i < n; ++i) out[i] = data[i] > lit; break;
+    case CmpOp::Ge: for (size_t i = 0; i < n; ++i) out[i] = data[i] >= lit; break;
+    }
+}
+
+template <typename T>
+bool compareOne(const T& a, const T& b, CmpOp op) {
+    switch (op) {
+    case CmpOp::Eq: return a == b;
+    case CmpOp::Ne: return a != b;
+    case CmpOp::Lt: return a < b;
+    case CmpOp::Le: return a <= b;
+    case CmpOp::Gt: return a > b;
+    case CmpOp::Ge: return a >= b;
+    }
+    return false;
+}
+
+void appendValidity(Column& c, bool valid) {
+    if ((c.length & 63) == 0) c.validity.push_back(0);
+    if (valid) {
+        c.validity.back() |= 1ULL << (c.length & 63);
+    } else {
+        ++c.nullCount;
+    }
+    ++c.length;
+}
+
+Column gatherColumn(const Column& src, const std::vector<uint32_t>& rows) {
+    Column out;
+    out.name = src.name;
+    out.type = src.type;
+    out.dictionary = src.dictionary;
+    out.validity.reserve((rows.size() + 63) / 64);
+    switch (src.type) {
+    case ColumnType::Int64:
+        out.ints.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) out.ints[i] = src.ints[rows[i]];
+        break;
+    case ColumnType::Double:
+        out.doubles.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) out.doubles[i] = src.doubles[rows[i]];
+        break;
+    case ColumnType::String:
+        out.codes.resize(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) out.codes[i] = src.codes[rows[i]];
+        break;
+    }
+    for (uint32_t r : rows) appendValidity(out, src.isValid(r));
+    return out;
+}
+
+} // namespace
+
+const char* columnTypeName(ColumnType type) {
+    switch (type) {
+    case ColumnType::Int64: return "int64";
+    case ColumnType::Double: return "double";
+    case ColumnType::String: return "string";
+    }
+    return "unknown";
+}
+
+std::string formatDouble(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.15g", v);
+    if (std::strtod(buf, nullptr) != v) {
+        std::snprintf(buf, sizeof(buf), "%.17g", v);
+    }
+    return buf;
+}
+
+std::string Column::cellString(size_t row) const {
+    if (!isValid(row)) return "";
+    switch (type) {
+    case ColumnType::Int64: return std::to_string(ints[row]);
+    case ColumnType::Double: return formatDouble(doubles[row]);
+    case ColumnType::String: return (*dictionary)[codes[row]];
+    }
+    return "";
+}
+
+const Column* Table::column(const std::string& name) const {
+    for (const auto& c : columns) {
+        if (c.name == name) return &c;
+    }
+    return nullptr;
+}
+
+const Column& Table::requireColumn(const std::string& name) const {
+    const Column* c = column(name);
+    if (!c) throw std::runtime_error("Table has no column '" + name + "'");
+    return *c;
+}
+
+Value Table::rowToDexValue(size_t row) const {
+    std::unordered_map<std::string, Value> obj;
+    obj.reserve(columns.size());
+    for (const auto& c : columns) {
+        obj.emplace(c.name, c.isValid(row) ? Value(c.cellString(row)) : Value::nil());
+    }
+    return Value(std::move(obj));
+}
+
+// ---- TableBuilder ----
+
+TableBuilder::TableBuilder(const std::vector<std::string>& columnNames) {
+    columns.resize(columnNames.size());
+    for (size_t i = 0; i < columnNames.size(); ++i) {
+        columns[i].column.name = columnNames[i];
+    }
+}
+
+uint32_t TableBuilder::intern(Pending& p, std::string_view v) {
+    auto it = p.dictIndex.find(std::string(v));
+    if (it != p.dictIndex.end()) return it->second;
+    uint32_t code = static_cast<uint32_t>(p.column.dictionary->size());
+    p.column.dictionary->emplace_back(v);
+    p.dictIndex.emplace(std::string(v), code);
+    return code;
+}
+
+void TableBuilder::promote(Pending& p, ColumnType to) {
+    Column& c = p.column;
+    if (c.type == to) return;
+    if (to == ColumnType::Double) {
+        c.doubles.reserve(c.ints.capacity());
+        for (int64_t v : c.ints) c.doubles.push_back(static_cast<double>(v));
+        std::vector<int64_t>().swap(c.ints);
+    } else if (to == ColumnType::String) {
+        // Code 0 is always the empty string, which null cells point at.
+        c.dictionary = std::make_shared<std::vector<std::string>>();
+        c.dictionary->emplace_back();
+        p.dictIndex.emplace(std::string(), 0);
+        c.codes.reserve(c.length);
+        for (size_t i = 0; i < c.length; ++i) {
+            c.codes.push_back(c.isValid(i) ? intern(p, c.cellString(i)) : 0);
+        }
+        std::vector<int64_t>().swap(c.ints);
+        std::vector<double>().swap(c.doubles);
+    }
+    c.type = to;
+}
+
+void TableBuilder::appendNull(size_t col) {
+    Column& c = columns[col].column;
+    switch (c.type) {
+    case ColumnType::Int64: c.ints.push_back(0); break;
+    case ColumnType::Double: c.doubles.push_back(0.0); break;
+    case ColumnType::String: c.codes.push_back(0); break;
+    }
+    appendValidity(c, false);
+}
+
+void TableBuilder::appendInt(size_t col, int64_t v) {
+    Pending& p = columns[col];
+    switch (p.column.type) {
+    case ColumnType::Int64: p.column.ints.push_back(v); break;
+    case ColumnType::Double: p.column.doubles.push_back(static_cast<double>(v)); break;
+    case ColumnType::String: p.column.codes.push_back(intern(p, std::to_string(v))); break;
+    }
+    appendValidity(p.column, true);
+}
+
+void TableBuilder::appendDouble(size_t col, double v) {
+    Pending& p = columns[col];
+    if (p.column.type == ColumnType::Int64) promote(p, ColumnType::Double);
+    if (p.column.type == ColumnType::Double) {
+        p.column.doubles.push_back(v);
+    } else {
+        p.column.codes.push_back(intern(p, formatDouble(v)));
+    }
+    appendValidity(p.column, true);
+}
+
+void TableBuilder::appendString(size_t col, std::string_view v) {
+    Pending& p = columns[col];
+    promote(p, ColumnType::String);
+    p.column.codes.push_back(intern(p, v));
+    appendValidity(p.column, true);
+}
+
+void TableBuilder::appendText(size_t col, std::string_view text) {
+    if (text.empty()) {
+        appendNull(col);
+        return;
+    }
+    Pending& p = columns[col];
+    if (p.column.type != ColumnType::String) {
+        int64_t i;
+        double d;
+        if (p.column.type == ColumnType::Int64 && parseInt(text, i)) {
+            appendInt(col, i);
+            return;
+        }
+        if (parseDouble(text, d)) {
+            appendDouble(col, d);
+            return;
+        }
+    }
+    appendString(col, text);
+}
+
+void TableBuilder::endRow() {
+    ++rows;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (columns[i].column.length < rows) appendNull(i);
+    }
+}
+
+std::shared_ptr<Table> TableBuilder::finish() {
+    auto table = std::make_shared<Table>();
+    table->rowCount = rows;
+    table->columns.reserve(columns.size());
+    for (auto& p : columns) {
+        table->columns.push_back(std::move(p.column));
+    }
+    columns.clear();
+    rows = 0;
+    return table;
+}
+
+std::shared_ptr<Table> tableFromCSV(CSVReader& reader) {
+    std::vector<std::string> row;
+    std::vector<std::string> names = reader.header();
+    bool pending = false;
+    if (names.empty()) {
+        if (!reader.readRow(row)) return std::make_shared<Table>();
+        for (size_t i = 0; i < row.size(); ++i) names.push_back("c" + std::to_string(i + 1));
+        pending = true;
+    }
+
+    TableBuilder builder(names);
+    while (pending || reader.readRow(row)) {
+        pending = false;
+        size_t n = std::min(row.size(), builder.columnCount());
+        for (size_t i = 0; i < n; ++i) builder.appendText(i, row[i]);
+        builder.endRow();
+    }
+    return builder.finish();
+}
+
+std::shared_ptr<Table> tableFromRows(const std::vector<Value>& rows, bool header) {
+    auto appendCell = [](TableBuilder& builder, size_t col, const Value& v) {
+        if (v.isNull()) {
+            builder.appendNull(col);
+        } else if (v.isString()) {
+            builder.appendText(col, v.asString());
+        } else {
+            builder.appendText(col, v.toString());
+        }
+    };
+    if (rows.empty()) return std::make_shared<Table>();
+
+    std::vector<std::string> names;
+    if (rows[0].isObject()) {
+        for (const auto& row : rows) {
+            if (!row.isObject()) throw std::runtime_error("tableFromRows: rows must all be arrays or all objects");
+            for (const auto& [key, cell] : row.asObject()) names.push_back(key);
+        }
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+
+        TableBuilder builder(names);
+        for (const auto& row : rows) {
+            const auto& cells = row.asObject();
+            for (size_t i = 0; i < names.size(); ++i) {
+                auto it = cells.find(names[i]);
+                if (it != cells.end()) appendCell(builder, i, it->second);
+            }
+            builder.endRow();
+        }
+        return builder.finish();
+    }
+
+    size_t width = 0;
+    for (const auto& row : rows) {
+        if (!row.isArray()) throw std::runtime_error("tableFromRows: rows must all be arrays or all objects");
+        width = std::max(width, row.asArray().size());
+    }
+    size_t first = 0;
+    if (header) {
+        for (const auto& name : rows[0].asArray()) names.push_back(name.toString());
+        first = 1;
+    }
+    for (size_t i = names.size(); i < width; ++i) names.push_back("c" + std::to_string(i + 1));
+
+    TableBuilder builder(names);
+    for (size_t r = first; r < rows.size(); ++r) {
+        const auto& cells = rows[r].asArray();
+        for (size_t i = 0; i < cells.size(); ++i) appendCell(builder, i, cells[i]);
+        builder.endRow();
+    }
+    return builder.finish();
+}
+
+// ---- Kernels ----
+
+AggregateResult tableSum(const Column& c) {
+    requireNumeric(c, "sum");
+    AggregateResult r;
+    r.found = c.length > c.nullCount;
+    if (c.type == ColumnType::Int64) {
+        uint64_t acc = 0;
+        forEachValid(c, c.ints.data(),
+            [&](const int64_t* p, size_t n) { acc += static_cast<uint64_t>(sumBlock(p, n)); },
+            [&](int64_t v) { acc += static_cast<uint64_t>(v); });
+        r.i = static_cast<int64_t>(acc);
+    } else {
+        double acc = 0.0;
+        forEachValid(c, c.doubles.data(),
+            [&](const double* p, size_t n) { acc += sumBlock(p, n); },
+            [&](double v) { acc += v; });
+        r.isDouble = true;
+        r.d = acc;
+    }
+    return r;
+}
+
+AggregateResult tableMin(const Column& c) {
+    return extreme<true>(c, "min");
+}
+
+AggregateResult tableMax(const Column& c) {
+    return extreme<false>(c, "max");
+}
+
+size_t tableCount(const Column& c) {
+    return c.length - c.nullCount;
+}
+
+std::shared_ptr<Table> tableFilter(const Table& t, const std::string& column,
+                                   const std::string& op, const std::string& literal) {
+    const Column& c = t.requireColumn(column);
+    CmpOp cmp = parseOp(op);
+    std::vector<uint8_t> keep(c.length);
+
+    if (c.type == ColumnType::String) {
+        // Evaluate the predicate once per distinct value, then map codes.
+        std::vector<uint8_t> match(c.dictionary->size());
+        for (size_t i = 0; i < match.size(); ++i) match[i] = compareOne((*c.dictionary)[i], literal, cmp);
+        for (size_t i = 0; i < c.length; ++i) keep[i] = match[c.codes[i]];
+    } else {
+        int64_t li;
+        double ld;
+        if (c.type == ColumnType::Int64 && parseInt(literal, li)) {
+            compareInto(c.ints.data(), c.length, li, cmp, keep.data());
+        } else if (parseDouble(literal, ld)) {
+            if (c.type == ColumnType::Int64) {
+                for (size_t i = 0; i < c.length; ++i) keep[i] = compareOne(static_cast<double>(c.ints[i]), ld, cmp);
+            } else {
+                compareInto(c.doubles.data(), c.length, ld, cmp, keep.data());
+            }
+        } else {
+            throw std::runtime_error("filter: '" + literal + "' is not a number for column '" + column + "'");
+        }
+    }
+
+    std::vector<uint32_t> rows;
+    for (size_t i = 0; i < c.length; ++i) {
+        if (keep[i] && c.isValid(i)) rows.push_back(static_cast<uint32_t>(i));
+    }
+
+    auto out = std::make_shared<Table>();
+    out->rowCount = rows.size();
+    out->columns.reserve(t.columns.size());
+    for (const auto& col : t.columns) out->columns.push_back(gatherColumn(col, rows));
+    return out;
+}
+
+std::shared_ptr<Table> tableGroupBy(const Table& t, const std::string& keyColumn,
+                                    const std::string& valueColumn, const std::string& agg) {
+    const Column& key = t.requireColumn(keyColumn);
+    const Column& val = t.requireColumn(valueColumn);
+    if (agg != "sum" && agg != "min" && agg != "max" && agg != "count" && agg != "avg") {
+        throw std::runtime_error("groupBy: unknown aggregate '" + agg + "'");
+    }
+    if (agg != "count") requireNumeric(val, "groupBy");
+
+    // Assign a dense group id to every row, in order of first appearance.
+    std::vector<uint32_t> gid(t.rowCount);
+    std::vector<uint32_t> firstRow;
+    const uint32_t none = std::numeric_limits<uint32_t>::max();
+    uint32_t nullGroup = none;
+    if (key.type == ColumnType::String) {
+        std::vector<uint32_t> byCode(key.dictionary->size(), none);
+        for (size_t i = 0; i < t.rowCount; ++i) {
+            uint32_t& slot = key.isValid(i) ? byCode[key.codes[i]] : nullGroup;
+            if (slot == none) {
+                slot = static_cast<uint32_t>(firstRow.size());
+                firstRow.push_back(static_cast<uint32_t>(i));
+            }
+            gid[i] = slot;
+        }
+    } else {
+        std::unordered_map<uint64_t, uint32_t> byKey;
+        for (size_t i = 0; i < t.rowCount; ++i) {
+            uint32_t* slot = &nullGroup;
+            if (key.isValid(i)) {
+                uint64_t bits;
+                if (key.type == ColumnType::Int64) {
+                    bits = static_cast<uint64_t>(key.ints[i]);
+                } else {
+                    double d = key.doubles[i] == 0.0 ? 0.0 : key.doubles[i]; // fold -0.0 into 0.0
+                    std::memcpy(&bits, &d, sizeof(bits));
+                }
+                slot = &byKey.emplace(bits, none).first->second;
+            }
+            if (*slot == none) {
+                *slot = static_cast<uint32_t>(firstRow.size());
+                firstRow.push_back(static_cast<uint32_t>(i));
+            }
+            gid[i] = *slot;
+        }
+    }
+
+    size_t groups = firstRow.size();
+    std::vector<int64_t> counts(groups, 0);
+    std::vector<int64_t> isum(groups, 0);
+    std::vector<double> dsum(groups, 0.0);
+    std::vector<uint8_t> seen(groups, 0);
+    bool asDouble = val.type == ColumnType::Double || agg == "avg";
+
+    for (size_t i = 0; i < t.rowCount; ++i) {
+        if (!val.isValid(i)) continue;
+        uint32_t g = gid[i];
+        ++counts[g];
+        if (agg == "count") continue;
+        if (val.type == ColumnType::Int64) {
+            int64_t v = val.ints[i];
+            if (agg == "sum" || agg == "avg") {
+                isum[g] = static_cast<int64_t>(static_cast<uint64_t>(isum[g]) + static_cast<uint64_t>(v));
+                dsum[g] += static_cast<double>(v);
+            } else if (!seen[g] || (agg == "min" ? v < isum[g] : v > isum[g])) {
+                isum[g] = v;
+            }
+        } else {
+            double v = val.doubles[i];
+            if (agg == "sum" || agg == "avg") {
+                dsum[g] += v;
+            } else if (!seen[g] || (agg == "min" ? v < dsum[g] : v > dsum[g])) {
+                dsum[g] = v;
+            }
+        }
+        seen[g] = 1;
+    }
+
+    auto out = std::make_shared<Table>();
+    out->rowCount = groups;
+    out->columns.push_back(gatherColumn(key, firstRow));
+
+    Column result;
+    result.name = agg + "(" + val.name + ")";
+    result.type = (agg == "count" || !asDouble) ? ColumnType::Int64 : ColumnType::Double;
+    for (size_t g = 0; g < groups; ++g) {
+        bool valid = agg == "count" || seen[g];
+        if (result.type == ColumnType::Int64) {
+            result.ints.push_back(agg == "count" ? counts[g] : isum[g]);
+        } else if (agg == "avg") {
+            result.doubles.push_back(counts[g] ? dsum[g] / static_cast<double>(counts[g]) : 0.0);
+        } else {
+            result.doubles.push_back(dsum[g]);
+        }
+        appendValidity(result, valid);
+    }
+    out->columns.push_back(std::move(result));
+    return out;
+}
+
+} // namespace dex
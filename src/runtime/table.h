@@ -0,0 +1,128 @@
+// src/runtime/table.h
+#ifndef DEX_TABLE_H
+#define DEX_TABLE_H
+
+#include "../interpreter/interpreter.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace dex {
+
+class CSVReader;
+
+enum class ColumnType { Int64, Double, String };
+
+const char* columnTypeName(ColumnType type);
+
+// One typed column. Exactly one of ints/doubles/codes holds the data,
+// depending on `type`. String columns are dictionary encoded: `codes`
+// index into `dictionary`, which filtered copies of the table share.
+// Bit i of `validity` is set when row i is non-null.
+struct Column {
+    std::string name;
+    ColumnType type = ColumnType::Int64;
+    size_t length = 0;
+    size_t nullCount = 0;
+
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<uint32_t> codes;
+    std::shared_ptr<std::vector<std::string>> dictionary;
+    std::vector<uint64_t> validity;
+
+    bool isValid(size_t row) const { return (validity[row >> 6] >> (row & 63)) & 1; }
+    // Text form of a cell; empty string for null.
+    std::string cellString(size_t row) const;
+};
+
+// Immutable columnar table produced by the CSV and database loaders.
+class Table : public NativeObject {
+public:
+    std::vector<Column> columns;
+    size_t rowCount = 0;
+
+    std::string typeName() const override { return "Table"; }
+
+    // Returns nullptr if there is no column called `name`.
+    const Column* column(const std::string& name) const;
+    const Column& requireColumn(const std::string& name) const; // throws std::runtime_error
+
+    // Converts row `row` to a Dex object keyed by column name.
+    Value rowToDexValue(size_t row) const;
+};
+
+// Builds a Table row by row. Values given as text are typed on the fly:
+// empty cells are null, and a column starts as int64, widens to double and
+// finally falls back to dictionary-encoded strings when a cell no longer fits.
+// A column that has only seen nulls so far is an all-null int64 column.
+class TableBuilder {
+public:
+    explicit TableBuilder(const std::vector<std::string>& columnNames);
+
+    size_t columnCount() const { return columns.size(); }
+
+    void appendNull(size_t col);
+    void appendInt(size_t col, int64_t v);
+    void appendDouble(size_t col, double v);
+    void appendString(size_t col, std::string_view v);
+    void appendText(size_t col, std::string_view text);
+
+    // Closes the current row, padding columns that received no value with null.
+    void endRow();
+
+    std::shared_ptr<Table> finish();
+
+private:
+    struct Pending {
+        Column column;
+        std::unordered_map<std::string, uint32_t> dictIndex;
+    };
+    std::vector<Pending> columns;
+    size_t rows = 0;
+
+    void promote(Pending& p, ColumnType to);
+    uint32_t intern(Pending& p, std::string_view v);
+};
+
+// Vectorized kernels. Nulls are skipped; an all-null or empty column
+// makes min/max/sum report `found == false`.
+struct AggregateResult {
+    bool found = false;
+    bool isDouble = false;
+    int64_t i = 0;
+    double d = 0.0;
+};
+
+AggregateResult tableSum(const Column& c);
+AggregateResult tableMin(const Column& c);
+AggregateResult tableMax(const Column& c);
+size_t tableCount(const Column& c); // non-null cells
+
+// Keeps the rows where `column op literal` holds. op is one of
+// == != < <= > >=; the literal is parsed according to the column type.
+std::shared_ptr<Table> tableFilter(const Table& t, const std::string& column,
+                                   const std::string& op, const std::string& literal);
+
+// Groups by `keyColumn` and aggregates `valueColumn` with sum, min, max,
+// count or avg. Null keys form their own group.
+std::shared_ptr<Table> tableGroupBy(const Table& t, const std::string& keyColumn,
+                                    const std::string& valueColumn, const std::string& agg);
+
+// Drains `reader` into a Table. Without a header row, columns are named c1, c2, ...
+std::shared_ptr<Table> tableFromCSV(CSVReader& reader);
+
+// Builds a Table from Dex rows: arrays of cells (the first one naming the
+// columns when `header` is set, else c1, c2, ...) or objects (columns named
+// after their keys, sorted). Cells are typed like CSV text. Throws
+// std::runtime_error on anything else.
+std::shared_ptr<Table> tableFromRows(const std::vector<Value>& rows, bool header);
+
+std::string formatDouble(double v);
+
+} // namespace dex
+
+#endif // DEX_TABLE_H
@@ -0,0 +1,111 @@
+#include "table.h"
+#include "../interpreter/interpreter.h"
+#include <stdexcept>
+#include <iostream>
+
+namespace dex {
+
+// Aggregates come back as strings like every other Dex number;
+// null when the column has no non-null cells.
+static Value aggregateToDexValue(const AggregateResult& r) {
+    if (!r.found) return Value::nil();
+    return r.isDouble ? Value(formatDouble(r.d)) : Value(std::to_string(r.i));
+}
+
+static std::shared_ptr<Table> tableArg(const std::vector<Value>& args, size_t minArgs, const char* name) {
+    auto table = args.size() >= minArgs ? args[0].asNative<Table>() : nullptr;
+    if (!table) {
+        std::cerr << "Runtime Error: " << name << " expects a Table as its first argument." << std::endl;
+        throw std::runtime_error(std::string(name) + " expects a Table as its first argument");
+    }
+    for (size_t i = 1; i < minArgs; ++i) {
+        if (!args[i].isString()) {
+            std::cerr << "Runtime Error: " << name << " expects string arguments after the Table." << std::endl;
+            throw std::runtime_error(std::string(name) + " expects string arguments after the Table");
+        }
+    }
+    return table;
+}
+
+// Table.sum(table, column)
+Value dex_tableSum(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto t = tableArg(args, 2, "Table.sum");
+    return aggregateToDexValue(tableSum(t->requireColumn(args[1].asString())));
+}
+
+// Table.min(table, column)
+Value dex_tableMin(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto t = tableArg(args, 2, "Table.min");
+    return aggregateToDexValue(tableMin(t->requireColumn(args[1].asString())));
+}
+
+// Table.max(table, column)
+Value dex_tableMax(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto t = tableArg(args, 2, "Table.max");
+    return aggregateToDexValue(tableMax(t->requireColumn(args[1].asString())));
+}
+
+// Table.count(table) -> row count; Table.count(table, column) -> non-null cells.
+Value dex_tableCount(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto t = tableArg(args, 1, "Table.count");
+    if (args.size() >= 2 && args[1].isString()) {
+        return Value(std::to_string(tableCount(t->requireColumn(args[1].asString()))));
+    }
+    return Value(std::to_string(t->rowCount));
+}
+
+// Table.filter(table, column, op, value) -> Table
+Value dex_tableFilter(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto t = tableArg(args, 4, "Table.filter");
+    return Value(tableFilter(*t, args[1].asString(), args[2].asString(), args[3].asString()));
+}
+
+// Table.groupBy(table, keyColumn, valueColumn, agg) -> Table with one row per key.
+Value dex_tableGroupBy(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto t = tableArg(args, 4, "Table.groupBy");
+    return Value(tableGroupBy(*t, args[1].asString(), args[2].asString(), args[3].asString()));
+}
+
+// Table.columns(table) -> [{name, type}, ...]
+Value dex_tableColumns(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto t = tableArg(args, 1, "Table.columns");
+    std::vector<Value> cols;
+    for (const auto& c : t->columns) {
+        std::unordered_map<std::string, Value> info;
+        info["name"] = Value(c.name);
+        info["type"] = Value(columnTypeName(c.type));
+        cols.push_back(Value(std::move(info)));
+    }
+    return Value(std::move(cols));
+}
+
+// Table.toRows(table) -> array of row objects. Materializes every cell,
+// so prefer the kernels above for large tables.
+Value dex_tableToRows(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto t = tableArg(args, 1, "Table.toRows");
+    std::vector<Value> rows;
+    rows.reserve(t->rowCount);
+    for (size_t i = 0; i < t->rowCount; ++i) rows.push_back(t->rowToDexValue(i));
+    return Value(std::move(rows));
+}
+
+void registerTableBindings(Interpreter& interp) {
+    interp.registerFunction("Table.sum", dex_tableSum);
+    interp.registerFunction("Table.min", dex_tableMin);
+    interp.registerFunction("Table.max", dex_tableMax);
+    interp.registerFunction("Table.count", dex_tableCount);
+    interp.registerFunction("Table.filter", dex_tableFilter);
+    interp.registerFunction("Table.groupBy", dex_tableGroupBy);
+    interp.registerFunction("Table.columns", dex_tableColumns);
+    interp.registerFunction("Table.toRows", dex_tableToRows);
+}
+
+} // namespace dex
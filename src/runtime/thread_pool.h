@@ -0,0 +1,55 @@
+// src/runtime/thread_pool.h
+#ifndef DEX_THREAD_POOL_H
+#define DEX_THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace dex {
+
+// Fixed-size worker pool for blocking runtime work (file reads, directory
+// scans, ...). Tasks run in FIFO order; the destructor drains the queue.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = 0); // 0 = hardware concurrency
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void post(std::function<void()> task);
+
+    template <typename F>
+    auto submit(F f) -> std::future<std::invoke_result_t<F>> {
+        using R = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<R()>>(std::move(f));
+        std::future<R> result = task->get_future();
+        post([task]() { (*task)(); });
+        return result;
+    }
+
+    size_t size() const { return workers.size(); }
+
+    // Process-wide pool shared by the runtime bindings.
+    static ThreadPool& shared();
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool stopping = false;
+
+    void run();
+};
+
+} // namespace dex
+
+#endif // DEX_THREAD_POOL_H
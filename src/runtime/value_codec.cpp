@@ -0,0 +1,188 @@
+// src/runtime/value_codec.cpp
+#include "value_codec.h"
+#include "table.h" // formatDouble
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace dex {
+
+namespace valuecodec {
+
+static void writeVarint(std::string& out, uint64_t v) {
+    char buf[10];
+    size_t n = 0;
+    while (v >= 0x80) {
+        buf[n++] = static_cast<char>((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    buf[n++] = static_cast<char>(v);
+    out.append(buf, n);
+}
+
+void writeHeader(std::string& out) {
+    out.append(magic, magicSize);
+}
+
+void writeNull(std::string& out) {
+    out.push_back(static_cast<char>(Null));
+}
+
+void writeText(std::string& out, std::string_view text) {
+    out.push_back(static_cast<char>(Text));
+    writeKey(out, text);
+}
+
+void writeInteger(std::string& out, int64_t v) {
+    out.push_back(static_cast<char>(Integer));
+    writeVarint(out, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+}
+
+void writeReal(std::string& out, double v) {
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    char buf[9];
+    buf[0] = static_cast<char>(Real);
+    for (int i = 0; i < 8; ++i) buf[1 + i] = static_cast<char>(bits >> (8 * i));
+    out.append(buf, sizeof(buf));
+}
+
+void writeArrayHeader(std::string& out, size_t count) {
+    out.push_back(static_cast<char>(Array));
+    writeVarint(out, count);
+}
+
+void writeObjectHeader(std::string& out, size_t count) {
+    out.push_back(static_cast<char>(Object));
+    writeVarint(out, count);
+}
+
+void writeKey(std::string& out, std::string_view key) {
+    writeVarint(out, key.size());
+    out.append(key.data(), key.size());
+}
+
+void writeValue(std::string& out, const Value& value) {
+    if (value.isNull()) {
+        writeNull(out);
+    } else if (value.isString()) {
+        writeText(out, value.asString());
+    } else if (value.isArray()) {
+        const auto& items = value.asArray();
+        writeArrayHeader(out, items.size());
+        for (const auto& item : items) writeValue(out, item);
+    } else if (value.isObject()) {
+        const auto& fields = value.asObject();
+        writeObjectHeader(out, fields.size());
+        for (const auto& [key, item] : fields) {
+            writeKey(out, key);
+            writeValue(out, item);
+        }
+    } else {
+        throw std::runtime_error("Cannot encode a " + value.toString() + " as a binary Value");
+    }
+}
+
+} // namespace valuecodec
+
+// Guards against stack exhaustion on corrupt or hostile input.
+static constexpr unsigned maxDepth = 256;
+
+ValueReader::ValueReader(const std::string& path, Compression compression)
+    : ValueReader(openSource(path, compression)) {}
+
+ValueReader::ValueReader(std::unique_ptr<ByteSource> src) : source(std::move(src)), buffer(1 << 16) {
+    char header[valuecodec::magicSize];
+    for (char& c : header) {
+        if (!fill()) throw std::runtime_error("Not a binary Value file (too short)");
+        c = buffer[pos++];
+    }
+    if (std::memcmp(header, valuecodec::magic, valuecodec::magicSize) != 0) {
+        throw std::runtime_error("Not a binary Value file (bad header)");
+    }
+}
+
+bool ValueReader::fill() {
+    if (pos < end) return true;
+    end = source->read(buffer.data(), buffer.size());
+    pos = 0;
+    return end > 0;
+}
+
+uint8_t ValueReader::byte() {
+    if (!fill()) throw std::runtime_error("Truncated binary Value file");
+    return static_cast<uint8_t>(buffer[pos++]);
+}
+
+uint64_t ValueReader::varint() {
+    uint64_t v = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t b = byte();
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    throw std::runtime_error("Corrupt binary Value file (varint too long)");
+}
+
+void ValueReader::bytes(std::string& out, size_t n) {
+    out.clear();
+    while (n > 0) {
+        if (!fill()) throw std::runtime_error("Truncated binary Value file");
+        size_t take = std::min(n, end - pos);
+        out.append(buffer.data() + pos, take);
+        pos += take;
+        n -= take;
+    }
+}
+
+Value ValueReader::decode(unsigned depth) {
+    if (depth > maxDepth) throw std::runtime_error("Corrupt binary Value file (nesting too deep)");
+    switch (byte()) {
+    case valuecodec::Null:
+        return Value();
+    case valuecodec::Text: {
+        std::string text;
+        bytes(text, varint());
+        return Value(std::move(text));
+    }
+    case valuecodec::Integer: {
+        uint64_t z = varint();
+        return Value(std::to_string(static_cast<int64_t>((z >> 1) ^ (~(z & 1) + 1))));
+    }
+    case valuecodec::Real: {
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) bits |= static_cast<uint64_t>(byte()) << (8 * i);
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return Value(formatDouble(v));
+    }
+    case valuecodec::Array: {
+        uint64_t n = varint();
+        std::vector<Value> items;
+        items.reserve(std::min<uint64_t>(n, 1 << 16)); // don't trust the count for the allocation
+        for (uint64_t i = 0; i < n; ++i) items.push_back(decode(depth + 1));
+        return Value(std::move(items));
+    }
+    case valuecodec::Object: {
+        uint64_t n = varint();
+        std::unordered_map<std::string, Value> fields;
+        std::string key;
+        for (uint64_t i = 0; i < n; ++i) {
+            bytes(key, varint());
+            fields[key] = decode(depth + 1);
+        }
+        return Value(std::move(fields));
+    }
+    default:
+        throw std::runtime_error("Corrupt binary Value file (unknown tag)");
+    }
+}
+
+bool ValueReader::next(Value& out) {
+    if (!fill()) return false;
+    out = decode(0);
+    ++count;
+    return true;
+}
+
+} // namespace dex
@@ -0,0 +1,80 @@
+// src/runtime/value_codec.h
+#ifndef DEX_VALUE_CODEC_H
+#define DEX_VALUE_CODEC_H
+
+#include "../interpreter/interpreter.h"
+#include "compression.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dex {
+
+// Binary Value format: the magic "DEXV" and a version byte, then encoded
+// Values back to back. Each value is a tag byte followed by its payload:
+//
+//   0 null
+//   1 text     varint byte length, bytes
+//   2 integer  zigzag varint
+//   3 real     8-byte little-endian IEEE double
+//   4 array    varint count, values
+//   5 object   varint count, (varint key length, key bytes, value) pairs
+//
+// Dex has no numeric Values, so integers and reals decode to their text
+// form; the typed tags keep files written from typed sources (query
+// results) compact and exact.
+namespace valuecodec {
+
+constexpr char magic[] = {'D', 'E', 'X', 'V', 1};
+constexpr size_t magicSize = sizeof(magic);
+
+enum Tag : uint8_t { Null = 0, Text = 1, Integer = 2, Real = 3, Array = 4, Object = 5 };
+
+void writeHeader(std::string& out);
+
+void writeNull(std::string& out);
+void writeText(std::string& out, std::string_view text);
+void writeInteger(std::string& out, int64_t v);
+void writeReal(std::string& out, double v);
+// Follow with `count` values (array) or `count` writeKey/value pairs (object).
+void writeArrayHeader(std::string& out, size_t count);
+void writeObjectHeader(std::string& out, size_t count);
+void writeKey(std::string& out, std::string_view key);
+
+// Strings are written as text. Throws std::runtime_error for native objects.
+void writeValue(std::string& out, const Value& value);
+
+} // namespace valuecodec
+
+// Reads the Values of a binary Value file one at a time, through a fixed
+// read buffer. Throws std::runtime_error on a bad header or truncated data.
+class ValueReader : public NativeIterator {
+public:
+    // Decompresses per `compression` (Auto: by extension).
+    explicit ValueReader(const std::string& path, Compression compression = Compression::Auto);
+    explicit ValueReader(std::unique_ptr<ByteSource> source);
+
+    bool next(Value& out) override;
+    std::string typeName() const override { return "ValueReader"; }
+
+    size_t valuesRead() const { return count; }
+
+private:
+    std::unique_ptr<ByteSource> source;
+    std::vector<char> buffer;
+    size_t pos = 0;
+    size_t end = 0;
+    size_t count = 0;
+
+    bool fill();
+    uint8_t byte();
+    uint64_t varint();
+    void bytes(std::string& out, size_t n);
+    Value decode(unsigned depth);
+};
+
+} // namespace dex
+
+#endif // DEX_VALUE_CODEC_H
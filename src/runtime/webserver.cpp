@@ -1,15 +1,883 @@
-#include "webserver.h"
-
-namespace dex {
-
-WebServer::WebServer(int p) : port(p) {}
-
-void WebServer::route(const std::string& path, const std::string& method, const std::string& handlerName) {
-    std::cout << "Route registered: " << method << " " << path << " -> " << handlerName << std::endl;
-}
-
-void WebServer::start() {
-    std::cout << "Starting server on port " << port << std::endl;
-}
-
-} // namespace dex
+#include "webserver.h"
+#include "binding_utils.h"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace dex {
+
+void HttpResponse::reset() {
+    status = 200;
+    contentType.assign("text/plain; charset=utf-8");
+    headers.clear();
+    body.clear();
+    close = false;
+}
+
+namespace {
+
+constexpr size_t bufferSize = 16 * 1024;
+constexpr size_t maxPooledBuffers = 1024;
+// A connection whose unsent output reaches this stops being read (and its
+// pipelined requests stop being answered) until the peer catches up.
+constexpr size_t outputHighWater = 256 * 1024;
+constexpr int maxEvents = 256;
+
+// Byte buffer with a read (head) and a write (tail) cursor.
+struct IoBuffer {
+    std::vector<char> bytes;
+    size_t head = 0;
+    size_t tail = 0;
+
+    size_t size() const { return tail - head; }
+    bool empty() const { return head == tail; }
+    const char* data() const { return bytes.data() + head; }
+    char* space() { return bytes.data() + tail; }
+    size_t spaceLeft() const { return bytes.size() - tail; }
+
+    void consume(size_t n) {
+        head += n;
+        if (head == tail) head = tail = 0;
+    }
+    // Makes room for `n` more bytes, compacting before growing.
+    void reserve(size_t n) {
+        if (spaceLeft() >= n) return;
+        if (head > 0) {
+            std::memmove(bytes.data(), bytes.data() + head, size());
+            tail -= head;
+            head = 0;
+        }
+        if (spaceLeft() < n) bytes.resize(std::max(bytes.size() * 2, tail + n));
+    }
+    void append(std::string_view s) {
+        reserve(s.size());
+        std::memcpy(space(), s.data(), s.size());
+        tail += s.size();
+    }
+    void appendNumber(size_t n) {
+        char digits[24];
+        auto res = std::to_chars(digits, digits + sizeof(digits), n);
+        append(std::string_view(digits, res.ptr - digits));
+    }
+};
+
+// Recycles buffer storage between the connections of one event loop.
+// Buffers that grew past the standard size for a large request or response
+// are freed rather than kept.
+class BufferPool {
+public:
+    void acquire(IoBuffer& b) {
+        if (!b.bytes.empty()) return;
+        if (spare.empty()) {
+            b.bytes.resize(bufferSize);
+        } else {
+            b.bytes = std::move(spare.back());
+            spare.pop_back();
+        }
+    }
+    // Takes the storage of a drained buffer back.
+    void release(IoBuffer& b) {
+        if (b.bytes.empty() || !b.empty()) return;
+        if (b.bytes.size() == bufferSize && spare.size() < maxPooledBuffers) spare.push_back(std::move(b.bytes));
+        b.bytes = std::vector<char>();
+        b.head = b.tail = 0;
+    }
+
+private:
+    std::vector<std::vector<char>> spare;
+};
+
+int64_t steadyMillis() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+const char* statusReason(int status) {
+    switch (status) {
+    case 100: return "Continue";
+    case 200: return "OK";
+    case 201: return "Created";
+    case 202: return "Accepted";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 303: return "See Other";
+    case 304: return "Not Modified";
+    case 307: return "Temporary Redirect";
+    case 308: return "Permanent Redirect";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 409: return "Conflict";
+    case 413: return "Content Too Large";
+    case 415: return "Unsupported Media Type";
+    case 422: return "Unprocessable Content";
+    case 429: return "Too Many Requests";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 502: return "Bad Gateway";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    default: return "";
+    }
+}
+
+std::string lowerAscii(std::string_view s) {
+    std::string out(s);
+    for (char& c : out) {
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+    }
+    return out;
+}
+
+std::string upperAscii(std::string s) {
+    for (char& c : s) {
+        if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+    }
+    return s;
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Decodes %XX escapes (and '+' as a space, as forms encode queries);
+// malformed escapes are kept as they are.
+std::string percentDecode(std::string_view s) {
+    std::string out;
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (s[i] == '+') {
+            out.push_back(' ');
+        } else if (s[i] == '%' && i + 2 < s.size() && hexDigit(s[i + 1]) >= 0 && hexDigit(s[i + 2]) >= 0) {
+            out.push_back(static_cast<char>(hexDigit(s[i + 1]) * 16 + hexDigit(s[i + 2])));
+            i += 2;
+        } else {
+            out.push_back(s[i]);
+        }
+    }
+    return out;
+}
+
+// "a=1&b=x%20y" -> {a: "1", b: "x y"}; a repeated key keeps its last value.
+Value queryToValue(std::string_view query) {
+    std::unordered_map<std::string, Value> params;
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view pair = query.substr(0, amp);
+        if (!pair.empty()) {
+            size_t eq = pair.find('=');
+            std::string value = eq == std::string_view::npos ? std::string() : percentDecode(pair.substr(eq + 1));
+            params[percentDecode(pair.substr(0, eq))] = Value(std::move(value));
+        }
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return Value(std::move(params));
+}
+
+// The object Dex handlers receive. Header names are lower-cased; repeated
+// headers are joined with ", ". Route parameters are passed as matched,
+// without percent-decoding.
+Value requestToValue(const HttpRequest& req) {
+    std::unordered_map<std::string, Value> headers;
+    headers.reserve(req.headerCount);
+    for (size_t i = 0; i < req.headerCount; ++i) {
+        const HttpHeader& h = req.headers[i];
+        auto [it, inserted] = headers.emplace(lowerAscii(h.name), Value(std::string(h.value)));
+        if (!inserted) it->second = Value(it->second.asString() + ", " + std::string(h.value));
+    }
+    std::unordered_map<std::string, Value> obj;
+    obj.emplace("method", Value(std::string(req.method)));
+    obj.emplace("target", Value(std::string(req.target)));
+    obj.emplace("path", Value(std::string(req.path)));
+    obj.emplace("queryString", Value(std::string(req.query)));
+    obj.emplace("query", queryToValue(req.query));
+    obj.emplace("version", Value(req.minorVersion == 0 ? "1.0" : "1.1"));
+    obj.emplace("headers", Value(std::move(headers)));
+    obj.emplace("body", Value(std::string(req.body)));
+    std::unordered_map<std::string, Value> params;
+    for (size_t i = 0; i < req.params.count; ++i) {
+        params.emplace(std::string(req.params.items[i].name), Value(std::string(req.params.items[i].value)));
+    }
+    obj.emplace("params", Value(std::move(params)));
+    return Value(std::move(obj));
+}
+
+void appendJson(std::string& out, const Value& v) {
+    if (v.isString()) {
+        out.push_back('"');
+        for (char c : v.asString()) {
+            switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    static const char hex[] = "0123456789abcdef";
+                    out += "\\u00";
+                    out.push_back(hex[(c >> 4) & 0xf]);
+                    out.push_back(hex[c & 0xf]);
+                } else {
+                    out.push_back(c);
+                }
+            }
+        }
+        out.push_back('"');
+    } else if (v.isNull()) {
+        out += "null";
+    } else if (v.isArray()) {
+        out.push_back('[');
+        bool first = true;
+        for (const auto& item : v.asArray()) {
+            if (!first) out.push_back(',');
+            appendJson(out, item);
+            first = false;
+        }
+        out.push_back(']');
+    } else if (v.isObject()) {
+        out.push_back('{');
+        bool first = true;
+        for (const auto& [key, item] : v.asObject()) {
+            if (!first) out.push_back(',');
+            appendJson(out, Value(key));
+            out.push_back(':');
+            appendJson(out, item);
+            first = false;
+        }
+        out.push_back('}');
+    } else {
+        throw std::runtime_error("Cannot send a " + v.toString() + " as JSON");
+    }
+}
+
+bool isResponseObject(const Value& v) {
+    if (!v.isObject()) return false;
+    const auto& obj = v.asObject();
+    return obj.count("status") || obj.count("body") || obj.count("headers");
+}
+
+// Turns a Dex handler's result into the response:
+//   null                 204 No Content
+//   string               200, text/plain
+//   {status, headers, body}
+//                        as given; a non-string body is sent as JSON
+//   any other array/object
+//                        200, application/json
+void applyResult(const Value& result, HttpResponse& res) {
+    if (result.isNull()) {
+        res.status = 204;
+    } else if (result.isString()) {
+        res.body = result.asString();
+    } else if (isResponseObject(result)) {
+        long long status = optionInt(result, "status", 200);
+        if (status < 100 || status > 599) throw std::runtime_error("Invalid HTTP status " + std::to_string(status));
+        res.status = static_cast<int>(status);
+        const Value* body = findOption(result, "body");
+        if (body && body->isString()) {
+            res.body = body->asString();
+        } else if (body) {
+            appendJson(res.body, *body);
+            res.contentType = "application/json";
+        }
+        const Value* headers = findOption(result, "headers");
+        if (headers && headers->isObject()) {
+            for (const auto& [name, value] : headers->asObject()) {
+                std::string text = value.toString();
+                bool valid = !name.empty() && text.find_first_of("\r\n") == std::string::npos &&
+                             name.find_first_of(" \t\r\n:") == std::string::npos;
+                if (!valid) throw std::runtime_error("Invalid response header '" + name + "'");
+                if (equalsIgnoreCase(name, "content-type")) {
+                    res.contentType = std::move(text);
+                } else if (!equalsIgnoreCase(name, "content-length") && !equalsIgnoreCase(name, "transfer-encoding")) {
+                    // framing headers are the server's to write
+                    res.headers.emplace_back(name, std::move(text));
+                }
+            }
+        }
+    } else {
+        appendJson(res.body, result);
+        res.contentType = "application/json";
+    }
+}
+
+// Listening socket for host:port, non-blocking.
+int openListener(const std::string& host, int port, int backlog, bool reusePort) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+    addrinfo* addrs = nullptr;
+    std::string service = std::to_string(port);
+    int rc = ::getaddrinfo(host.empty() ? nullptr : host.c_str(), service.c_str(), &hints, &addrs);
+    if (rc != 0) {
+        throw std::runtime_error("Cannot resolve " + host + ": " + ::gai_strerror(rc));
+    }
+    int err = 0;
+    int fd = -1;
+    for (addrinfo* a = addrs; a; a = a->ai_next) {
+        fd = ::socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, a->ai_protocol);
+        if (fd < 0) {
+            err = errno;
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (reusePort) ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+        if (::bind(fd, a->ai_addr, a->ai_addrlen) == 0 && ::listen(fd, backlog) == 0) break;
+        err = errno;
+        ::close(fd);
+        fd = -1;
+    }
+    ::freeaddrinfo(addrs);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot listen on " + host + ":" + service + ": " + std::strerror(err));
+    }
+    return fd;
+}
+
+// CPUs this process may run on, in order.
+std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+    for (int i = 0; i < CPU_SETSIZE; ++i) {
+        if (CPU_ISSET(i, &set)) cpus.push_back(i);
+    }
+    return cpus;
+}
+
+void pinCurrentThread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) != 0) {
+        std::cerr << "Warning: could not pin web worker to CPU " << cpu << std::endl;
+    }
+}
+
+int localPort(int fd) {
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) return 0;
+    if (addr.ss_family == AF_INET) return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+    if (addr.ss_family == AF_INET6) return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+    return 0;
+}
+
+} // namespace
+
+struct HttpConnection {
+    int fd = -1;
+    IoBuffer in;
+    IoBuffer out;
+    int64_t lastActiveMs = 0;
+    HttpConnection* prev = nullptr; // activity list, least recently active first
+    HttpConnection* next = nullptr;
+    bool closeAfterWrite = false; // send what's queued, then close
+    bool peerClosed = false;
+    bool readBlocked = false;     // output backlog; reading resumes once it drains
+    bool continueSent = false;
+};
+
+// One event loop: a listening socket, its connections and their buffers.
+class HttpWorker {
+public:
+    HttpWorker(WebServer& server, Interpreter& interp, int listenFd);
+    ~HttpWorker();
+
+    HttpWorker(const HttpWorker&) = delete;
+    HttpWorker& operator=(const HttpWorker&) = delete;
+
+    void run();
+
+private:
+    WebServer& server;
+    Interpreter& interp;
+    const WebServerOptions& options;
+    int listenFd;
+    int epollFd = -1;
+    BufferPool pool;
+    std::vector<std::unique_ptr<HttpConnection>> connections; // every one ever made
+    std::vector<HttpConnection*> spare;                       // closed, ready for reuse
+    HttpConnection* oldest = nullptr;
+    HttpConnection* newest = nullptr;
+    size_t open = 0;
+    int64_t now = 0;
+    uint64_t served = 0; // since last added to the server's count, once per wake-up
+    HttpRequest request;
+    HttpResponse response;
+    time_t dateSecond = -1;
+    char dateText[64];
+    size_t dateLength = 0;
+
+    void acceptConnections();
+    void onEvent(HttpConnection& c, uint32_t events);
+    void serve(HttpConnection& c);
+    void answerBuffered(HttpConnection& c);
+    bool flush(HttpConnection& c);
+    void closeConnection(HttpConnection& c);
+    void touch(HttpConnection& c);
+    void unlink(HttpConnection& c);
+    void closeIdle();
+    void handle(HttpRequest& req, HttpResponse& res);
+    void writeResponse(HttpConnection& c, const HttpResponse& res, bool keepAlive, bool http10, bool headOnly);
+    std::string_view date();
+};
+
+HttpWorker::HttpWorker(WebServer& srv, Interpreter& in, int fd)
+    : server(srv), interp(in), options(srv.options), listenFd(fd) {
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) throw std::runtime_error(std::string("epoll_create1 failed: ") + std::strerror(errno));
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = &listenFd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    ev.data.ptr = &server.wakeFd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, server.wakeFd, &ev);
+}
+
+HttpWorker::~HttpWorker() {
+    while (oldest) closeConnection(*oldest);
+    ::close(epollFd);
+}
+
+void HttpWorker::run() {
+    epoll_event events[maxEvents];
+    now = steadyMillis();
+    int64_t lastSweep = now;
+    while (!server.stopping.load(std::memory_order_acquire)) {
+        int n = ::epoll_wait(epollFd, events, maxEvents, 1000);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+        }
+        now = steadyMillis();
+        for (int i = 0; i < n; ++i) {
+            void* tag = events[i].data.ptr;
+            if (tag == &listenFd) {
+                acceptConnections();
+            } else if (tag != &server.wakeFd) { // the wake-up only needs the loop condition re-checked
+                onEvent(*static_cast<HttpConnection*>(tag), events[i].events);
+            }
+        }
+        if (served) {
+            server.served.fetch_add(served, std::memory_order_relaxed);
+            served = 0;
+        }
+        if (now - lastSweep >= 1000) {
+            closeIdle();
+            lastSweep = now;
+        }
+    }
+}
+
+void HttpWorker::acceptConnections() {
+    for (;;) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "Runtime Error: accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        if (open >= options.maxConnections) {
+            ::close(fd);
+            continue;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        HttpConnection* c;
+        if (spare.empty()) {
+            connections.push_back(std::make_unique<HttpConnection>());
+            c = connections.back().get();
+        } else {
+            c = spare.back();
+            spare.pop_back();
+        }
+        *c = HttpConnection();
+        c->fd = fd;
+        // Edge-triggered: each socket is registered once, for both directions.
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = c;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            ::close(fd);
+            spare.push_back(c);
+            continue;
+        }
+        ++open;
+        touch(*c);
+    }
+}
+
+void HttpWorker::onEvent(HttpConnection& c, uint32_t events) {
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        closeConnection(c);
+        return;
+    }
+    if ((events & EPOLLOUT) && !c.out.empty()) {
+        if (!flush(c)) {
+            closeConnection(c);
+            return;
+        }
+        touch(c);
+    }
+    if ((events & (EPOLLIN | EPOLLRDHUP)) || (c.readBlocked && c.out.size() < outputHighWater)) {
+        serve(c);
+    } else if (c.out.empty() && (c.closeAfterWrite || c.peerClosed)) {
+        closeConnection(c);
+    } else if (c.out.empty()) {
+        pool.release(c.out);
+    }
+}
+
+// Reads until the socket is drained, answering every complete request as
+// it arrives, then writes the responses out.
+void HttpWorker::serve(HttpConnection& c) {
+    touch(c);
+    c.readBlocked = false;
+    for (;;) {
+        answerBuffered(c);
+        if (c.closeAfterWrite) break;
+        if (c.out.size() >= outputHighWater) {
+            if (!flush(c)) {
+                closeConnection(c);
+                return;
+            }
+            if (c.out.size() >= outputHighWater) {
+                c.readBlocked = true; // EPOLLOUT resumes us
+                break;
+            }
+            continue;
+        }
+        if (c.peerClosed) break;
+        pool.acquire(c.in);
+        c.in.reserve(bufferSize / 4);
+        ssize_t n = ::recv(c.fd, c.in.space(), c.in.spaceLeft(), 0);
+        if (n > 0) {
+            c.in.tail += static_cast<size_t>(n);
+        } else if (n == 0) {
+            c.peerClosed = true; // answer what's complete, then close
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
+            closeConnection(c);
+            return;
+        }
+    }
+    if (!flush(c)) {
+        closeConnection(c);
+        return;
+    }
+    if (c.out.empty() && (c.closeAfterWrite || c.peerClosed)) {
+        closeConnection(c);
+        return;
+    }
+    if (c.in.empty()) pool.release(c.in);
+    if (c.out.empty()) pool.release(c.out);
+}
+
+// Answers the complete requests at the front of the read buffer, in order.
+void HttpWorker::answerBuffered(HttpConnection& c) {
+    while (!c.in.empty() && !c.closeAfterWrite && c.out.size() < outputHighWater) {
+        HttpParseResult r = parseHttpRequest(c.in.data(), c.in.size(), request, options.limits);
+        if (r.status == HttpParseStatus::Incomplete) {
+            if (r.headBytes && request.expectContinue && !c.continueSent) {
+                pool.acquire(c.out);
+                c.out.append("HTTP/1.1 100 Continue\r\n\r\n");
+                c.continueSent = true;
+            }
+            return;
+        }
+        if (r.status == HttpParseStatus::Error) {
+            response.reset();
+            response.status = r.errorStatus;
+            response.body.assign(statusReason(r.errorStatus)).push_back('\n');
+            writeResponse(c, response, false, false, false);
+            c.in.consume(c.in.size());
+            c.closeAfterWrite = true;
+            return;
+        }
+        response.reset();
+        handle(request, response);
+        bool keepAlive = request.keepAlive && !response.close && !server.stopping.load(std::memory_order_relaxed);
+        writeResponse(c, response, keepAlive, request.minorVersion == 0, request.method == "HEAD");
+        c.in.consume(r.consumed);
+        c.continueSent = false;
+        if (!keepAlive) c.closeAfterWrite = true;
+        ++served;
+    }
+}
+
+void HttpWorker::handle(HttpRequest& req, HttpResponse& res) {
+    const WebServer::Route* route = server.findRoute(req.method, req.path, req.params);
+    if (!route && req.method == "HEAD") route = server.findRoute("GET", req.path, req.params);
+    if (!route) {
+        std::string allow = server.allowedMethods(req.path);
+        res.status = allow.empty() ? 404 : 405;
+        res.body.assign(statusReason(res.status)).push_back('\n');
+        if (!allow.empty()) res.headers.emplace_back("Allow", std::move(allow));
+        return;
+    }
+    try {
+        if (route->native) {
+            route->native(req, res);
+        } else {
+            applyResult(interp.callFunction(route->handlerName, {requestToValue(req)}), res);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Runtime Error: handler for " << req.method << " " << req.path << " failed: " << e.what()
+                  << std::endl;
+        res.reset();
+        res.status = 500;
+        res.body.assign(statusReason(500)).push_back('\n');
+    }
+}
+
+void HttpWorker::writeResponse(HttpConnection& c, const HttpResponse& res, bool keepAlive, bool http10, bool headOnly) {
+    pool.acquire(c.out);
+    IoBuffer& out = c.out;
+    bool bodyless = res.status < 200 || res.status == 204 || res.status == 304;
+    out.append("HTTP/1.1 ");
+    out.appendNumber(static_cast<size_t>(res.status));
+    out.append(" ");
+    out.append(statusReason(res.status));
+    out.append("\r\nServer: dex\r\nDate: ");
+    out.append(date());
+    out.append("\r\n");
+    if (!bodyless) {
+        if (!res.contentType.empty()) {
+            out.append("Content-Type: ");
+            out.append(res.contentType);
+            out.append("\r\n");
+        }
+        out.append("Content-Length: ");
+        out.appendNumber(res.body.size());
+        out.append("\r\n");
+    }
+    if (!keepAlive) {
+        out.append("Connection: close\r\n");
+    } else if (http10) {
+        out.append("Connection: keep-alive\r\n");
+    }
+    for (const auto& [name, value] : res.headers) {
+        out.append(name);
+        out.append(": ");
+        out.append(value);
+        out.append("\r\n");
+    }
+    out.append("\r\n");
+    if (!bodyless && !headOnly) out.append(res.body);
+}
+
+bool HttpWorker::flush(HttpConnection& c) {
+    while (!c.out.empty()) {
+        ssize_t n = ::send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+        if (n > 0) {
+            c.out.consume(static_cast<size_t>(n));
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true; // EPOLLOUT follows once there's room
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HttpWorker::closeConnection(HttpConnection& c) {
+    unlink(c);
+    ::close(c.fd); // also removes it from the epoll set
+    c.fd = -1;
+    c.in.head = c.in.tail = 0;
+    c.out.head = c.out.tail = 0;
+    pool.release(c.in);
+    pool.release(c.out);
+    --open;
+    spare.push_back(&c);
+}
+
+// Moves `c` to the newest end of the activity list.
+void HttpWorker::touch(HttpConnection& c) {
+    c.lastActiveMs = now;
+    if (newest == &c) return;
+    unlink(c);
+    c.prev = newest;
+    if (newest) newest->next = &c;
+    newest = &c;
+    if (!oldest) oldest = &c;
+}
+
+void HttpWorker::unlink(HttpConnection& c) {
+    if (c.prev) c.prev->next = c.next;
+    if (c.next) c.next->prev = c.prev;
+    if (oldest == &c) oldest = c.next;
+    if (newest == &c) newest = c.prev;
+    c.prev = c.next = nullptr;
+}
+
+void HttpWorker::closeIdle() {
+    while (oldest && now - oldest->lastActiveMs >= options.idleTimeoutMs) closeConnection(*oldest);
+}
+
+std::string_view HttpWorker::date() {
+    time_t t = std::time(nullptr);
+    if (t != dateSecond) {
+        tm utc;
+        ::gmtime_r(&t, &utc);
+        dateLength = std::strftime(dateText, sizeof(dateText), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+        dateSecond = t;
+    }
+    return std::string_view(dateText, dateLength);
+}
+
+WebServer::WebServer(int p, WebServerOptions opts) : port(p), options(std::move(opts)) {
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd < 0) throw std::runtime_error(std::string("eventfd failed: ") + std::strerror(errno));
+}
+
+WebServer::~WebServer() {
+    ::close(wakeFd);
+}
+
+void WebServer::route(const std::string& path, const std::string& method, const std::string& handlerName) {
+    Route r{Value(handlerName), nullptr};
+    size_t id = router.insert(upperAscii(method), path, routes.size());
+    if (id == routes.size()) routes.push_back(std::move(r));
+    else routes[id] = std::move(r);
+}
+
+void WebServer::route(const std::string& path, const std::string& method, HttpHandler handler) {
+    Route r{Value(), std::move(handler)};
+    size_t id = router.insert(upperAscii(method), path, routes.size());
+    if (id == routes.size()) routes.push_back(std::move(r));
+    else routes[id] = std::move(r);
+}
+
+const WebServer::Route* WebServer::findRoute(std::string_view method, std::string_view path, RouteParams& params) const {
+    size_t id = router.match(method, path, params);
+    return id == Router::npos ? nullptr : &routes[id];
+}
+
+std::string WebServer::allowedMethods(std::string_view path) const {
+    std::string allow;
+    bool get = false, head = false;
+    RouteParams scratch;
+    for (std::string_view method : router.methods()) {
+        if (router.match(method, path, scratch) == Router::npos) continue;
+        if (!allow.empty()) allow += ", ";
+        allow += method;
+        get = get || method == "GET";
+        head = head || method == "HEAD";
+    }
+    if (get && !head) allow += ", HEAD";
+    return allow;
+}
+
+void WebServer::start(Interpreter& interp) {
+    if (running.exchange(true)) throw std::runtime_error("WebServer is already running");
+    stopping.store(false);
+    uint64_t pending;
+    (void)!::read(wakeFd, &pending, sizeof(pending)); // drop a stop() from a previous run
+
+    struct Reset {
+        WebServer& s;
+        std::vector<int> fds;
+        ~Reset() {
+            for (int fd : fds) ::close(fd);
+            s.boundPort.store(0);
+            s.running.store(false);
+        }
+    } reset{*this, {}};
+
+    unsigned count = options.workers ? options.workers : std::max(1u, std::thread::hardware_concurrency());
+    // The first listener resolves port 0; the rest join it on the same port.
+    reset.fds.push_back(openListener(options.host, port, options.backlog, count > 1));
+    int actualPort = localPort(reset.fds[0]);
+    for (unsigned i = 1; i < count; ++i) {
+        reset.fds.push_back(openListener(options.host, actualPort, options.backlog, true));
+    }
+    boundPort.store(actualPort, std::memory_order_release);
+
+    // Snapshot the isolates before any worker runs a handler on `interp`.
+    std::vector<std::unique_ptr<Interpreter>> isolates;
+    for (unsigned i = 1; i < count; ++i) isolates.push_back(interp.isolate());
+    std::vector<int> cpus = options.pinWorkers ? allowedCpus() : std::vector<int>();
+
+    std::cout << "Listening on http://" << options.host << ":" << actualPort;
+    if (count > 1) std::cout << " with " << count << " workers";
+    std::cout << std::endl;
+
+    std::mutex errorMutex;
+    std::string error;
+    auto runWorker = [&](Interpreter& isolate, int fd, unsigned index) {
+        try {
+            if (!cpus.empty()) pinCurrentThread(cpus[index % cpus.size()]);
+            HttpWorker worker(*this, isolate, fd);
+            worker.run();
+        } catch (const std::exception& e) {
+            {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (error.empty()) error = e.what();
+            }
+            stop(); // one worker failing takes the server down
+        }
+    };
+
+    std::vector<std::thread> threads;
+    try {
+        for (unsigned i = 1; i < count; ++i) {
+            threads.emplace_back(runWorker, std::ref(*isolates[i - 1]), reset.fds[i], i);
+        }
+    } catch (const std::system_error& e) {
+        stop();
+        for (auto& t : threads) t.join();
+        throw std::runtime_error(std::string("Cannot start web workers: ") + e.what());
+    }
+
+    cpu_set_t savedAffinity;
+    bool restoreAffinity = !cpus.empty() &&
+                           ::pthread_getaffinity_np(::pthread_self(), sizeof(savedAffinity), &savedAffinity) == 0;
+    runWorker(interp, reset.fds[0], 0);
+    for (auto& t : threads) t.join();
+    if (restoreAffinity) ::pthread_setaffinity_np(::pthread_self(), sizeof(savedAffinity), &savedAffinity);
+    if (!error.empty()) throw std::runtime_error(error);
+}
+
+void WebServer::stop() {
+    stopping.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    (void)!::write(wakeFd, &one, sizeof(one));
+}
+
+} // namespace dex
@@ -1,20 +1,123 @@
-#ifndef DEX_WEBSERVER_H
-#define DEX_WEBSERVER_H
-
-#include <string>
-#include <iostream>
-
-namespace dex {
-
-class WebServer {
-public:
-    WebServer(int port);
-    void route(const std::string& path, const std::string& method, const std::string& handlerName);
-    void start();
-private:
-    int port;
-};
-
-} // namespace dex
-
-#endif // DEX_WEBSERVER_H
+#ifndef DEX_WEBSERVER_H
+#define DEX_WEBSERVER_H
+
+#include "../interpreter/interpreter.h"
+#include "http_parser.h"
+#include "router.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace dex {
+
+// Response a handler fills in. The server reuses one per event loop, so
+// the strings keep their capacity from request to request.
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "text/plain; charset=utf-8";
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+    bool close = false; // close the connection after this response
+
+    void reset();
+};
+
+using HttpHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
+
+struct WebServerOptions {
+    std::string host = "0.0.0.0";
+    int backlog = 1024;
+    int idleTimeoutMs = 5000;     // keep-alive connections idle this long are closed
+    size_t maxConnections = 10000; // per worker
+    HttpLimits limits;
+    // Event loops, each on its own thread with its own SO_REUSEPORT listener
+    // and interpreter isolate; 0 means one per core.
+    unsigned workers = 1;
+    bool pinWorkers = false; // pin worker i to the i-th CPU the process may use
+};
+
+class HttpWorker;
+
+// Non-blocking HTTP/1.1 server on epoll. start() runs the event loop on the
+// calling thread: connections are kept alive and pipelined requests are
+// answered in order with one write, requests are parsed in place in the
+// connection's read buffer, and read/write buffers come from a pool and
+// go back to it whenever a connection has nothing buffered, so idle
+// keep-alive connections cost no buffer memory.
+//
+// With options.workers > 1 each worker thread runs its own loop on its own
+// listener bound with SO_REUSEPORT, so the kernel spreads connections over
+// the workers and they share nothing on the request path. Dex handlers run
+// on the worker's own isolate of the interpreter passed to start().
+//
+// Routes are resolved by a per-method radix tree (see Router), so paths may
+// have `:param` and `*wildcard` segments; handlers get the captured values
+// in HttpRequest::params. HEAD falls back to the GET route (the body is
+// dropped); unmatched paths get 404, or 405 when the path is routed for
+// other methods.
+class WebServer : public NativeObject {
+public:
+    explicit WebServer(int port, WebServerOptions options = WebServerOptions());
+    ~WebServer() override;
+
+    WebServer(const WebServer&) = delete;
+    WebServer& operator=(const WebServer&) = delete;
+
+    std::string typeName() const override { return "WebServer"; }
+
+    // Routes `method` requests matching `path` to the Dex function
+    // `handlerName`, called through the interpreter passed to start() with
+    // the request as an object; its result becomes the response (see
+    // webserver.cpp). Interpreter::callFunction only finds registered
+    // native functions, so that is what a handler has to be for now. Routing a pattern again replaces its handler. Throws
+    // std::runtime_error for a malformed pattern (see Router::insert).
+    void route(const std::string& path, const std::string& method, const std::string& handlerName);
+    // Routes to a native handler, bypassing the interpreter.
+    void route(const std::string& path, const std::string& method, HttpHandler handler);
+
+    // Serves until stop(); the calling thread runs the first worker, with
+    // `interp`. Routes must not change while serving, and native handlers
+    // must be thread-safe when there are several workers. Throws
+    // std::runtime_error if the address can't be bound, a worker fails or
+    // the server is already running.
+    void start(Interpreter& interp);
+    // Makes start() return once in-flight work on the loops finishes. Safe
+    // to call from any thread.
+    void stop();
+
+    // Port being listened on (resolves port 0), or 0 when not started.
+    int listeningPort() const { return boundPort.load(std::memory_order_acquire); }
+    uint64_t requestsServed() const { return served.load(std::memory_order_relaxed); }
+
+    struct Route {
+        Value handlerName; // Dex function, when `native` is empty
+        HttpHandler native;
+    };
+
+    // Route for `method` and `path`, or nullptr, with its parameters in
+    // `params`. No allocation.
+    const Route* findRoute(std::string_view method, std::string_view path, RouteParams& params) const;
+    // Comma-separated methods routed for `path` (for 405's Allow header).
+    std::string allowedMethods(std::string_view path) const;
+
+private:
+    friend class HttpWorker;
+
+    int port;
+    WebServerOptions options;
+    Router router; // method + pattern -> index into `routes`
+    std::vector<Route> routes;
+    int wakeFd = -1; // eventfd that wakes every loop for stop()
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<int> boundPort{0};
+    std::atomic<uint64_t> served{0};
+};
+
+} // namespace dex
+
+#endif // DEX_WEBSERVER_H
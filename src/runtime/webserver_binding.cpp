@@ -0,0 +1,117 @@
+#include "webserver.h"
+#include "binding_utils.h"
+#include "../interpreter/interpreter.h"
+#include <cstdlib>
+#include <stdexcept>
+#include <iostream>
+
+namespace dex {
+
+static std::shared_ptr<WebServer> serverArg(const std::vector<Value>& args, size_t minArgs, const char* name) {
+    auto server = args.size() >= minArgs ? args[0].asNative<WebServer>() : nullptr;
+    if (!server) {
+        std::cerr << "Runtime Error: " << name << " expects a WebServer as its first argument." << std::endl;
+        throw std::runtime_error(std::string(name) + " expects a WebServer as its first argument");
+    }
+    for (size_t i = 1; i < minArgs; ++i) {
+        if (!args[i].isString()) {
+            std::cerr << "Runtime Error: " << name << " expects string arguments after the WebServer." << std::endl;
+            throw std::runtime_error(std::string(name) + " expects string arguments after the WebServer");
+        }
+    }
+    return server;
+}
+
+// WebServer.create(port, options) -> server. Options: host ("0.0.0.0"),
+// backlog, idleTimeout (ms a keep-alive connection may sit idle, 5000),
+// maxConnections, maxHeaderBytes, maxBodyBytes, workers (event loop
+// threads, "0" for one per core; default 1) and pin (pin workers to CPUs).
+Value dex_webCreate(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    long long port = -1;
+    if (!args.empty() && args[0].isString() && !args[0].asString().empty()) {
+        char* end = nullptr;
+        port = std::strtoll(args[0].asString().c_str(), &end, 10);
+        if (*end != '\0') port = -1;
+    }
+    if (port < 0 || port > 65535) {
+        std::cerr << "Runtime Error: WebServer.create expects a port between 0 and 65535." << std::endl;
+        throw std::runtime_error("WebServer.create expects a port between 0 and 65535");
+    }
+    Value options = args.size() > 1 ? args[1] : Value::nil();
+    WebServerOptions opts;
+    opts.host = optionString(options, "host", opts.host);
+    opts.backlog = static_cast<int>(optionInt(options, "backlog", opts.backlog));
+    opts.idleTimeoutMs = static_cast<int>(optionInt(options, "idleTimeout", opts.idleTimeoutMs));
+    opts.maxConnections = static_cast<size_t>(optionInt(options, "maxConnections", opts.maxConnections));
+    opts.limits.maxHeadBytes = static_cast<size_t>(optionInt(options, "maxHeaderBytes", opts.limits.maxHeadBytes));
+    opts.limits.maxBodyBytes = static_cast<size_t>(optionInt(options, "maxBodyBytes", opts.limits.maxBodyBytes));
+    long long workers = optionInt(options, "workers", opts.workers);
+    if (workers < 0 || workers > 1024) {
+        std::cerr << "Runtime Error: WebServer.create expects 0 to 1024 workers." << std::endl;
+        throw std::runtime_error("WebServer.create expects 0 to 1024 workers");
+    }
+    opts.workers = static_cast<unsigned>(workers);
+    opts.pinWorkers = optionBool(options, "pin", opts.pinWorkers);
+    return Value(std::make_shared<WebServer>(static_cast<int>(port), std::move(opts)));
+}
+
+// WebServer.route(server, path, method, handler). `path` may contain
+// `:name` and `*name` segments, e.g. "/users/:id" or "/files/*path".
+// `handler` names a function taking the request object ({method, path,
+// params, query, queryString, target, version, headers, body}) and
+// returning a string (200 text), an object or array (200 JSON), null (204)
+// or {status, headers, body}. It must be a native function registered with
+// the interpreter: script-defined `func` values can't be called yet, and
+// naming one makes every request to the route answer 500 (see
+// examples/hello_web.cpp).
+Value dex_webRoute(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    auto server = serverArg(args, 4, "WebServer.route");
+    try {
+        server->route(args[1].asString(), args[2].asString(), args[3].asString());
+    } catch (const std::exception& e) {
+        std::cerr << "Runtime Error: " << e.what() << std::endl;
+        throw;
+    }
+    return Value::nil();
+}
+
+// WebServer.start(server): serves until WebServer.stop. With one worker,
+// handlers run on the calling thread; other workers run them on their own
+// isolate of this interpreter, snapshotted when start is called. Refuses
+// to start several workers while a Database.begin transaction is the
+// current connection, since every worker would share its one connection.
+Value dex_webStart(Interpreter& interp, const std::vector<Value>& args) {
+    auto server = serverArg(args, 1, "WebServer.start");
+    try {
+        server->start(interp);
+    } catch (const std::exception& e) {
+        std::cerr << "Runtime Error: " << e.what() << std::endl;
+        throw;
+    }
+    return Value::nil();
+}
+
+// WebServer.stop(server), e.g. from a handler.
+Value dex_webStop(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    serverArg(args, 1, "WebServer.stop")->stop();
+    return Value::nil();
+}
+
+// WebServer.port(server) -> port being listened on, "0" when not started.
+Value dex_webPort(Interpreter& interp, const std::vector<Value>& args) {
+    (void)interp;
+    return Value(std::to_string(serverArg(args, 1, "WebServer.port")->listeningPort()));
+}
+
+void registerWebServerBindings(Interpreter& interp) {
+    interp.registerFunction("WebServer.create", dex_webCreate);
+    interp.registerFunction("WebServer.route", dex_webRoute);
+    interp.registerFunction("WebServer.start", dex_webStart);
+    interp.registerFunction("WebServer.stop", dex_webStop);
+    interp.registerFunction("WebServer.port", dex_webPort);
+}
+
+} // namespace dex
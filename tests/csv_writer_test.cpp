@@ -0,0 +1,102 @@
+#include "../src/interpreter/interpreter.h"
+#include "../src/runtime/compression.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// FileIO.writeCSV: the returned count covers data rows only, and appending
+// to a non-empty file doesn't repeat the header, for plain and gzip output.
+// A one-column file keeps its empty cells through a write and read back.
+// Usage: csv_writer_test [scratch-dir]
+
+namespace dex {
+void registerFileIOBindings(Interpreter&);
+}
+
+using dex::Value;
+using Object = std::unordered_map<std::string, Value>;
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+static Value rows(std::initializer_list<std::pair<const char*, const char*>> values) {
+    std::vector<Value> out;
+    for (const auto& [a, b] : values) out.push_back(Value(Object{{"a", Value(a)}, {"b", Value(b)}}));
+    return Value(std::move(out));
+}
+
+// The file's text, decompressed.
+static std::string contents(const std::string& path) {
+    auto source = dex::openSource(path);
+    std::string out;
+    char buf[4096];
+    while (size_t n = source->read(buf, sizeof buf)) out.append(buf, n);
+    return out;
+}
+
+static void headerAndAppend(dex::Interpreter& interp, const std::string& path) {
+    std::remove(path.c_str());
+    const Value append(Object{{"append", Value("true")}});
+
+    Value n = interp.callFunction(Value("FileIO.writeCSV"), {Value(path), rows({{"1", "x"}, {"2", "y"}})});
+    check(n.isString() && n.asString() == "2", path + ": new file counts data rows only");
+    n = interp.callFunction(Value("FileIO.writeCSV"), {Value(path), rows({{"3", "z"}}), append});
+    check(n.isString() && n.asString() == "1", path + ": append counts data rows only");
+    check(contents(path) == "a,b\n1,x\n2,y\n3,z\n", path + ": one header, then every row");
+
+    Value table = interp.callFunction(Value("FileIO.loadTable"), {Value(path)});
+    n = interp.callFunction(Value("FileIO.writeCSV"), {Value(path), table, append});
+    check(n.isString() && n.asString() == "3", path + ": appending a Table counts its rows");
+    check(contents(path) == "a,b\n1,x\n2,y\n3,z\n1,x\n2,y\n3,z\n", path + ": Table appended without its header");
+
+    std::remove(path.c_str());
+    n = interp.callFunction(Value("FileIO.writeCSV"), {Value(path), rows({{"4", "w"}}), append});
+    check(n.isString() && n.asString() == "1", path + ": appending to a missing file writes the header, uncounted");
+    check(contents(path) == "a,b\n4,w\n", path + ": header written for a missing file");
+    std::remove(path.c_str());
+}
+
+// The cells of column "a" read back with FileIO.openCSV.
+static std::vector<std::string> readColumn(dex::Interpreter& interp, const std::string& path) {
+    Value reader = interp.callFunction(Value("FileIO.openCSV"), {Value(path), Value(Object{{"header", Value("true")}})});
+    std::vector<std::string> out;
+    for (;;) {
+        Value row = interp.callFunction(Value("FileIO.next"), {reader});
+        if (row.isNull()) break;
+        out.push_back(row.asObject().at("a").isNull() ? "<null>" : row.asObject().at("a").asString());
+    }
+    return out;
+}
+
+static void oneColumn(dex::Interpreter& interp, const std::string& path) {
+    std::vector<Value> cells;
+    for (const char* a : {"x", "", "y"}) cells.push_back(Value(Object{{"a", Value(a)}}));
+    Value n = interp.callFunction(Value("FileIO.writeCSV"), {Value(path), Value(std::move(cells))});
+    check(n.isString() && n.asString() == "3", path + ": one-column rows written");
+    check(contents(path) == "a\nx\n\"\"\ny\n", path + ": lone empty cell quoted");
+    std::vector<std::string> read = readColumn(interp, path);
+    check(read.size() == 3 && read[0] == "x" && read[1] == "" && read[2] == "y", path + ": empty cell read back as a row");
+
+    interp.callFunction(Value("FileIO.writeFile"), {Value(path), Value("a\nx\n\ny\n")});
+    check(readColumn(interp, path).size() == 3, path + ": blank line is an empty cell in a one-column file");
+    interp.callFunction(Value("FileIO.writeFile"), {Value(path), Value("a,b\n1,x\n\n2,y\n")});
+    check(readColumn(interp, path).size() == 2, path + ": blank line skipped with several columns");
+    std::remove(path.c_str());
+}
+
+int main(int argc, char** argv) {
+    std::string dir = argc > 1 ? argv[1] : ".";
+    dex::Interpreter interp;
+    dex::registerFileIOBindings(interp);
+    headerAndAppend(interp, dir + "/csv_writer_test.csv");
+    headerAndAppend(interp, dir + "/csv_writer_test.csv.gz");
+    oneColumn(interp, dir + "/csv_writer_test.csv");
+    std::cout << (failures ? "FAILED\n" : "all passed\n");
+    return failures ? 1 : 0;
+}
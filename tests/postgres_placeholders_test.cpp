@@ -0,0 +1,55 @@
+#include "../src/runtime/postgres_database.h"
+#include <iostream>
+#include <string>
+
+// PostgresDatabase::numberPlaceholders: which `?` become $n and which SQL
+// passes through untouched. Needs no server.
+// Usage: postgres_placeholders_test
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+static void expect(const std::string& sql, const std::string& want, const std::string& what) {
+    std::string got = dex::PostgresDatabase::numberPlaceholders(sql);
+    check(got == want, what);
+    if (got != want) std::cout << "     got:  " << got << "\n     want: " << want << "\n";
+}
+
+int main() {
+    expect("SELECT * FROM t WHERE a = ? AND b IN (?, ?)", "SELECT * FROM t WHERE a = $1 AND b IN ($2, $3)",
+           "plain placeholders");
+    expect("SELECT '?', \"a?\" FROM t WHERE x = ?", "SELECT '?', \"a?\" FROM t WHERE x = $1",
+           "quoted literal and identifier");
+    expect("SELECT 'it''s ?' || ?", "SELECT 'it''s ?' || $1", "doubled quote inside a literal");
+    expect("SELECT 1 -- why?\nWHERE x = ?", "SELECT 1 -- why?\nWHERE x = $1", "line comment");
+
+    expect("SELECT /* what? */ ?", "SELECT /* what? */ $1", "block comment");
+    expect("SELECT /* a /* nested? */ still? */ ?", "SELECT /* a /* nested? */ still? */ $1",
+           "nested block comment");
+    expect("SELECT 1 /* unterminated ?", "SELECT 1 /* unterminated ?", "unterminated block comment");
+
+    expect("SELECT $$what?$$, ?", "SELECT $$what?$$, $1", "$$ dollar quote");
+    expect("SELECT $fn$ it's ? $$ $fn$, ?", "SELECT $fn$ it's ? $$ $fn$, $1", "tagged dollar quote");
+    expect("SELECT $1, ?", "SELECT $1, $1", "$1 is not a dollar quote");
+    expect("SELECT a$b$c FROM t WHERE x = ?", "SELECT a$b$c FROM t WHERE x = $1", "$ inside an identifier");
+
+    expect("SELECT E'it\\'s ?', ?", "SELECT E'it\\'s ?', $1", "E-string with an escaped quote");
+    expect("SELECT e'\\\\', ?", "SELECT e'\\\\', $1", "E-string ending in an escaped backslash");
+    expect("SELECT 'a\\', ?", "SELECT 'a\\', $1", "backslash in a standard string");
+    expect("SELECT name'x', ?", "SELECT name'x', $1", "E-suffixed identifier is not an E-string");
+
+    expect("SELECT * FROM t WHERE data ?? 'k' AND id = ?", "SELECT * FROM t WHERE data ? 'k' AND id = $1",
+           "jsonb ? written ??");
+    expect("SELECT * FROM t WHERE data ?| array['a'] AND id = ?",
+           "SELECT * FROM t WHERE data ?| array['a'] AND id = $1", "jsonb ?|");
+    expect("SELECT * FROM t WHERE data ?& array['a'] AND id = ?",
+           "SELECT * FROM t WHERE data ?& array['a'] AND id = $1", "jsonb ?&");
+    expect("SELECT ?||'x', ?&&array[1]", "SELECT $1||'x', $2&&array[1]", "placeholder before || and &&");
+
+    std::cout << (failures ? "FAILED\n" : "all passed\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+#include "../src/runtime/router.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Route resolution over an API-shaped route table (literal, `:param` and
+// `*wildcard` routes across several methods): Router against a linear scan
+// that matches every pattern segment by segment. Also counts heap
+// allocations made by Router::match, which should be none.
+// Usage: router_bench [routes] [lookups]
+
+static std::atomic<size_t> allocations{0};
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+struct RouteSpec {
+    std::string method;
+    std::string pattern;
+};
+
+struct Lookup {
+    std::string method;
+    std::string path;
+    size_t expected;
+};
+
+// The straightforward alternative: try every route in turn.
+static size_t linearMatch(const std::vector<RouteSpec>& routes, std::string_view method, std::string_view path,
+                          dex::RouteParams& params) {
+    for (size_t id = 0; id < routes.size(); ++id) {
+        if (routes[id].method != method) continue;
+        std::string_view pattern = routes[id].pattern;
+        std::string_view rest = path;
+        params.count = 0;
+        bool ok = true;
+        while (ok && !pattern.empty()) {
+            size_t pEnd = pattern.find('/', 1);
+            std::string_view pSeg = pattern.substr(0, pEnd);
+            if (pSeg.size() > 1 && pSeg[1] == '*') {
+                params.items[params.count++] = {pSeg.substr(2), rest.substr(std::min<size_t>(1, rest.size()))};
+                rest = {};
+                pattern = {};
+                break;
+            }
+            size_t sEnd = rest.find('/', 1);
+            std::string_view seg = rest.substr(0, sEnd);
+            if (pSeg.size() > 1 && pSeg[1] == ':') {
+                ok = seg.size() > 1;
+                if (ok) params.items[params.count++] = {pSeg.substr(2), seg.substr(1)};
+            } else {
+                ok = pSeg == seg;
+            }
+            pattern = pEnd == std::string_view::npos ? std::string_view() : pattern.substr(pEnd);
+            rest = sEnd == std::string_view::npos ? std::string_view() : rest.substr(sEnd);
+        }
+        if (ok && rest.empty()) return id;
+    }
+    return dex::Router::npos;
+}
+
+int main(int argc, char** argv) {
+    size_t routeCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000;
+    size_t lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000000;
+
+    // Eight routes per resource, the way a REST API grows.
+    std::vector<RouteSpec> routes;
+    std::vector<Lookup> requests;
+    const char* prefixes[] = {"/api/v1/", "/api/v2/", "/admin/", "/internal/"};
+    for (size_t r = 0; routes.size() < routeCount; ++r) {
+        std::string base = std::string(prefixes[r % 4]) + "res" + std::to_string(r);
+        std::string concrete = base + "/" + std::to_string(1000 + r);
+        const RouteSpec specs[] = {
+            {"GET", base},
+            {"POST", base},
+            {"GET", base + "/:id"},
+            {"PUT", base + "/:id"},
+            {"DELETE", base + "/:id"},
+            {"GET", base + "/:id/items"},
+            {"GET", base + "/:id/items/:itemId"},
+            {"GET", "/static/res" + std::to_string(r) + "/*path"},
+        };
+        const std::string paths[] = {
+            base, base, concrete, concrete, concrete, concrete + "/items", concrete + "/items/7",
+            "/static/res" + std::to_string(r) + "/css/site.css",
+        };
+        for (size_t i = 0; i < 8 && routes.size() < routeCount; ++i) {
+            requests.push_back({specs[i].method, paths[i], routes.size()});
+            routes.push_back(specs[i]);
+        }
+    }
+
+    dex::Router router;
+    for (size_t id = 0; id < routes.size(); ++id) router.insert(routes[id].method, routes[id].pattern, id);
+
+    std::mt19937 rng(42);
+    std::shuffle(requests.begin(), requests.end(), rng);
+    requests.push_back({"GET", "/api/v1/nope/1", dex::Router::npos}); // a miss
+
+    dex::RouteParams params;
+    for (const auto& req : requests) {
+        size_t a = router.match(req.method, req.path, params);
+        dex::RouteParams linear;
+        size_t b = linearMatch(routes, req.method, req.path, linear);
+        bool same = a == req.expected && b == req.expected && params.count == linear.count;
+        for (size_t i = 0; same && i < params.count; ++i) {
+            same = params.items[i].name == linear.items[i].name && params.items[i].value == linear.items[i].value;
+        }
+        if (!same) {
+            std::cerr << "mismatch for " << req.method << " " << req.path << "\n";
+            return 1;
+        }
+    }
+
+    auto timeIt = [&](const char* label, size_t count, auto&& match) {
+        size_t found = 0;
+        size_t allocs = allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            const Lookup& req = requests[i % requests.size()];
+            found += match(req.method, req.path) != dex::Router::npos;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << label << ": " << secs * 1e9 / count << " ns/lookup, " << count / secs << " lookups/s, "
+                  << found << " found, " << allocations.load() - allocs << " allocations\n";
+    };
+
+    std::cout << routes.size() << " routes, " << lookups << " lookups\n";
+    timeIt("radix router", lookups, [&](const std::string& m, const std::string& p) {
+        return router.match(m, p, params);
+    });
+    // The scan is orders of magnitude slower; a fraction of the lookups does.
+    timeIt("linear scan", std::max<size_t>(lookups / 100, 1), [&](const std::string& m, const std::string& p) {
+        return linearMatch(routes, m, p, params);
+    });
+    return 0;
+}
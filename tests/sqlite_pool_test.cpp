@@ -0,0 +1,104 @@
+#include "../src/runtime/connection_pool.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Pooled SQLite connections in WAL mode read their own writes inside a
+// transaction, through the InstrumentedDatabase and CachingDatabase
+// wrappers. In WAL mode reads outside a transaction go to a separate
+// reader handle, so a statement cached before begin() must not be reused
+// inside it; both stay cached for the next time. An in-memory pool has one
+// connection, which a thread can check out again while it still holds it
+// (a cursor open during a query).
+// Usage: sqlite_pool_test [scratch.db]
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+static std::string count(dex::Database& db) {
+    dex::QueryResult r = db.query("SELECT count(*) FROM t WHERE x > ?", dex::SqlParams{int64_t(0)});
+    return r.columns.empty() || r.rowCount == 0 ? "<none>" : r.columns[0].cellString(0);
+}
+
+static void readYourWrites(const std::string& path, size_t resultCacheBytes, const std::string& label) {
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+
+    dex::PoolOptions options;
+    options.minSize = 1;
+    options.maxSize = 1;
+    options.resultCacheBytes = resultCacheBytes;
+    auto pool = std::make_shared<dex::ConnectionPool>("sqlite://" + path + "?wal=1", options);
+    auto db = pool->acquire();
+    if (!db) {
+        check(false, label + ": acquire");
+        return;
+    }
+    db->execute("CREATE TABLE t (x INTEGER)");
+
+    check(count(*db) == "0", label + ": empty before the transaction");
+    check(db->begin(), label + ": begin");
+    db->execute("INSERT INTO t VALUES (?)", dex::SqlParams{int64_t(5)});
+    check(count(*db) == "1", label + ": transaction sees its own insert");
+    check(db->rollback(), label + ": rollback");
+    check(count(*db) == "0", label + ": insert gone after rollback");
+    const uint64_t prepared = db->statementCacheMisses();
+
+    check(db->begin(), label + ": begin again");
+    db->execute("INSERT INTO t VALUES (?)", dex::SqlParams{int64_t(7)});
+    check(count(*db) == "1", label + ": second transaction sees its insert");
+    check(db->commit(), label + ": commit");
+    check(count(*db) == "1", label + ": committed row visible afterwards");
+    check(db->statementCacheMisses() == prepared, label + ": statements stay cached across transactions");
+
+    db.reset();
+    pool.reset();
+    std::remove(path.c_str());
+    std::remove((path + "-wal").c_str());
+    std::remove((path + "-shm").c_str());
+}
+
+static void inMemoryCursorAndQuery() {
+    dex::PoolOptions options;
+    options.checkoutTimeout = std::chrono::milliseconds(200);
+    auto pool = std::make_shared<dex::ConnectionPool>("sqlite://:memory:", options);
+    auto db = pool->acquire();
+    if (!db) {
+        check(false, "memory: acquire");
+        return;
+    }
+    db->execute("CREATE TABLE t (x INTEGER)");
+    db->execute("INSERT INTO t VALUES (1), (2), (3)");
+
+    auto cursor = db->cursor("SELECT x FROM t ORDER BY x", {});
+    check(cursor && cursor->fetch(1).rowCount == 1, "memory: cursor opened");
+    auto again = pool->acquire();
+    check(again == db, "memory: same thread gets its own lease back");
+    if (again) check(count(*again) == "3", "memory: query while the cursor is open");
+    check(cursor && cursor->fetch(10).rowCount == 2, "memory: cursor continues after the query");
+
+    std::shared_ptr<dex::Database> other;
+    std::thread([&] { other = pool->acquire(); }).join();
+    check(!other, "memory: another thread still waits for the connection");
+
+    cursor.reset();
+    again.reset();
+    db.reset();
+    std::thread([&] { other = pool->acquire(); }).join();
+    check(other && count(*other) == "3", "memory: connection back in the pool once every copy is released");
+}
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "sqlite_pool_test.db";
+    readYourWrites(path, 0, "pooled");
+    readYourWrites(path, 1 << 20, "pooled + result cache");
+    inMemoryCursorAndQuery();
+    std::cout << (failures ? "FAILED\n" : "all passed\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+#include "../src/runtime/webserver.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <iostream>
+#include <netinet/in.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <thread>
+#include <unistd.h>
+
+// Response framing of WebServer over real sockets: status line, the
+// Connection header for HTTP/1.0 and 1.1 clients, and Content-Length.
+// Usage: webserver_test
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    std::cout << (ok ? "ok   " : "FAIL ") << what << "\n";
+    if (!ok) ++failures;
+}
+
+static int connectTo(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    timeval tv{2, 0}; // a missing response fails the check instead of hanging
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends `request` and reads one response head plus its body.
+static std::string exchange(int fd, const std::string& request) {
+    ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+    std::string in;
+    char buf[4096];
+    for (;;) {
+        size_t headEnd = in.find("\r\n\r\n");
+        if (headEnd != std::string::npos) {
+            size_t cl = in.find("Content-Length: ");
+            size_t length = cl < headEnd ? std::stoul(in.substr(cl + 16)) : 0;
+            if (in.size() >= headEnd + 4 + length) return in;
+        }
+        ssize_t n = ::recv(fd, buf, sizeof buf, 0);
+        if (n <= 0) return in;
+        in.append(buf, static_cast<size_t>(n));
+    }
+}
+
+static bool hasHeader(const std::string& response, const std::string& line) {
+    size_t headEnd = response.find("\r\n\r\n");
+    size_t at = response.find("\r\n" + line + "\r\n");
+    return at != std::string::npos && at < headEnd;
+}
+
+// True once the server has closed `fd`.
+static bool peerClosed(int fd) {
+    char c;
+    return ::recv(fd, &c, 1, 0) == 0;
+}
+
+int main() {
+    dex::WebServerOptions options;
+    options.host = "127.0.0.1";
+    options.workers = 1;
+    auto server = std::make_shared<dex::WebServer>(0, options);
+    server->route("/hello", "GET", [](const dex::HttpRequest&, dex::HttpResponse& res) { res.body = "hi"; });
+
+    dex::Interpreter interp;
+    std::thread loop([&] { server->start(interp); });
+    for (int i = 0; i < 200 && server->listeningPort() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    int port = server->listeningPort();
+    if (port == 0) {
+        std::cerr << "server did not start\n";
+        server->stop();
+        loop.join();
+        return 1;
+    }
+
+    // HTTP/1.1 keeps the connection open without saying so.
+    int fd = connectTo(port);
+    std::string r = exchange(fd, "GET /hello HTTP/1.1\r\nHost: x\r\n\r\n");
+    check(r.compare(0, 15, "HTTP/1.1 200 OK") == 0, "1.1: status line");
+    check(hasHeader(r, "Content-Length: 2"), "1.1: Content-Length");
+    check(r.find("Connection:") == std::string::npos, "1.1: no Connection header on keep-alive");
+    r = exchange(fd, "GET /hello HTTP/1.1\r\nHost: x\r\nConnection: close\r\n\r\n");
+    check(hasHeader(r, "Connection: close"), "1.1: Connection: close when the client asks");
+    check(peerClosed(fd), "1.1: connection closed after Connection: close");
+    ::close(fd);
+
+    // HTTP/1.0 closes by default and has to be told about keep-alive.
+    fd = connectTo(port);
+    r = exchange(fd, "GET /hello HTTP/1.0\r\n\r\n");
+    check(hasHeader(r, "Connection: close"), "1.0: Connection: close by default");
+    check(peerClosed(fd), "1.0: connection closed");
+    ::close(fd);
+
+    fd = connectTo(port);
+    r = exchange(fd, "GET /hello HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+    check(hasHeader(r, "Connection: keep-alive"), "1.0: Connection: keep-alive echoed");
+    r = exchange(fd, "GET /hello HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+    check(r.size() > 2 && r.compare(r.size() - 2, 2, "hi") == 0, "1.0: second request on the kept-alive connection");
+    ::close(fd);
+
+    // Errors the server answers itself are framed the same way.
+    fd = connectTo(port);
+    r = exchange(fd, "BROKEN\r\n\r\n");
+    check(r.compare(0, 12, "HTTP/1.1 400") == 0, "bad request: 400");
+    check(hasHeader(r, "Connection: close"), "bad request: Connection: close");
+    ::close(fd);
+
+    server->stop();
+    loop.join();
+    std::cout << (failures ? "FAILED\n" : "all passed\n");
+    return failures ? 1 : 0;
+}